@@ -26,7 +26,9 @@
 #include <chrono>
 #include <cstdint>
 #include <vector>
+#include "LatencyHistogram.h"
 #include "Mass.h"
+#include "Metrics.h"
 #include "Value.h"
 
 namespace HX711 {
@@ -67,6 +69,12 @@ protected:
     Mass::Unit _massUnit;
     Value _refUnit;
     Value _offset;
+    LatencyHistogram _readLatency;
+
+    //where weight publishes its result, if anywhere
+    ScaleMetrics* _weightMetrics;
+
+    double _read(const Options o);
 
 public:
     AbstractScale(
@@ -95,6 +103,12 @@ public:
     Mass weight(const std::chrono::nanoseconds timeout);
     Mass weight(const std::size_t samples);
 
+    /**
+     * Total time taken by read (and so weight and zero), including
+     * waiting for and collecting every sample.
+     */
+    LatencyHistogram& getReadLatency() noexcept;
+
 };
 };
 #endif
@@ -26,7 +26,9 @@
 #include <chrono>
 #include <cstdint>
 #include "AbstractScale.h"
+#include "GpioDriver.h"
 #include "HX711.h"
+#include "LatencyHistogram.h"
 #include "Value.h"
 #include "Watcher.h"
 
@@ -35,6 +37,9 @@ class AdvancedHX711 : public AbstractScale, public HX711 {
 
 protected:
     Watcher* _wx;
+    LatencyHistogram _queueLatency;
+
+    void _takeValues(std::vector<Value>* const vals, const std::size_t max);
 
 public:
     AdvancedHX711(
@@ -42,13 +47,20 @@ public:
         const int clockPin,
         const Value refUnit = 1,
         const Value offset = 0,
-        const Rate rate = Rate::HZ_10);
+        const Rate rate = Rate::HZ_10,
+        GpioDriver* const gpio = nullptr);
 
     virtual ~AdvancedHX711();
 
     virtual std::vector<Value> getValues(const std::chrono::nanoseconds timeout) override;
     virtual std::vector<Value> getValues(const std::size_t samples) override;
 
+    /**
+     * Time from the watcher thread storing a value to getValues taking
+     * it.
+     */
+    LatencyHistogram& getQueueLatency() noexcept;
+
 };
 };
 #endif
@@ -0,0 +1,138 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_BITTIMING_H_D28DDEDA_70B0_42B8_93B5_732425B7B0B4
+#define HX711_BITTIMING_H_D28DDEDA_70B0_42B8_93B5_732425B7B0B4
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace HX711 {
+
+/**
+ * Records how long the clock pin was held high and low for each pulse
+ * of the last N reads. Attach one with HX711::setBitTiming to diagnose
+ * reads which come close to the 60us power down threshold, eg. when
+ * tuning CPU isolation or kernel settings.
+ * 
+ * All storage is allocated by the constructor. Recording copies a
+ * finished read into the buffer under a lock; the pulses of the read
+ * in progress are written without one.
+ */
+class BitTiming {
+
+public:
+
+    /**
+     * Datasheet pg. 5
+     */
+    static constexpr auto POWER_DOWN_TIME = std::chrono::microseconds(60);
+
+    static const unsigned char MAX_PULSES = 27;
+
+    struct Read {
+
+        /**
+         * Time (see Utility::getnanos) of the first rising edge
+         */
+        std::chrono::nanoseconds when;
+
+        /**
+         * Number of pulses recorded; fewer than 25 if the read failed
+         */
+        unsigned char pulses;
+
+        bool failed;
+
+        /**
+         * Nanoseconds the clock was high for each pulse, and low before
+         * each pulse (low[0] is always 0)
+         */
+        std::uint32_t high[MAX_PULSES];
+        std::uint32_t low[MAX_PULSES];
+
+    };
+
+    struct Summary {
+        std::size_t reads;
+        std::size_t failedReads;
+        std::size_t pulses;
+
+        /**
+         * Pulses held high for at least POWER_DOWN_TIME
+         */
+        std::size_t overLimit;
+
+        std::chrono::nanoseconds highP50;
+        std::chrono::nanoseconds highP99;
+        std::chrono::nanoseconds highP999;
+        std::chrono::nanoseconds highMax;
+        std::chrono::nanoseconds lowMax;
+
+        /**
+         * POWER_DOWN_TIME less highMax; negative if any pulse exceeded it
+         */
+        std::chrono::nanoseconds margin;
+    };
+
+protected:
+    mutable std::mutex _lock;
+    std::vector<Read> _reads;
+    std::size_t _next;
+    std::size_t _count;
+    Read _current;
+    std::chrono::nanoseconds _lastFall;
+
+    static std::uint32_t _toUint(const std::chrono::nanoseconds d) noexcept;
+
+
+public:
+    explicit BitTiming(const std::size_t reads = 100);
+
+    BitTiming(const BitTiming& that) = delete;
+    BitTiming& operator=(const BitTiming& that) = delete;
+
+    /**
+     * Called by HX711 around and during each read
+     */
+    void beginRead() noexcept;
+    void recordPulse(
+        const std::chrono::nanoseconds rise,
+        const std::chrono::nanoseconds fall) noexcept;
+    void endRead(const bool failed = false) noexcept;
+
+    std::size_t getCapacity() const noexcept;
+    void clear() noexcept;
+
+    /**
+     * Oldest first
+     */
+    std::vector<Read> getReads() const;
+
+    Summary summarise() const;
+
+};
+};
+#endif
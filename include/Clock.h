@@ -0,0 +1,65 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_CLOCK_H_03766B6D_9288_4EFC_8480_D5CA62104ABC
+#define HX711_CLOCK_H_03766B6D_9288_4EFC_8480_D5CA62104ABC
+
+#include <chrono>
+
+namespace HX711 {
+
+/**
+ * Source of time for the library. Utility::getnanos, Utility::sleep and
+ * Utility::delay - and so everything which waits or measures time - go
+ * through the clock set with Utility::setClock. By default this is a
+ * SystemClock.
+ */
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    /**
+     * Monotonic time
+     */
+    virtual std::chrono::nanoseconds now() noexcept = 0;
+
+    /**
+     * Wait for at least ns, allowing other threads to run
+     */
+    virtual void sleep(const std::chrono::nanoseconds ns) noexcept = 0;
+
+    /**
+     * Wait for at least ns without giving up the CPU (see Utility::delay)
+     */
+    virtual void delay(const std::chrono::nanoseconds ns) noexcept = 0;
+
+    /**
+     * Hint from code which is busy waiting for something it knows will
+     * not happen before t (eg. a VirtualChip's next conversion). Real
+     * clocks ignore it; a VirtualClock skips ahead to t.
+     */
+    virtual void idleUntil(const std::chrono::nanoseconds t) noexcept {
+        (void)t;
+    }
+};
+};
+#endif
@@ -0,0 +1,388 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_COMPRESSEDLOG_H_DD4B3829_05DF_4F6F_9D11_988DD85A88CA
+#define HX711_COMPRESSEDLOG_H_DD4B3829_05DF_4F6F_9D11_988DD85A88CA
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SampleLog.h"
+
+namespace HX711 {
+
+/**
+ * Compressed sample log format
+ * 
+ * A CompressedLogHeader followed by any number of blocks, each a
+ * CompressedBlockHeader and its payload. A log which was closed cleanly
+ * ends with an index of its blocks and a CompressedLogTrailer; without
+ * them, readers rebuild the index by skipping from header to header,
+ * and stop at the first block which is incomplete. The index holds each block's time span
+ * and a summary of its values, so time range and aggregate queries only
+ * decode the blocks they must. All fields are in the host's byte order.
+ * 
+ * Times are stored in units of timeUnit nanoseconds (1us by default).
+ * Within a block, the first time and value are stored in the header.
+ * The payload is then three bit-packed streams, each using the fewest
+ * bits which fit every entry in that block:
+ * 
+ *  - the change in the time between samples (delta-of-delta), from the
+ *    third sample on, zig-zag encoded. At a fixed rate these are only
+ *    the jitter.
+ *  - the change in value from the previous sample, zig-zag encoded
+ *  - each sample's flags, unencoded; normally 0 bits
+ * 
+ * The payload is padded to a multiple of 8 bytes, with at least 8 bytes
+ * of padding so decoders can always read whole 64-bit words.
+ */
+
+struct CompressedLogHeader {
+
+    static constexpr const char* const MAGIC = "HX711CLG";
+    static const std::size_t MAGIC_SIZE = 8;
+    static const std::uint32_t VERSION = 2;
+
+    char magic[MAGIC_SIZE];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t timeUnit;
+    std::uint32_t blockSize;
+
+    //as SampleLogHeader
+    std::int64_t createdRealtime;
+    std::int64_t createdMonotonic;
+    std::int32_t refUnit;
+    std::int32_t offset;
+    std::int32_t dataPin;
+    std::int32_t clockPin;
+    std::uint8_t rate;
+    std::uint8_t channel;
+    std::uint8_t gain;
+    std::uint8_t unit;
+
+    std::uint8_t reserved[4];
+
+    std::uint8_t bootId[16];
+
+};
+
+struct CompressedBlockHeader {
+
+    static const std::uint32_t MARKER = 0x4b425848; //"HXBK"
+
+    std::uint32_t marker;
+    std::uint32_t count;
+    std::uint32_t payloadSize;
+    std::uint8_t timeBits;
+    std::uint8_t valueBits;
+    std::uint8_t flagBits;
+    std::uint8_t reserved;
+
+    //in timeUnits
+    std::int64_t firstWhen;
+    std::int64_t firstDelta;
+    std::int64_t lastWhen;
+
+    std::int32_t firstValue;
+
+    //of the payload; detects a block cut short by a crash
+    std::uint32_t checksum;
+
+    //summary of the block's values, so the index can be rebuilt from
+    //the headers alone
+    std::int64_t sum;
+    std::int32_t min;
+    std::int32_t max;
+
+};
+
+struct CompressedIndexEntry {
+
+    //file offset of the block's header
+    std::uint64_t offset;
+
+    //Utility::getnanos times of the first and last samples
+    std::int64_t firstWhen;
+    std::int64_t lastWhen;
+
+    //summary of the block's values, so aggregates over whole blocks
+    //need not decode them
+    std::int64_t sum;
+    std::uint32_t count;
+    std::int32_t min;
+    std::int32_t max;
+    std::uint32_t reserved;
+
+};
+
+struct CompressedLogTrailer {
+
+    static constexpr const char* const MAGIC = "HX711IDX";
+    static const std::size_t MAGIC_SIZE = 8;
+
+    char magic[MAGIC_SIZE];
+    std::uint64_t indexOffset;
+    std::uint64_t entries;
+
+};
+
+static_assert(sizeof(CompressedLogHeader) == 80, "unexpected CompressedLogHeader size");
+static_assert(sizeof(CompressedBlockHeader) == 64, "unexpected CompressedBlockHeader size");
+static_assert(sizeof(CompressedIndexEntry) == 48, "unexpected CompressedIndexEntry size");
+static_assert(sizeof(CompressedLogTrailer) == 24, "unexpected CompressedLogTrailer size");
+
+/**
+ * Count, sum, minimum, and maximum of a set of samples' values
+ */
+struct SampleSummary {
+
+    std::uint64_t count;
+    std::int64_t sum;
+    std::int32_t min;
+    std::int32_t max;
+
+    SampleSummary() noexcept;
+
+    void add(const SampleRecord& r) noexcept;
+    void merge(const SampleSummary& s) noexcept;
+    void merge(const CompressedIndexEntry& e) noexcept;
+
+    /**
+     * Mean value, or 0 if count is 0
+     */
+    double mean() const noexcept;
+
+};
+
+/**
+ * Encodes and decodes single blocks
+ */
+class CompressedBlock {
+
+public:
+
+    /**
+     * Replaces out with the block header and payload for count records.
+     * Times are rounded down to a multiple of timeUnit.
+     */
+    static void encode(
+        const SampleRecord* const recs,
+        const std::size_t count,
+        const std::uint32_t timeUnit,
+        std::vector<std::uint8_t>* const out);
+
+    /**
+     * Decodes a block's payload into out, which must have room for
+     * h.count records
+     */
+    static void decode(
+        const CompressedBlockHeader& h,
+        const std::uint8_t* const payload,
+        const std::uint32_t timeUnit,
+        SampleRecord* const out) noexcept;
+
+    static std::uint32_t checksum(
+        const std::uint8_t* const payload,
+        const std::size_t size) noexcept;
+
+};
+
+/**
+ * Read-only view of a compressed sample log. The file is memory-mapped
+ * and blocks are decoded on request.
+ */
+class CompressedLog {
+
+protected:
+    const std::uint8_t* _map;
+    std::size_t _mapSize;
+    std::vector<CompressedIndexEntry> _index;
+    std::size_t _count;
+
+    bool _readIndex() noexcept;
+    void _scan();
+
+
+public:
+
+    /**
+     * Throws std::runtime_error if the file cannot be opened or is not
+     * a compatible compressed sample log
+     */
+    explicit CompressedLog(const std::string& path);
+
+    CompressedLog(const CompressedLog& that) = delete;
+    CompressedLog& operator=(const CompressedLog& that) = delete;
+
+    ~CompressedLog();
+
+    const CompressedLogHeader& header() const noexcept;
+
+    /**
+     * Number of samples in the log
+     */
+    std::size_t size() const noexcept;
+
+    const std::vector<CompressedIndexEntry>& getIndex() const noexcept;
+
+    /**
+     * Decodes block i into out, which must have room for
+     * getIndex()[i].count records
+     */
+    void decodeBlock(const std::size_t i, SampleRecord* const out) const noexcept;
+
+    /**
+     * Appends every sample to out
+     */
+    void decode(std::vector<SampleRecord>* const out) const;
+
+    /**
+     * Index of the first block with a sample at or after when, or the
+     * number of blocks if there is none
+     */
+    std::size_t findBlock(const std::int64_t when) const noexcept;
+
+    /**
+     * Appends the samples from from up to (but not including) to. Only
+     * the blocks which overlap the range are decoded.
+     */
+    void range(
+        const std::int64_t from,
+        const std::int64_t to,
+        std::vector<SampleRecord>* const out) const;
+
+    /**
+     * Summarises the samples from from up to (but not including) to.
+     * Blocks entirely within the range are taken from the index, so at
+     * most the two blocks at either end are decoded.
+     */
+    SampleSummary summarise(const std::int64_t from, const std::int64_t to) const;
+
+    /**
+     * Summarises each interval from from up to to, such that
+     * (*out)[i] covers from + i * interval. Intervals without samples
+     * have a count of 0. Blocks entirely within one interval are taken
+     * from the index.
+     */
+    void rollup(
+        const std::int64_t from,
+        const std::int64_t to,
+        const std::chrono::nanoseconds interval,
+        std::vector<SampleSummary>* const out) const;
+
+    /**
+     * Size of the file, for comparison with size() * sizeof(SampleRecord)
+     */
+    std::size_t getFileSize() const noexcept;
+
+    std::chrono::nanoseconds toRealtime(const std::int64_t when) const noexcept;
+
+    /**
+     * Converts a wall clock time to the log's time, for range queries
+     */
+    std::int64_t fromRealtime(const std::chrono::nanoseconds t) const noexcept;
+
+    /**
+     * Finds the end of the last complete block in a log, and its index,
+     * whether or not the log was closed cleanly
+     */
+    static std::size_t findEnd(
+        const std::uint8_t* const map,
+        const std::size_t size,
+        std::vector<CompressedIndexEntry>* const index);
+
+    static void validate(const CompressedLogHeader& h);
+
+};
+
+/**
+ * Writes a compressed sample log. Records are buffered until a block is
+ * full, then encoded and written. Closing the log (by destroying the
+ * writer) writes any partial block and the index.
+ * 
+ * An existing log at path is appended to, and keeps its own header. A
+ * log written before the system last booted cannot be appended to, as
+ * its times would go backwards.
+ */
+class CompressedLogWriter {
+
+protected:
+
+    static const std::size_t _DEFAULT_BLOCK_SIZE = 1024;
+
+    static const std::uint32_t _DEFAULT_TIME_UNIT = 1000;
+
+    int _fd;
+    std::uint32_t _timeUnit;
+    std::size_t _blockSize;
+    std::uint64_t _end;
+    std::vector<SampleRecord> _pending;
+    std::vector<std::uint8_t> _encoded;
+    std::vector<CompressedIndexEntry> _index;
+
+    void _open(const std::string& path, const SampleLogMeta& meta);
+    bool _write(const void* const buf, const std::size_t len) noexcept;
+
+
+public:
+
+    /**
+     * Throws std::runtime_error if the log cannot be created or is not
+     * a compatible compressed sample log, or if it has times later than
+     * now. blockSize and timeUnit are ignored when appending.
+     */
+    CompressedLogWriter(
+        const std::string& path,
+        const SampleLogMeta& meta = SampleLogMeta(),
+        const std::size_t blockSize = _DEFAULT_BLOCK_SIZE,
+        const std::uint32_t timeUnit = _DEFAULT_TIME_UNIT);
+
+    CompressedLogWriter(const CompressedLogWriter& that) = delete;
+    CompressedLogWriter& operator=(const CompressedLogWriter& that) = delete;
+
+    ~CompressedLogWriter();
+
+    /**
+     * Returns false if a full block could not be written
+     */
+    bool append(const SampleRecord& r) noexcept;
+
+    /**
+     * Writes any buffered records as a (short) block
+     */
+    bool flush() noexcept;
+
+    std::size_t getPending() const noexcept;
+
+    /**
+     * Time of the oldest buffered record, or 0 if there are none
+     */
+    std::int64_t getPendingSince() const noexcept;
+
+    std::uint64_t getSize() const noexcept;
+
+};
+};
+#endif
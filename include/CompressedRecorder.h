@@ -0,0 +1,113 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_COMPRESSEDRECORDER_H_0702B501_771D_4980_8B58_FADB603EC473
+#define HX711_COMPRESSEDRECORDER_H_0702B501_771D_4980_8B58_FADB603EC473
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CompressedLog.h"
+#include "SampleLog.h"
+#include "SampleSink.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * Writes samples to a compressed sample log (see CompressedLog.h).
+ * 
+ * As with SampleRecorder, push only copies the sample into a ring
+ * buffer. A background thread drains the ring and encodes the samples
+ * as each block fills. A partial block is written once its oldest
+ * sample is sealInterval old, bounding what a crash can lose.
+ */
+class CompressedRecorder : public SampleSink {
+
+protected:
+
+    static const std::size_t _DEFAULT_CAPACITY = 1 << 12;
+
+    static constexpr auto _FLUSH_INTERVAL = std::chrono::duration_cast
+        <std::chrono::nanoseconds>(std::chrono::milliseconds(250));
+
+    static constexpr auto _DEFAULT_SEAL_INTERVAL = std::chrono::duration_cast
+        <std::chrono::nanoseconds>(std::chrono::seconds(30));
+
+    CompressedLogWriter _log;
+    std::vector<SampleRecord> _ring;
+    const std::size_t _mask;
+    const std::chrono::nanoseconds _sealInterval;
+
+    //_head is written only by push; _tail only by the writer thread
+    std::atomic<std::size_t> _head;
+    std::atomic<std::size_t> _tail;
+
+    std::atomic<bool> _running;
+    std::atomic<std::uint64_t> _written;
+    std::atomic<std::uint64_t> _dropped;
+    std::atomic<std::uint64_t> _writeErrors;
+    std::thread _writer;
+
+    void _writeLoop() noexcept;
+    void _drain() noexcept;
+    void _count(const std::size_t samples, const bool ok) noexcept;
+
+
+public:
+
+    /**
+     * Appends to the compressed log at path, creating it with meta in
+     * its header if it does not exist. Throws std::runtime_error if the
+     * log was written before the system last booted.
+     */
+    CompressedRecorder(
+        const std::string& path,
+        const SampleLogMeta& meta = SampleLogMeta(),
+        const std::chrono::nanoseconds sealInterval = _DEFAULT_SEAL_INTERVAL);
+
+    CompressedRecorder(const CompressedRecorder& that) = delete;
+    CompressedRecorder& operator=(const CompressedRecorder& that) = delete;
+
+    /**
+     * Writes any remaining samples and the index, and closes the log
+     */
+    virtual ~CompressedRecorder();
+
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept override;
+
+    /**
+     * Samples count as written once the block holding them is. Dropped
+     * samples include those in blocks which could not be written, and
+     * write errors count those blocks.
+     */
+    std::uint64_t getWritten() const noexcept;
+    std::uint64_t getDropped() const noexcept;
+    std::uint64_t getWriteErrors() const noexcept;
+
+};
+};
+#endif
@@ -0,0 +1,120 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_DAEMONPROTOCOL_H_57221083_43DC_4990_B232_A10383357FB0
+#define HX711_DAEMONPROTOCOL_H_57221083_43DC_4990_B232_A10383357FB0
+
+#include <cstddef>
+#include <cstdint>
+#include "SampleLog.h"
+
+namespace HX711 {
+
+/**
+ * Protocol spoken by hx711d over a Unix domain socket
+ * 
+ * Every message starts with a DaemonHeader. A request is a header
+ * followed by exactly one DaemonRequest. A response is a header
+ * followed by count payload items, whose type depends on the request:
+ * 
+ *  LIST        count DaemonScaleInfo, one per scale
+ *  GET_VALUES  count SampleRecord (see SampleLog.h)
+ *  TARE        one DaemonScaleInfo with the new offset
+ *  SUBSCRIBE   no response; instead a SAMPLES message is sent whenever
+ *              new samples are available, until the client disconnects.
+ *              A subscribed connection accepts no further requests.
+ * 
+ * Requests on one connection are answered in order. All fields are in
+ * the host's byte order, as both ends are on the same machine.
+ */
+
+enum class DaemonMessageType : std::uint8_t {
+    LIST = 1,
+    GET_VALUES = 2,
+    TARE = 3,
+    SUBSCRIBE = 4,
+    SAMPLES = 5
+};
+
+enum class DaemonStatus : std::uint8_t {
+    OK = 0,
+    BAD_REQUEST = 1,
+    NO_SUCH_SCALE = 2,
+    NO_SAMPLES = 3
+};
+
+struct DaemonHeader {
+
+    static const std::uint32_t MAGIC = 0x31373848; //"HX71"
+
+    std::uint32_t magic;
+    std::uint8_t type;
+    std::uint8_t status;
+    std::uint16_t scale;
+
+    /**
+     * Number of payload items following
+     */
+    std::uint32_t count;
+
+    /**
+     * SAMPLES only: samples the subscriber fell too far behind to be
+     * sent, since the previous SAMPLES message
+     */
+    std::uint32_t lost;
+
+};
+
+struct DaemonRequest {
+
+    //as Options; see AbstractScale.h
+    std::uint8_t strategy;
+    std::uint8_t readType;
+    std::uint8_t reserved[6];
+    std::uint64_t samples;
+    std::int64_t timeout;
+
+};
+
+struct DaemonScaleInfo {
+
+    std::int32_t dataPin;
+    std::int32_t clockPin;
+    std::int32_t refUnit;
+    std::int32_t offset;
+    std::uint8_t rate;
+    std::uint8_t unit;
+    std::uint8_t reserved[6];
+
+};
+
+static_assert(sizeof(DaemonHeader) == 16, "unexpected DaemonHeader size");
+static_assert(sizeof(DaemonRequest) == 24, "unexpected DaemonRequest size");
+static_assert(sizeof(DaemonScaleInfo) == 24, "unexpected DaemonScaleInfo size");
+
+/**
+ * Limit on the samples a single GET_VALUES or TARE can return
+ */
+static const std::size_t DAEMON_MAX_SAMPLES = 4096;
+
+};
+#endif
@@ -0,0 +1,149 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_FLIGHTLOG_H_3F933119_0299_4CCA_BD12_4975533CE6F1
+#define HX711_FLIGHTLOG_H_3F933119_0299_4CCA_BD12_4975533CE6F1
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SampleLog.h"
+
+namespace HX711 {
+
+/**
+ * Flight recorder file format
+ * 
+ * A FlightLogHeader followed by capacity SampleRecords used as a ring:
+ * sample n is stored in record n % capacity, and head is the number of
+ * samples ever stored. Unlike a sample log, each record's when is a wall
+ * clock time in nanoseconds since the epoch, so records stay meaningful
+ * across restarts and reboots.
+ * 
+ * A record is always complete before head moves past it, so a file left
+ * behind by a process which died is consistent. After a power failure,
+ * head may have reached the disk before its records; those records are
+ * older than the ones before them and readers skip them.
+ */
+struct FlightLogHeader {
+
+    static constexpr const char* const MAGIC = "HX711FLT";
+    static const std::size_t MAGIC_SIZE = 8;
+    static const std::uint32_t VERSION = 1;
+
+    char magic[MAGIC_SIZE];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t recordSize;
+    std::uint32_t capacity;
+
+    //calibration of the scale being recorded
+    std::int32_t refUnit;
+    std::int32_t offset;
+    std::int32_t dataPin;
+    std::int32_t clockPin;
+    std::uint8_t rate;
+    std::uint8_t channel;
+    std::uint8_t gain;
+    std::uint8_t unit;
+
+    //times the file has been opened for recording
+    std::uint32_t opens;
+
+    //wall clock time at which the file was created
+    std::int64_t createdRealtime;
+
+    std::uint8_t reserved[8];
+
+    alignas(64) std::atomic<std::uint64_t> head;
+
+};
+
+static_assert(sizeof(FlightLogHeader) == 128, "unexpected FlightLogHeader size");
+
+/**
+ * Read-only view of a flight recorder file, which may still be being
+ * recorded to
+ */
+class FlightLog {
+
+protected:
+    const std::uint8_t* _map;
+    std::size_t _mapSize;
+
+
+public:
+
+    /**
+     * Throws std::runtime_error if the file cannot be opened or is not
+     * a compatible flight recorder file
+     */
+    explicit FlightLog(const std::string& path);
+
+    FlightLog(const FlightLog& that) = delete;
+    FlightLog& operator=(const FlightLog& that) = delete;
+
+    ~FlightLog();
+
+    const FlightLogHeader& header() const noexcept;
+
+    /**
+     * Number of samples the file holds
+     */
+    std::size_t size() const noexcept;
+
+    /**
+     * Sample i, where 0 is the oldest. While the file is being recorded
+     * to, i refers to a different sample after each push; use extract
+     * for a consistent view.
+     */
+    const SampleRecord& operator[](const std::size_t i) const noexcept;
+
+    /**
+     * Appends the samples read at or after from and before to (wall
+     * clock nanoseconds since the epoch) to out, oldest first, and
+     * returns how many were appended. Samples which are not older than
+     * a later sample (eg. from before the wall clock stepped back) are
+     * skipped, as are records lost to a power failure (see
+     * FlightLogHeader).
+     */
+    std::size_t extract(
+        const std::int64_t from,
+        const std::int64_t to,
+        std::vector<SampleRecord>* const out) const;
+
+    /**
+     * Calibration and configuration of the recorded scale
+     */
+    SampleLogMeta getMeta() const noexcept;
+
+    /**
+     * Throws std::runtime_error if h is not a header this version of
+     * the library can read
+     */
+    static void validate(const FlightLogHeader& h);
+
+};
+};
+#endif
@@ -0,0 +1,116 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_FLIGHTRECORDER_H_483F7696_E21A_4D23_A016_546319BDB377
+#define HX711_FLIGHTRECORDER_H_483F7696_E21A_4D23_A016_546319BDB377
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "FlightLog.h"
+#include "SampleLog.h"
+#include "SampleSink.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * Keeps the most recent samples of a scale in a fixed-size memory
+ * mapped file (see FlightLog.h), so the raw data from before a fault or
+ * dispute can be extracted afterwards with FlightLog or hx711flight -
+ * even if the process has since died.
+ * 
+ * push copies the sample into the mapping and nothing more; the kernel
+ * writes it to the file in the background. The file's space is
+ * allocated up front, so recording never fails for lack of disk.
+ * 
+ * An existing file with the same capacity, recorded from the same pins
+ * at the same rate, channel, gain and reference unit, is recorded into
+ * where it left off. Any other file at path is replaced.
+ */
+class FlightRecorder : public SampleSink {
+
+protected:
+
+    static constexpr auto _DEFAULT_DURATION = std::chrono::duration_cast
+        <std::chrono::seconds>(std::chrono::minutes(10));
+
+    int _fd;
+    std::uint8_t* _map;
+    std::size_t _mapSize;
+    FlightLogHeader* _header;
+    SampleRecord* _records;
+    std::uint64_t _capacity;
+    std::uint64_t _head;
+
+    /**
+     * How often the wall clock is read again, so recorded times follow
+     * NTP adjustments which Utility::getnanos times do not
+     */
+    static constexpr auto _OFFSET_INTERVAL = std::chrono::seconds(1);
+
+    //added to Utility::getnanos times to give wall clock times, as of
+    //the Utility::getnanos time _offsetAt
+    std::int64_t _realtimeOffset;
+    std::int64_t _offsetAt;
+
+    void _updateOffset() noexcept;
+    bool _reusable(
+        const std::size_t size,
+        const SampleLogMeta& meta,
+        const std::uint64_t capacity) const noexcept;
+    void _create(const SampleLogMeta& meta, const std::uint64_t capacity);
+
+
+public:
+
+    /**
+     * Holds at least duration's worth of samples at the rate in meta
+     * (80Hz if it is Rate::OTHER). Throws std::runtime_error if the
+     * file cannot be created.
+     */
+    FlightRecorder(
+        const std::string& path,
+        const SampleLogMeta& meta,
+        const std::chrono::seconds duration = _DEFAULT_DURATION);
+
+    FlightRecorder(const FlightRecorder& that) = delete;
+    FlightRecorder& operator=(const FlightRecorder& that) = delete;
+
+    virtual ~FlightRecorder();
+
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept override;
+
+    /**
+     * Blocks until everything recorded so far is on disk, eg. when a
+     * fault is detected. Not needed if only the process might die.
+     */
+    void sync() noexcept;
+
+    void setCalibration(const Value refUnit, const Value offset) noexcept;
+
+    std::size_t getCapacity() const noexcept;
+
+};
+};
+#endif
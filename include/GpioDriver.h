@@ -0,0 +1,50 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_GPIODRIVER_H_FC30FE54_9879_48A0_B76A_EE4FCFC2EA82
+#define HX711_GPIODRIVER_H_FC30FE54_9879_48A0_B76A_EE4FCFC2EA82
+
+#include "Utility.h"
+
+namespace HX711 {
+
+/**
+ * The pin-level operations a HX711 object uses to talk to the chip. By
+ * default these go to the Raspberry Pi's GPIO pins through lgpio (see
+ * LgpioDriver). Another implementation can be given to a HX711's
+ * constructor to talk to something else, such as a VirtualChip.
+ * 
+ * Implementations should throw a GpioException on failure.
+ */
+class GpioDriver {
+public:
+    virtual ~GpioDriver() = default;
+    virtual int openHandle(const int chip) = 0;
+    virtual void closeHandle(const int handle) = 0;
+    virtual void openInput(const int handle, const int pin) = 0;
+    virtual void openOutput(const int handle, const int pin) = 0;
+    virtual void closePin(const int handle, const int pin) = 0;
+    virtual GpioLevel read(const int handle, const int pin) = 0;
+    virtual void write(const int handle, const int pin, const GpioLevel lev) = 0;
+};
+};
+#endif
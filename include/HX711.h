@@ -27,6 +27,12 @@
 #include <cstdint>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
+#include "BitTiming.h"
+#include "GpioDriver.h"
+#include "LatencyHistogram.h"
+#include "Metrics.h"
+#include "SampleSink.h"
 #include "Value.h"
 
 namespace HX711 {
@@ -77,6 +83,7 @@ protected:
     static constexpr auto _POWER_DOWN_TIMEOUT = std::chrono::microseconds(60);
     static const std::unordered_map<const Rate, const std::chrono::milliseconds> _SETTLING_TIMES;
 
+    GpioDriver* const _gpio;
     int _gpioHandle;
     const int _dataPin;
     const int _clockPin;
@@ -87,6 +94,12 @@ protected:
     bool _strictTiming;
     bool _useDelays;
     Format _bitFormat;
+    std::mutex _sinkLock;
+    std::vector<SampleSink*> _sinks;
+    BitTiming* _bitTiming;
+    mutable LatencyHistogram _waitReadyLatency;
+    LatencyHistogram _readValueLatency;
+    mutable ScaleMetrics _metrics;
 
     static val_t _convertFromTwosComplement(const val_t val) noexcept;
     static unsigned char _calculatePulses(const Gain g) noexcept;
@@ -100,7 +113,8 @@ public:
     HX711(
         const int dataPin,
         const int clockPin,
-        const Rate rate = Rate::HZ_10) noexcept;
+        const Rate rate = Rate::HZ_10,
+        GpioDriver* const gpio = nullptr) noexcept;
 
     HX711(const HX711& that) = delete;
     HX711& operator=(const HX711& that) = delete;
@@ -121,6 +135,7 @@ public:
 
     int getDataPin() const noexcept;
     int getClockPin() const noexcept;
+    Rate getRate() const noexcept;
 
     Channel getChannel() const noexcept;
     Gain getGain() const noexcept;
@@ -133,6 +148,33 @@ public:
     void powerDown();
     void powerUp();
 
+    /**
+     * Sinks receive every value read by readValue. They are not owned
+     * by the HX711 and must be removed before being destroyed.
+     */
+    void addSink(SampleSink* const sink);
+    void removeSink(SampleSink* const sink);
+
+    /**
+     * Time spent waiting for the chip to be ready, in waitReady or
+     * SimpleHX711::getValues (timeouts are not recorded), and time
+     * taken by readValue to clock out a value.
+     */
+    LatencyHistogram& getWaitReadyLatency() noexcept;
+    LatencyHistogram& getReadValueLatency() noexcept;
+
+    /**
+     * Record per-pulse clock timing of every read into bt. As with
+     * sinks, bt is not owned by the HX711. Pass nullptr to stop.
+     */
+    void setBitTiming(BitTiming* const bt);
+
+    /**
+     * Health counters for this chip, also exported through
+     * MetricsRegistry
+     */
+    ScaleMetrics& getMetrics() noexcept;
+
 };
 };
 
@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_LATENCYHISTOGRAM_H_67DE6337_D3E1_42DB_99B9_350CB17E8277
+#define HX711_LATENCYHISTOGRAM_H_67DE6337_D3E1_42DB_99B9_350CB17E8277
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace HX711 {
+
+/**
+ * Log-bucketed (HDR-style) histogram of durations in nanoseconds.
+ * 
+ * Each power of two is split into _SUB_BUCKETS linear buckets, so any
+ * reported percentile is within 1/_SUB_BUCKETS (6.25%) of the true
+ * value. Durations from 0 up to about 18 minutes are kept; longer ones
+ * are counted in the last bucket.
+ * 
+ * record is lock-free and wait-free apart from updating the maximum,
+ * and may be called from any number of threads while others query.
+ * Queries and reset are not atomic with respect to concurrent records,
+ * so a percentile read during a reset may include a few stale counts.
+ */
+class LatencyHistogram {
+
+protected:
+    static const unsigned char _SUB_BUCKET_BITS = 4;
+    static const std::size_t _SUB_BUCKETS = 1 << _SUB_BUCKET_BITS;
+    static const unsigned char _MAX_MAGNITUDE = 39;
+    static const std::size_t _BUCKET_COUNT =
+        (_MAX_MAGNITUDE - _SUB_BUCKET_BITS + 2) * _SUB_BUCKETS;
+
+    std::atomic<std::uint64_t> _buckets[_BUCKET_COUNT];
+    std::atomic<std::uint64_t> _sum;
+    std::atomic<std::uint64_t> _max;
+
+    static std::size_t _indexOf(const std::uint64_t ns) noexcept;
+    static std::uint64_t _upperBoundOf(const std::size_t index) noexcept;
+
+
+public:
+    LatencyHistogram() noexcept;
+
+    LatencyHistogram(const LatencyHistogram& that) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram& that) = delete;
+
+    void record(const std::chrono::nanoseconds d) noexcept;
+    void reset() noexcept;
+
+    std::uint64_t getCount() const noexcept;
+    std::chrono::nanoseconds getMax() const noexcept;
+    std::chrono::nanoseconds getMean() const noexcept;
+
+    /**
+     * Exact total of every duration recorded since the last reset
+     */
+    std::chrono::nanoseconds getSum() const noexcept;
+
+    /**
+     * p is from 0 to 1, eg. 0.99 for the 99th percentile. Returns the
+     * upper bound of the bucket holding that percentile, capped at the
+     * maximum recorded duration, or 0 if nothing has been recorded.
+     */
+    std::chrono::nanoseconds getPercentile(const double p) const noexcept;
+
+};
+};
+#endif
@@ -0,0 +1,51 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_LGPIODRIVER_H_CF7B56CF_5A27_483D_B713_ACD1746B9911
+#define HX711_LGPIODRIVER_H_CF7B56CF_5A27_483D_B713_ACD1746B9911
+
+#include "GpioDriver.h"
+#include "Utility.h"
+
+namespace HX711 {
+
+/**
+ * GpioDriver for the Raspberry Pi's GPIO pins using lgpio. This is what
+ * HX711 objects use unless told otherwise.
+ */
+class LgpioDriver : public GpioDriver {
+public:
+    virtual int openHandle(const int chip) override;
+    virtual void closeHandle(const int handle) override;
+    virtual void openInput(const int handle, const int pin) override;
+    virtual void openOutput(const int handle, const int pin) override;
+    virtual void closePin(const int handle, const int pin) override;
+    virtual GpioLevel read(const int handle, const int pin) override;
+    virtual void write(const int handle, const int pin, const GpioLevel lev) override;
+
+    /**
+     * Shared instance used by default; the driver itself holds no state
+     */
+    static LgpioDriver* getInstance() noexcept;
+};
+};
+#endif
@@ -0,0 +1,201 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_LOGANALYZER_H_00E7DECB_D0BC_43D9_96CB_3A34C3086793
+#define HX711_LOGANALYZER_H_00E7DECB_D0BC_43D9_96CB_3A34C3086793
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "AbstractScale.h"
+#include "CompressedLog.h"
+#include "Mass.h"
+#include "QuantileSketch.h"
+#include "SampleLog.h"
+#include "Value.h"
+#include "WorkStealingPool.h"
+
+namespace HX711 {
+
+/**
+ * An AbstractScale which reads from recorded samples rather than a
+ * chip, so read, weight, and so on filter and normalise them exactly
+ * as they would live samples.
+ * 
+ * getValues(samples) takes the next samples records. getValues(timeout)
+ * takes the records in the next window of length timeout, where windows
+ * are counted from origin, so the same records always fall in the same
+ * window wherever reading starts.
+ */
+class LogScale : public AbstractScale {
+
+protected:
+    const SampleRecord* _pos;
+    const SampleRecord* const _end;
+    const std::int64_t _origin;
+    std::int64_t _lastWhen;
+
+
+public:
+    LogScale(
+        const SampleRecord* const begin,
+        const SampleRecord* const end,
+        const std::int64_t origin,
+        const Mass::Unit unit,
+        const Value refUnit,
+        const Value offset) noexcept;
+
+    bool done() const noexcept;
+
+    const SampleRecord* position() const noexcept;
+
+    /**
+     * Time of the first record taken by the last call to getValues
+     */
+    std::int64_t getLastWhen() const noexcept;
+
+    virtual std::vector<Value> getValues(const std::size_t samples) override;
+    virtual std::vector<Value> getValues(const std::chrono::nanoseconds timeout) override;
+
+    /**
+     * The window a time falls in, for a given window length and origin
+     */
+    static std::int64_t window(
+        const std::int64_t when,
+        const std::int64_t origin,
+        const std::int64_t length) noexcept;
+
+};
+
+struct AnalysisReading {
+
+    //time of the reading's first sample
+    std::int64_t when;
+
+    //in the analyzer's unit
+    double weight;
+
+};
+
+struct AnalysisSummary {
+
+    std::uint64_t samples;
+    std::uint64_t readings;
+
+    //of the readings' weights
+    double min;
+    double max;
+    double sum;
+    QuantileSketch quantiles;
+
+    AnalysisSummary();
+
+    void add(const double weight);
+    void merge(const AnalysisSummary& s);
+
+    double mean() const noexcept;
+
+};
+
+/**
+ * Re-processes recorded samples into weights across every core.
+ * 
+ * The samples are split into chunks which a WorkStealingPool works
+ * through, each with its own LogScale. Chunks always end on a reading
+ * boundary (a multiple of Options::samples, or a window edge for
+ * time-based Options), and chunk sizes do not depend on the number of
+ * threads. Chunk results are combined in order, so the readings and
+ * summary are exactly those of a single LogScale over the whole log.
+ */
+class LogAnalyzer {
+
+protected:
+
+    static const std::size_t _DEFAULT_CHUNK_SIZE = 1 << 16;
+
+    WorkStealingPool _pool;
+    const Options _options;
+    const Mass::Unit _unit;
+    const Value _refUnit;
+    const Value _offset;
+    const std::size_t _chunkSize;
+
+    void _split(
+        const SampleRecord* const recs,
+        const std::size_t count,
+        std::vector<std::size_t>* const bounds) const;
+
+    void _analyzeChunk(
+        const SampleRecord* const begin,
+        const SampleRecord* const end,
+        const std::int64_t origin,
+        AnalysisSummary* const s,
+        std::vector<AnalysisReading>* const out) const;
+
+    static void _combine(
+        const std::vector<AnalysisSummary>& summaries,
+        const std::vector<std::vector<AnalysisReading>>& readings,
+        AnalysisSummary* const total,
+        std::vector<AnalysisReading>* const out);
+
+
+public:
+
+    /**
+     * Throws std::invalid_argument if o would read no samples, or
+     * refUnit is 0. threads of 0 uses one per core.
+     */
+    LogAnalyzer(
+        const Options o,
+        const Mass::Unit unit,
+        const Value refUnit,
+        const Value offset,
+        const std::size_t threads = 0,
+        const std::size_t chunkSize = _DEFAULT_CHUNK_SIZE);
+
+    /**
+     * Analyzes count records, which must be in time order. If out is
+     * not null, every reading is appended to it.
+     */
+    AnalysisSummary analyze(
+        const SampleRecord* const recs,
+        const std::size_t count,
+        std::vector<AnalysisReading>* const out = nullptr);
+
+    AnalysisSummary analyze(
+        const SampleLog& log,
+        std::vector<AnalysisReading>* const out = nullptr);
+
+    /**
+     * Chunks are runs of whole blocks, each decoded by the thread which
+     * analyzes it, so the log is never decoded into memory all at once
+     */
+    AnalysisSummary analyze(
+        const CompressedLog& log,
+        std::vector<AnalysisReading>* const out = nullptr);
+
+    std::size_t getThreads() const noexcept;
+
+};
+};
+#endif
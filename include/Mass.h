@@ -23,10 +23,10 @@
 #ifndef HX711_MASS_H_2FFE3D59_FB56_4C50_87F6_08F5AD88A303
 #define HX711_MASS_H_2FFE3D59_FB56_4C50_87F6_08F5AD88A303
 
+#include <cstddef>
 #include <cstdint>
 #include <ostream>
 #include <string>
-#include <unordered_map>
 
 namespace HX711 {
 class Mass {
@@ -55,8 +55,166 @@ protected:
      */
     static const std::size_t _TOSTRING_BUFF_SIZE = 64;
 
-    static const std::unordered_map<const Unit, const double> _RATIOS;
-    static const std::unordered_map<const Unit, const char* const> _UNIT_NAMES;
+    static const std::size_t _UNIT_COUNT = 10;
+
+    /**
+     * Number of micrograms in one of each Unit, indexed by the
+     * underlying value of the Unit
+     */
+    static constexpr double _RATIOS[_UNIT_COUNT] = {
+        1.0,                //UG
+        1000.0,             //MG
+        1000000.0,          //G
+        1000000000.0,       //KG
+        1000000000000.0,    //TON
+        1016046908800.0,    //IMP_TON
+        907184740000.0,     //US_TON
+        6350293180.0,       //ST
+        453592370.0,        //LB
+        28349523.125        //OZ
+    };
+
+    /**
+     * _RATIO_MATRIX[from][to] is the number an amount in the "from"
+     * unit needs to be multiplied by to be expressed in the "to"
+     * unit. Each entry is computed at compile time so a conversion
+     * between any two units is a single multiplication.
+     */
+    static constexpr double _RATIO_MATRIX[_UNIT_COUNT][_UNIT_COUNT] = {
+        { //from UG
+            _RATIOS[0] / _RATIOS[0],
+            _RATIOS[0] / _RATIOS[1],
+            _RATIOS[0] / _RATIOS[2],
+            _RATIOS[0] / _RATIOS[3],
+            _RATIOS[0] / _RATIOS[4],
+            _RATIOS[0] / _RATIOS[5],
+            _RATIOS[0] / _RATIOS[6],
+            _RATIOS[0] / _RATIOS[7],
+            _RATIOS[0] / _RATIOS[8],
+            _RATIOS[0] / _RATIOS[9]
+        },
+        { //from MG
+            _RATIOS[1] / _RATIOS[0],
+            _RATIOS[1] / _RATIOS[1],
+            _RATIOS[1] / _RATIOS[2],
+            _RATIOS[1] / _RATIOS[3],
+            _RATIOS[1] / _RATIOS[4],
+            _RATIOS[1] / _RATIOS[5],
+            _RATIOS[1] / _RATIOS[6],
+            _RATIOS[1] / _RATIOS[7],
+            _RATIOS[1] / _RATIOS[8],
+            _RATIOS[1] / _RATIOS[9]
+        },
+        { //from G
+            _RATIOS[2] / _RATIOS[0],
+            _RATIOS[2] / _RATIOS[1],
+            _RATIOS[2] / _RATIOS[2],
+            _RATIOS[2] / _RATIOS[3],
+            _RATIOS[2] / _RATIOS[4],
+            _RATIOS[2] / _RATIOS[5],
+            _RATIOS[2] / _RATIOS[6],
+            _RATIOS[2] / _RATIOS[7],
+            _RATIOS[2] / _RATIOS[8],
+            _RATIOS[2] / _RATIOS[9]
+        },
+        { //from KG
+            _RATIOS[3] / _RATIOS[0],
+            _RATIOS[3] / _RATIOS[1],
+            _RATIOS[3] / _RATIOS[2],
+            _RATIOS[3] / _RATIOS[3],
+            _RATIOS[3] / _RATIOS[4],
+            _RATIOS[3] / _RATIOS[5],
+            _RATIOS[3] / _RATIOS[6],
+            _RATIOS[3] / _RATIOS[7],
+            _RATIOS[3] / _RATIOS[8],
+            _RATIOS[3] / _RATIOS[9]
+        },
+        { //from TON
+            _RATIOS[4] / _RATIOS[0],
+            _RATIOS[4] / _RATIOS[1],
+            _RATIOS[4] / _RATIOS[2],
+            _RATIOS[4] / _RATIOS[3],
+            _RATIOS[4] / _RATIOS[4],
+            _RATIOS[4] / _RATIOS[5],
+            _RATIOS[4] / _RATIOS[6],
+            _RATIOS[4] / _RATIOS[7],
+            _RATIOS[4] / _RATIOS[8],
+            _RATIOS[4] / _RATIOS[9]
+        },
+        { //from IMP_TON
+            _RATIOS[5] / _RATIOS[0],
+            _RATIOS[5] / _RATIOS[1],
+            _RATIOS[5] / _RATIOS[2],
+            _RATIOS[5] / _RATIOS[3],
+            _RATIOS[5] / _RATIOS[4],
+            _RATIOS[5] / _RATIOS[5],
+            _RATIOS[5] / _RATIOS[6],
+            _RATIOS[5] / _RATIOS[7],
+            _RATIOS[5] / _RATIOS[8],
+            _RATIOS[5] / _RATIOS[9]
+        },
+        { //from US_TON
+            _RATIOS[6] / _RATIOS[0],
+            _RATIOS[6] / _RATIOS[1],
+            _RATIOS[6] / _RATIOS[2],
+            _RATIOS[6] / _RATIOS[3],
+            _RATIOS[6] / _RATIOS[4],
+            _RATIOS[6] / _RATIOS[5],
+            _RATIOS[6] / _RATIOS[6],
+            _RATIOS[6] / _RATIOS[7],
+            _RATIOS[6] / _RATIOS[8],
+            _RATIOS[6] / _RATIOS[9]
+        },
+        { //from ST
+            _RATIOS[7] / _RATIOS[0],
+            _RATIOS[7] / _RATIOS[1],
+            _RATIOS[7] / _RATIOS[2],
+            _RATIOS[7] / _RATIOS[3],
+            _RATIOS[7] / _RATIOS[4],
+            _RATIOS[7] / _RATIOS[5],
+            _RATIOS[7] / _RATIOS[6],
+            _RATIOS[7] / _RATIOS[7],
+            _RATIOS[7] / _RATIOS[8],
+            _RATIOS[7] / _RATIOS[9]
+        },
+        { //from LB
+            _RATIOS[8] / _RATIOS[0],
+            _RATIOS[8] / _RATIOS[1],
+            _RATIOS[8] / _RATIOS[2],
+            _RATIOS[8] / _RATIOS[3],
+            _RATIOS[8] / _RATIOS[4],
+            _RATIOS[8] / _RATIOS[5],
+            _RATIOS[8] / _RATIOS[6],
+            _RATIOS[8] / _RATIOS[7],
+            _RATIOS[8] / _RATIOS[8],
+            _RATIOS[8] / _RATIOS[9]
+        },
+        { //from OZ
+            _RATIOS[9] / _RATIOS[0],
+            _RATIOS[9] / _RATIOS[1],
+            _RATIOS[9] / _RATIOS[2],
+            _RATIOS[9] / _RATIOS[3],
+            _RATIOS[9] / _RATIOS[4],
+            _RATIOS[9] / _RATIOS[5],
+            _RATIOS[9] / _RATIOS[6],
+            _RATIOS[9] / _RATIOS[7],
+            _RATIOS[9] / _RATIOS[8],
+            _RATIOS[9] / _RATIOS[9]
+        }
+    };
+
+    static constexpr const char* const _UNIT_NAMES[_UNIT_COUNT] = {
+        "μg",               //UG
+        "mg",               //MG
+        "g",                //G
+        "kg",               //KG
+        "ton",              //TON
+        "ton (IMP)",        //IMP_TON
+        "ton (US)",         //US_TON
+        "st",               //ST
+        "lb",               //LB
+        "oz"                //OZ
+    };
 
     //deal with mass internally as micrograms
     double _ug;
@@ -64,6 +222,9 @@ protected:
     //unit the calling code has chosen to represent this Mass
     Unit _u;
 
+    //construct from an amount already in micrograms
+    static Mass _fromMicrograms(const double ug, const Unit u) noexcept;
+
 
 public:
     Mass(const double amount = 0.0, const Unit u = Unit::UG) noexcept;
@@ -107,6 +268,17 @@ public:
         const Unit from,
         const Unit to = Unit::UG) noexcept;
 
+    /**
+     * Returns the number to multiply an amount in the from unit
+     * by to express it in the to unit. Usable in constant expressions;
+     * see Quantity.h
+     */
+    static constexpr double ratio(const Unit from, const Unit to) noexcept {
+        return _RATIO_MATRIX[static_cast<std::size_t>(from)][static_cast<std::size_t>(to)];
+    }
+
+    static const char* getUnitName(const Unit u) noexcept;
+
 };
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,139 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_MASSFORMATTER_H_BA6A7B90_40EE_4CE3_9AC3_3DBAB718BBFB
+#define HX711_MASSFORMATTER_H_BA6A7B90_40EE_4CE3_9AC3_3DBAB718BBFB
+
+#include <cstddef>
+#include <cstdint>
+#include "Mass.h"
+
+namespace HX711 {
+
+/**
+ * Formats Mass objects into caller-provided buffers without allocating.
+ * Output is the same as Mass::toString (eg. "1.03 kg") but numbers are
+ * rendered with integer fixed-point arithmetic rather than snprintf.
+ * 
+ * All functions write a null-terminated string and return the number
+ * of chars written, not including the null. If the output will not fit
+ * in the buffer, nothing is written and 0 is returned.
+ */
+class MassFormatter {
+protected:
+
+    static const std::size_t _UNIT_COUNT = 10;
+
+    /**
+     * Above this many decimals the fixed-point path would overflow
+     * or lose accuracy, so snprintf is used instead
+     */
+    static const int _MAX_FAST_DECIMALS = 9;
+
+    /**
+     * 2^52; doubles below this can be split exactly into whole and
+     * fractional parts
+     */
+    static constexpr double _MAX_FAST_SCALED = 4503599627370496.0;
+
+    //2^-52
+    static constexpr double _EPSILON = 2.220446049250313e-16;
+
+    static constexpr double _THRESHOLD_TOLERANCE = 1.000000001;
+
+    static const double _DECIMAL_THRESHOLDS[_MAX_FAST_DECIMALS + 1];
+    static const std::uint64_t _POW10[_MAX_FAST_DECIMALS + 1];
+    static const std::size_t _UNIT_NAME_LENGTHS[_UNIT_COUNT];
+
+    static std::uint64_t _roundHalfEven(
+        const double a,
+        const double b,
+        const double product) noexcept;
+    static std::size_t _formatSlow(
+        char* const buff,
+        const std::size_t len,
+        const double n,
+        const int decimals,
+        const Mass::Unit u) noexcept;
+
+    MassFormatter();
+
+
+public:
+
+    /**
+     * Sufficient size for any single formatted Mass
+     */
+    static const std::size_t MAX_LENGTH = 64;
+
+    /**
+     * Sufficient size for formatAll with a single char separator
+     */
+    static const std::size_t MAX_ALL_LENGTH = MAX_LENGTH * _UNIT_COUNT;
+
+    /**
+     * The number of decimals to display n with. This is the position
+     * of the first significant decimal digit (or 0 if there is no
+     * fractional part) and is the same policy used by Mass::toString.
+     */
+    static int decimals(const double n) noexcept;
+
+    static std::size_t format(
+        char* const buff,
+        const std::size_t len,
+        const double amount,
+        const Mass::Unit u) noexcept;
+
+    static std::size_t format(
+        char* const buff,
+        const std::size_t len,
+        const Mass& m) noexcept;
+
+    static std::size_t format(
+        char* const buff,
+        const std::size_t len,
+        const Mass& m,
+        const Mass::Unit u) noexcept;
+
+    /**
+     * Formats m in every Mass::Unit (in Unit order) separated by sep.
+     * m is read once and each unit costs one multiplication.
+     */
+    static std::size_t formatAll(
+        char* const buff,
+        const std::size_t len,
+        const Mass& m,
+        const char sep = '\n') noexcept;
+
+    template <std::size_t N>
+    static std::size_t format(char (&buff)[N], const Mass& m) noexcept {
+        return format(buff, N, m);
+    }
+
+    template <std::size_t N>
+    static std::size_t format(char (&buff)[N], const Mass& m, const Mass::Unit u) noexcept {
+        return format(buff, N, m, u);
+    }
+
+};
+};
+#endif
@@ -0,0 +1,114 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_METRICS_H_44D83E56_E6B6_4DAC_ABFB_61B30B616F38
+#define HX711_METRICS_H_44D83E56_E6B6_4DAC_ABFB_61B30B616F38
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "LatencyHistogram.h"
+
+namespace HX711 {
+
+/**
+ * Health counters for one HX711. Every HX711 owns one (see
+ * HX711::getMetrics) and registers it with MetricsRegistry for as long
+ * as it exists. Counters are only ever updated with relaxed atomic
+ * operations, so keeping them costs the sampling path no locks.
+ */
+struct ScaleMetrics {
+
+    int dataPin;
+    int clockPin;
+
+    /**
+     * Values successfully read from the chip
+     */
+    std::atomic<std::uint64_t> values;
+
+    /**
+     * Conversions the watcher thread did not read before the next one
+     * was ready, estimated from the time between reads
+     */
+    std::atomic<std::uint64_t> missed;
+
+    /**
+     * Values the watcher read which were discarded before being taken
+     * by getValues, because its buffer was full or they were too old
+     */
+    std::atomic<std::uint64_t> dropped;
+
+    std::atomic<std::uint64_t> integrityFailures;
+    std::atomic<std::uint64_t> gpioErrors;
+
+    /**
+     * CPU time used by the watcher thread (AdvancedHX711 only)
+     */
+    std::atomic<std::uint64_t> watcherCpuNanos;
+
+    /**
+     * The latest result of AbstractScale::weight, in grams. NaN until
+     * weight has been called.
+     */
+    std::atomic<double> weight;
+
+    const LatencyHistogram* waitReadyLatency;
+    const LatencyHistogram* readValueLatency;
+
+    ScaleMetrics(const int dataPin, const int clockPin) noexcept;
+
+    ScaleMetrics(const ScaleMetrics& that) = delete;
+    ScaleMetrics& operator=(const ScaleMetrics& that) = delete;
+
+};
+
+/**
+ * Every ScaleMetrics in the process, so one scrape covers all scales.
+ * Adding, removing, and exporting take a lock; updating counters does
+ * not.
+ */
+class MetricsRegistry {
+
+protected:
+    mutable std::mutex _lock;
+    std::vector<const ScaleMetrics*> _scales;
+
+
+public:
+    static MetricsRegistry* getInstance() noexcept;
+
+    void add(const ScaleMetrics* const m) noexcept;
+    void remove(const ScaleMetrics* const m) noexcept;
+    std::size_t size() const noexcept;
+
+    /**
+     * Snapshot of every registered scale in the Prometheus text
+     * exposition format, with data_pin and clock_pin labels
+     */
+    std::string toPrometheus() const;
+
+};
+};
+#endif
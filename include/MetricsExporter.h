@@ -0,0 +1,115 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_METRICSEXPORTER_H_62C9475B_130E_48AB_BB41_E4B8DC4FEF9C
+#define HX711_METRICSEXPORTER_H_62C9475B_130E_48AB_BB41_E4B8DC4FEF9C
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "Metrics.h"
+
+namespace HX711 {
+
+enum class MetricsExportMode : unsigned char {
+
+    /**
+     * Rewrite a file every interval, eg. for node_exporter's textfile
+     * collector. The file is replaced atomically, so a reader never
+     * sees a partial snapshot.
+     */
+    FILE,
+
+    /**
+     * Listen on a Unix domain socket and send a snapshot to each
+     * client. A client which sends an HTTP request gets an HTTP
+     * response; any other client gets the plain text.
+     */
+    SOCKET
+
+};
+
+/**
+ * Exports a MetricsRegistry in the Prometheus text format from a
+ * background thread. Nothing is done on the sampling path.
+ */
+class MetricsExporter {
+
+protected:
+
+    static constexpr auto _DEFAULT_INTERVAL = std::chrono::duration_cast
+        <std::chrono::nanoseconds>(std::chrono::seconds(1));
+
+    //how long to wait for an HTTP request line before sending plain text
+    static constexpr auto _REQUEST_WAIT = std::chrono::milliseconds(100);
+
+    //a client which has not taken all of the metrics by then is dropped
+    static constexpr auto _SEND_TIMEOUT = std::chrono::milliseconds(1000);
+
+    //how often the thread checks whether it should stop
+    static constexpr auto _STOP_CHECK = std::chrono::milliseconds(250);
+
+    const std::string _path;
+    const MetricsExportMode _mode;
+    const std::chrono::nanoseconds _interval;
+    const MetricsRegistry* const _registry;
+    int _fd;
+    std::atomic<bool> _running;
+    std::atomic<std::uint64_t> _exports;
+    std::atomic<std::uint64_t> _errors;
+    std::thread _thread;
+
+    void _listen();
+    void _fileLoop() noexcept;
+    void _socketLoop() noexcept;
+    bool _writeFile() noexcept;
+    bool _serve(const int client) noexcept;
+
+
+public:
+
+    /**
+     * Starts exporting to path. For SOCKET, any existing file at path
+     * is removed first. interval only applies to FILE.
+     */
+    MetricsExporter(
+        const std::string& path,
+        const MetricsExportMode mode = MetricsExportMode::FILE,
+        const std::chrono::nanoseconds interval = _DEFAULT_INTERVAL,
+        const MetricsRegistry* const registry = MetricsRegistry::getInstance());
+
+    MetricsExporter(const MetricsExporter& that) = delete;
+    MetricsExporter& operator=(const MetricsExporter& that) = delete;
+
+    /**
+     * Stops the thread and removes the socket, if any
+     */
+    ~MetricsExporter();
+
+    std::uint64_t getExports() const noexcept;
+    std::uint64_t getErrors() const noexcept;
+
+};
+};
+#endif
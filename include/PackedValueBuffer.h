@@ -0,0 +1,139 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_PACKEDVALUEBUFFER_H_4EBEF583_CB5D_4D6E_93E2_CB1DB2F7BAA0
+#define HX711_PACKEDVALUEBUFFER_H_4EBEF583_CB5D_4D6E_93E2_CB1DB2F7BAA0
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * A compact, append-only history of Values and the times they were
+ * obtained.
+ * 
+ * Values are stored as 3 bytes (HX711 values are 24 bits) and times are
+ * stored as a 1 byte delta from the previous time, in units of the
+ * buffer's resolution. Samples are grouped into fixed-size blocks which
+ * each hold one full timestamp, so memory use is a little over 4 bytes
+ * per sample.
+ * 
+ * Times are quantised to the resolution, but error does not accumulate
+ * because each delta is taken from the previous quantised time. A delta
+ * which does not fit in a byte (eg. after sampling pauses) is escaped
+ * and kept in a small table in the block, so a gap does not waste the
+ * rest of a block.
+ */
+class PackedValueBuffer {
+
+public:
+
+    static const std::size_t BLOCK_SIZE = 256;
+
+
+protected:
+
+    static const std::size_t _BYTES_PER_VALUE = 3;
+
+    //deltas of _LONG_DELTA or more are stored in Block::longDeltas
+    static const std::uint8_t _LONG_DELTA = UINT8_MAX;
+    static const std::size_t _MAX_LONG_DELTAS = 8;
+
+    static constexpr auto _DEFAULT_RESOLUTION = std::chrono::duration_cast
+        <std::chrono::nanoseconds>(std::chrono::milliseconds(1));
+
+    struct Block {
+        std::int64_t start;
+        std::uint32_t count;
+        std::uint32_t longCount;
+        std::uint8_t values[BLOCK_SIZE * _BYTES_PER_VALUE];
+        std::uint8_t deltas[BLOCK_SIZE];
+
+        //in the order of the deltas equal to _LONG_DELTA
+        std::uint32_t longDeltas[_MAX_LONG_DELTAS];
+    };
+
+    std::deque<Block> _blocks;
+    std::chrono::nanoseconds _resolution;
+    std::size_t _maxBlocks;
+    std::size_t _size;
+    std::int64_t _lastTick;
+
+    static void _unpackValues(
+        const std::uint8_t* const src,
+        const std::size_t count,
+        val_t* const dst) noexcept;
+
+    void _newBlock(const std::int64_t tick);
+
+
+public:
+
+    /**
+     * resolution is the granularity at which times are stored. Up to
+     * 8 gaps between samples in a block may be longer than 254 times
+     * the resolution, and any gap may be up to 2^32 - 1 times it.
+     * 
+     * maxSamples limits the size of the buffer; once full, the oldest
+     * block of samples is discarded. 0 means unlimited.
+     */
+    explicit PackedValueBuffer(
+        const std::chrono::nanoseconds resolution = _DEFAULT_RESOLUTION,
+        const std::size_t maxSamples = 0);
+
+    /**
+     * Only values within the HX711's 24 bit range (see Value::isValid)
+     * can be stored. when is a time as returned by Utility::getnanos and
+     * should not be earlier than the previously pushed time.
+     */
+    void push(const Value v, const std::chrono::nanoseconds when);
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    void clear() noexcept;
+
+    std::chrono::nanoseconds getResolution() const noexcept;
+
+    /**
+     * Approximate number of bytes used to hold the samples
+     */
+    std::size_t memoryUsage() const noexcept;
+
+    std::size_t blockCount() const noexcept;
+
+    /**
+     * Unpacks the block at index into the given arrays, which must each
+     * have room for BLOCK_SIZE elements. Either may be nullptr if not
+     * needed. Returns the number of samples unpacked.
+     */
+    std::size_t unpack(
+        const std::size_t index,
+        val_t* const vals,
+        std::chrono::nanoseconds* const times = nullptr) const;
+
+};
+};
+#endif
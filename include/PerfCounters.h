@@ -0,0 +1,180 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_PERFCOUNTERS_H_F5FFDED7_F6DB_4CEB_B44C_9A42C164C6F0
+#define HX711_PERFCOUNTERS_H_F5FFDED7_F6DB_4CEB_B44C_9A42C164C6F0
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace HX711 {
+
+enum class PerfCounter : unsigned char {
+    CYCLES,
+    INSTRUCTIONS,
+    CONTEXT_SWITCHES,
+    PAGE_FAULTS
+};
+
+struct PerfSample {
+    static const std::size_t COUNTERS = 4;
+
+    /**
+     * Indexed by PerfCounter
+     */
+    std::uint64_t values[COUNTERS];
+};
+
+/**
+ * Hardware and software performance counters (see perf_event_open(2))
+ * for the thread which creates the object, read together as a group.
+ * 
+ * Counters are opened individually, so whichever the kernel, CPU, and
+ * perf_event_paranoid setting allow are used and the rest read as 0.
+ * Check isAvailable. Only user space is counted where the kernel
+ * requires it.
+ */
+class PerfCounters {
+
+protected:
+    int _leader;
+    std::size_t _count;
+
+    //in the order they joined the group; _fds[0] is _leader
+    int _fds[PerfSample::COUNTERS];
+    PerfCounter _order[PerfSample::COUNTERS];
+    bool _available[PerfSample::COUNTERS];
+
+    static int _open(const PerfCounter c, const int group) noexcept;
+
+
+public:
+    PerfCounters() noexcept;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters& that) = delete;
+    PerfCounters& operator=(const PerfCounters& that) = delete;
+
+    bool isAvailable(const PerfCounter c) const noexcept;
+    bool anyAvailable() const noexcept;
+
+    /**
+     * Running totals since the counters were opened. Returns false,
+     * leaving s zeroed, if no counters are available or the read fails.
+     */
+    bool read(PerfSample* const s) const noexcept;
+
+    static const char* getName(const PerfCounter c) noexcept;
+
+};
+
+/**
+ * Operations PerfProfiler can measure
+ */
+enum class PerfOp : unsigned char {
+    READ_VALUE,     //HX711::readValue
+    SCALE_READ,     //AbstractScale::read, including the samples it waits for
+    MEDIAN,         //the median filter in AbstractScale::read
+    AVERAGE         //the average filter in AbstractScale::read
+};
+
+/**
+ * Process-wide per-operation totals of PerfCounters, off by default.
+ * When enabled, each measured operation costs two reads of the calling
+ * thread's counters (a system call each); when disabled, one atomic
+ * load. Counters are opened for each thread the first time it is
+ * measured.
+ */
+class PerfProfiler {
+
+public:
+
+    static const std::size_t OPS = 4;
+
+    struct Stats {
+        std::uint64_t calls;
+
+        /**
+         * Totals, indexed by PerfCounter
+         */
+        std::uint64_t values[PerfSample::COUNTERS];
+
+        /**
+         * Whether each counter could be opened on every thread measured
+         */
+        bool available[PerfSample::COUNTERS];
+    };
+
+protected:
+    static std::atomic<bool> _enabled;
+    static std::atomic<std::uint64_t> _calls[OPS];
+    static std::atomic<std::uint64_t> _totals[OPS][PerfSample::COUNTERS];
+
+    //bit per counter which was unavailable on any measured thread
+    static std::atomic<unsigned> _unavailable;
+
+    PerfProfiler();
+
+
+public:
+    static void enable() noexcept;
+    static void disable() noexcept;
+    static bool isEnabled() noexcept;
+    static void reset() noexcept;
+
+    /**
+     * Counters for the calling thread, opened on first use
+     */
+    static const PerfCounters& getThreadCounters() noexcept;
+
+    static void add(
+        const PerfOp op,
+        const PerfSample& start,
+        const PerfSample& end) noexcept;
+
+    static Stats getStats(const PerfOp op) noexcept;
+    static const char* getName(const PerfOp op) noexcept;
+
+};
+
+/**
+ * Measures op from construction to destruction if PerfProfiler is
+ * enabled
+ */
+class PerfScope {
+
+protected:
+    const PerfOp _op;
+    bool _active;
+    PerfSample _start;
+
+public:
+    explicit PerfScope(const PerfOp op) noexcept;
+    ~PerfScope();
+
+    PerfScope(const PerfScope& that) = delete;
+    PerfScope& operator=(const PerfScope& that) = delete;
+
+};
+};
+#endif
@@ -0,0 +1,107 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_QUANTILESINK_H_8FB2BB87_A208_4A91_B94D_B97DC1BDEB1B
+#define HX711_QUANTILESINK_H_8FB2BB87_A208_4A91_B94D_B97DC1BDEB1B
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "QuantileSketch.h"
+#include "SampleSink.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * Feeds every sample into a QuantileSketch, for quantiles of weights
+ * over long periods.
+ * 
+ * push converts the value to a weight with the calibration given to
+ * the constructor or setCalibration (1 and 0 keep raw values), and
+ * stages it in a small lock-free ring. It then adds staged values to
+ * the sketch only if no reader holds it, so the sampling thread never
+ * waits. Staged values are also added by readers. If the ring fills
+ * while a reader holds the sketch, values are dropped and counted.
+ */
+class QuantileSink : public SampleSink {
+
+protected:
+
+    static const std::size_t _STAGING_SIZE = 256;
+
+    mutable std::mutex _mtx;
+    mutable QuantileSketch _sketch;
+
+    //refUnit in the high 32 bits and offset in the low, so the two
+    //change together
+    std::atomic<std::uint64_t> _calibration;
+
+    std::vector<double> _staging;
+    std::atomic<std::size_t> _head;
+    mutable std::atomic<std::size_t> _tail;
+    mutable std::atomic<std::uint64_t> _dropped;
+
+    //only called with _mtx held
+    void _drain() const noexcept;
+
+    static std::uint64_t _pack(const Value refUnit, const Value offset) noexcept;
+
+
+public:
+
+    explicit QuantileSink(
+        const Value refUnit = 1,
+        const Value offset = 0,
+        const QuantileSketch& sketch = QuantileSketch());
+
+    QuantileSink(const QuantileSink& that) = delete;
+    QuantileSink& operator=(const QuantileSink& that) = delete;
+
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept override;
+
+    /**
+     * Applies to values pushed from now on. Throws
+     * std::invalid_argument if refUnit is 0.
+     */
+    void setCalibration(const Value refUnit, const Value offset);
+
+    /**
+     * Copies the sketch, including every value pushed so far, into out
+     */
+    void getSketch(QuantileSketch* const out) const;
+
+    double quantile(const double q) const;
+
+    /**
+     * Empties the sketch, eg. at the start of a new reporting period
+     */
+    void reset();
+
+    std::uint64_t getDropped() const noexcept;
+
+};
+};
+#endif
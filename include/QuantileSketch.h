@@ -0,0 +1,140 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_QUANTILESKETCH_H_22BC8E17_D40E_4961_8A18_7008C3701B08
+#define HX711_QUANTILESKETCH_H_22BC8E17_D40E_4961_8A18_7008C3701B08
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace HX711 {
+
+/**
+ * A KLL quantile sketch: estimates quantiles (eg. the median or 99th
+ * percentile) of any number of values in a few KB.
+ * 
+ * Values are kept in levels. Each value in level h stands for 2^h of
+ * the values added. When the sketch is full, the lowest level over its
+ * capacity is sorted and every other value (starting at random from
+ * the first or second) is promoted to the level above, halving it.
+ * Capacities shrink geometrically (by 2/3) from the top level down, so
+ * about 3k values are kept in total and the rank error of a quantile
+ * is about 1.7 / k (1% with k = 200) of the number of values added.
+ * 
+ * Sketches with the same k can be merged, so sketches of different
+ * scales, periods, or parts of a log can be combined. The random
+ * choices come from a seeded generator, so the same values added (and
+ * merged) in the same order always give the same sketch.
+ */
+class QuantileSketch {
+
+protected:
+
+    static const std::size_t _DEFAULT_K = 200;
+
+    //capacity of the smallest levels
+    static const std::size_t _MIN_WIDTH = 8;
+
+    static const std::uint64_t _DEFAULT_SEED = 0x9e3779b97f4a7c15ULL;
+
+    std::size_t _k;
+    std::uint64_t _count;
+    double _min;
+    double _max;
+    std::uint64_t _random;
+
+    /**
+     * Values of every level in one buffer, lowest level first. Level h
+     * is _items[_levels[h]] to _items[_levels[h + 1] - 1], and the
+     * free space is before _levels[0].
+     */
+    std::vector<double> _items;
+    std::vector<std::size_t> _levels;
+
+    std::size_t _numLevels() const noexcept;
+    std::size_t _levelSize(const std::size_t h) const noexcept;
+    std::size_t _capacity(const std::size_t h) const noexcept;
+    std::size_t _totalCapacity() const noexcept;
+    std::size_t _occupied() const noexcept;
+
+    void _resize(const std::size_t size);
+    void _addLevel();
+    void _compact();
+    bool _randomBit() noexcept;
+
+
+public:
+
+    /**
+     * Throws std::invalid_argument if k is less than 8
+     */
+    explicit QuantileSketch(
+        const std::size_t k = _DEFAULT_K,
+        const std::uint64_t seed = _DEFAULT_SEED);
+
+    /**
+     * Allocates only when a level is added, which happens each time
+     * the number of values added roughly doubles
+     */
+    void add(const double v);
+
+    /**
+     * Adds every value from s. Throws std::invalid_argument if s has a
+     * different k.
+     */
+    void merge(const QuantileSketch& s);
+
+    void clear() noexcept;
+
+    /**
+     * Estimated value at quantile q (0 to 1). q <= 0 and q >= 1 give
+     * the exact minimum and maximum. 0 if the sketch is empty.
+     */
+    double quantile(const double q) const;
+
+    /**
+     * As quantile, for count quantiles at once (sorting once)
+     */
+    void quantiles(
+        const double* const qs,
+        const std::size_t count,
+        double* const out) const;
+
+    /**
+     * Estimated fraction of values less than or equal to v
+     */
+    double rank(const double v) const noexcept;
+
+    std::uint64_t getCount() const noexcept;
+    double getMin() const noexcept;
+    double getMax() const noexcept;
+    std::size_t getK() const noexcept;
+
+    /**
+     * Number of values stored
+     */
+    std::size_t getRetained() const noexcept;
+
+};
+};
+#endif
@@ -0,0 +1,154 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_QUANTITY_H_0B0A2198_1CFC_468E_A2AC_F4157C297EF8
+#define HX711_QUANTITY_H_0B0A2198_1CFC_468E_A2AC_F4157C297EF8
+
+#include "Mass.h"
+
+namespace HX711 {
+
+/**
+ * A Quantity is an amount of mass with its unit fixed at compile time.
+ * Converting between Quantity types uses the constexpr ratios in Mass
+ * and so folds down to a single multiplication. eg.
+ * 
+ * const Grams g(250);
+ * const Ounces oz = g; //8.818... oz
+ */
+template <Mass::Unit U>
+class Quantity {
+
+protected:
+
+    template <Mass::Unit From, Mass::Unit To>
+    struct _Ratio {
+        static constexpr double value = Mass::ratio(From, To);
+    };
+
+    double _v;
+
+
+public:
+
+    static constexpr Mass::Unit unit = U;
+
+    constexpr explicit Quantity(const double v = 0.0) noexcept
+        : _v(v) { }
+
+    //cppcheck-suppress noExplicitConstructor
+    template <Mass::Unit From>
+    constexpr Quantity(const Quantity<From>& q) noexcept
+        : _v(q.getValue() * _Ratio<From, U>::value) { }
+
+    explicit Quantity(const Mass& m) noexcept
+        : _v(m.getValue(U)) { }
+
+    constexpr double getValue() const noexcept {
+        return this->_v;
+    }
+
+    template <Mass::Unit To>
+    constexpr Quantity<To> convertTo() const noexcept {
+        return Quantity<To>(*this);
+    }
+
+    Mass toMass() const noexcept {
+        return Mass(this->_v, U);
+    }
+
+    constexpr Quantity operator-() const noexcept {
+        return Quantity(-this->_v);
+    }
+
+    constexpr Quantity operator+(const Quantity& rhs) const noexcept {
+        return Quantity(this->_v + rhs._v);
+    }
+
+    constexpr Quantity operator-(const Quantity& rhs) const noexcept {
+        return Quantity(this->_v - rhs._v);
+    }
+
+    constexpr Quantity operator*(const double rhs) const noexcept {
+        return Quantity(this->_v * rhs);
+    }
+
+    constexpr Quantity operator/(const double rhs) const noexcept {
+        return Quantity(this->_v / rhs);
+    }
+
+    Quantity& operator+=(const Quantity& rhs) noexcept {
+        this->_v += rhs._v;
+        return *this;
+    }
+
+    Quantity& operator-=(const Quantity& rhs) noexcept {
+        this->_v -= rhs._v;
+        return *this;
+    }
+
+    constexpr bool operator==(const Quantity& rhs) const noexcept {
+        return this->_v == rhs._v;
+    }
+
+    constexpr bool operator!=(const Quantity& rhs) const noexcept {
+        return this->_v != rhs._v;
+    }
+
+    constexpr bool operator<(const Quantity& rhs) const noexcept {
+        return this->_v < rhs._v;
+    }
+
+    constexpr bool operator>(const Quantity& rhs) const noexcept {
+        return this->_v > rhs._v;
+    }
+
+    constexpr bool operator<=(const Quantity& rhs) const noexcept {
+        return this->_v <= rhs._v;
+    }
+
+    constexpr bool operator>=(const Quantity& rhs) const noexcept {
+        return this->_v >= rhs._v;
+    }
+
+};
+
+template <Mass::Unit U>
+constexpr Mass::Unit Quantity<U>::unit;
+
+template <Mass::Unit U>
+template <Mass::Unit From, Mass::Unit To>
+constexpr double Quantity<U>::_Ratio<From, To>::value;
+
+typedef Quantity<Mass::Unit::UG> Micrograms;
+typedef Quantity<Mass::Unit::MG> Milligrams;
+typedef Quantity<Mass::Unit::G> Grams;
+typedef Quantity<Mass::Unit::KG> Kilograms;
+typedef Quantity<Mass::Unit::TON> Tons;
+typedef Quantity<Mass::Unit::IMP_TON> ImperialTons;
+typedef Quantity<Mass::Unit::US_TON> USTons;
+typedef Quantity<Mass::Unit::ST> Stones;
+typedef Quantity<Mass::Unit::LB> Pounds;
+typedef Quantity<Mass::Unit::OZ> Ounces;
+
+};
+#endif
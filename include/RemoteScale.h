@@ -0,0 +1,149 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_REMOTESCALE_H_3DFE1FFC_0651_44FC_B7D4_AF6ABE107757
+#define HX711_REMOTESCALE_H_3DFE1FFC_0651_44FC_B7D4_AF6ABE107757
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AbstractScale.h"
+#include "DaemonProtocol.h"
+#include "SampleLog.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * A scale served by hx711d. read, weight, and the rest of AbstractScale
+ * work as they do for a local scale, using samples from the daemon.
+ * 
+ * The reference unit, offset, and unit are fetched from the daemon on
+ * connecting and by refresh. zero and setOffset only change this
+ * object; use tare to zero the scale for every client of the daemon.
+ * 
+ * Throws std::runtime_error if the daemon cannot be reached or the
+ * connection fails.
+ */
+class RemoteScale : public AbstractScale {
+
+protected:
+    const std::string _path;
+    const std::uint16_t _scale;
+    int _fd;
+    std::mutex _lock;
+    DaemonScaleInfo _info;
+
+    void _request(
+        const DaemonMessageType type,
+        const DaemonRequest& req,
+        DaemonHeader* const res);
+    void _readPayload(void* const buf, const std::size_t len);
+    void _apply(const DaemonScaleInfo& info) noexcept;
+
+    static DaemonRequest _toRequest(const Options& o) noexcept;
+    static std::vector<Value> _toValues(const std::vector<SampleRecord>& recs);
+
+
+public:
+
+    /**
+     * scale is the index of the scale in the daemon's configuration.
+     * Throws std::out_of_range if the daemon has no such scale.
+     */
+    explicit RemoteScale(const std::string& path, const std::size_t scale = 0);
+
+    RemoteScale(const RemoteScale& that) = delete;
+    RemoteScale& operator=(const RemoteScale& that) = delete;
+
+    virtual ~RemoteScale();
+
+    virtual std::vector<Value> getValues(const std::size_t samples) override;
+    virtual std::vector<Value> getValues(const std::chrono::nanoseconds timeout) override;
+
+    /**
+     * As getValues, but with the time (see Utility::getnanos) each
+     * value was read
+     */
+    std::vector<SampleRecord> getRecords(const Options o = Options());
+
+    /**
+     * Zero the scale in the daemon, for all clients
+     */
+    void tare(const Options o = Options());
+
+    /**
+     * Fetch the reference unit, offset, and unit from the daemon
+     */
+    void refresh();
+
+    DaemonScaleInfo getInfo() const noexcept;
+
+    /**
+     * Every scale the daemon at path serves
+     */
+    static std::vector<DaemonScaleInfo> list(const std::string& path);
+
+};
+
+/**
+ * A stream of every sample from one of hx711d's scales. The stream has
+ * its own connection to the daemon.
+ */
+class RemoteSubscription {
+
+protected:
+    int _fd;
+    std::uint64_t _lost;
+
+
+public:
+    explicit RemoteSubscription(const std::string& path, const std::size_t scale = 0);
+
+    RemoteSubscription(const RemoteSubscription& that) = delete;
+    RemoteSubscription& operator=(const RemoteSubscription& that) = delete;
+
+    ~RemoteSubscription();
+
+    /**
+     * Blocks until the daemon sends a batch of samples, then appends
+     * them to out and returns how many there were
+     */
+    std::size_t next(std::vector<SampleRecord>* const out);
+
+    /**
+     * Samples the daemon could not send because this subscriber fell
+     * too far behind
+     */
+    std::uint64_t getLost() const noexcept;
+
+    /**
+     * For use with poll or select
+     */
+    int getFd() const noexcept;
+
+};
+};
+#endif
@@ -0,0 +1,114 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_REPLAYCHIP_H_725AA348_6011_42FE_86F1_B0F6618D0D5A
+#define HX711_REPLAYCHIP_H_725AA348_6011_42FE_86F1_B0F6618D0D5A
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "SampleLog.h"
+#include "VirtualChip.h"
+
+namespace HX711 {
+
+enum class ReplayMode : unsigned char {
+    REAL_TIME,
+    AS_FAST_AS_POSSIBLE
+};
+
+/**
+ * A VirtualChip which plays back the values in a sample log (see
+ * SampleRecorder). Passed to a HX711, SimpleHX711, or AdvancedHX711
+ * constructor, the whole API - including AbstractScale::weight - then
+ * runs against recorded data.
+ * 
+ * In REAL_TIME mode a value becomes ready once as much time has passed
+ * since the first value was presented as passed between the two when
+ * they were recorded. If more than one value has become due since the
+ * last read, the chip only presents the latest (as a real chip would)
+ * and the others are counted as skipped.
+ * 
+ * In AS_FAST_AS_POSSIBLE mode the next value is ready as soon as the
+ * previous one has been read. A value lost to a power down is presented
+ * again afterwards, so every value in the log is read exactly once.
+ * 
+ * Note that connect() and setConfig() read (and so consume) a value.
+ * Values are replayed as recorded, so the HX711 should use the default
+ * MSB format.
+ */
+class ReplayChip : public VirtualChip {
+
+protected:
+    SampleLog _log;
+    const ReplayMode _mode;
+    const bool _loop;
+    std::size_t _index;
+    std::size_t _skipped;
+    bool _started;
+    std::chrono::nanoseconds _startNow;
+    std::int64_t _startWhen;
+
+    virtual bool _nextConversion(
+        const std::chrono::nanoseconds now,
+        std::uint32_t* const v) override;
+
+    virtual bool _nextConversionAt(std::chrono::nanoseconds* const at) const override;
+
+    virtual void _reset(
+        const std::chrono::nanoseconds now,
+        const bool discarded) override;
+
+
+public:
+
+    /**
+     * Throws std::runtime_error if the log cannot be opened
+     */
+    explicit ReplayChip(
+        const std::string& path,
+        const ReplayMode mode = ReplayMode::REAL_TIME,
+        const bool loop = false);
+
+    const SampleLog& getLog() const noexcept;
+
+    /**
+     * Number of values presented so far, including skipped ones
+     */
+    std::size_t getPosition() const noexcept;
+    std::size_t getSkipped() const noexcept;
+
+    /**
+     * Whether every value in the log has been presented. Always false
+     * when looping.
+     */
+    bool finished() const noexcept;
+
+    /**
+     * Starts playback again from the first value
+     */
+    void rewind() noexcept;
+
+};
+};
+#endif
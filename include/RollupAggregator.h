@@ -0,0 +1,172 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_ROLLUPAGGREGATOR_H_BE5B3ECB_7819_4135_A6F0_A42FB00E2D1E
+#define HX711_ROLLUPAGGREGATOR_H_BE5B3ECB_7819_4135_A6F0_A42FB00E2D1E
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "SampleSink.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * Count, minimum, maximum, mean, and sum of squared differences from
+ * the mean (M2) of the values in one time bucket, kept with Welford's
+ * method so they can be updated one value at a time.
+ */
+struct RollupStats {
+
+    //Utility::getnanos time at which the bucket starts; a multiple of
+    //its interval
+    std::int64_t start;
+
+    std::uint64_t count;
+    double min;
+    double max;
+    double mean;
+    double m2;
+
+    RollupStats() noexcept;
+
+    void add(const double v) noexcept;
+
+    /**
+     * Combines with the stats of another set of values
+     */
+    void merge(const RollupStats& s) noexcept;
+
+    /**
+     * Sample variance, or 0 with fewer than 2 values
+     */
+    double variance() const noexcept;
+    double stddev() const noexcept;
+
+    /**
+     * Converts stats of raw values to stats of weights, as
+     * AbstractScale::normalise would
+     */
+    RollupStats calibrated(const Value refUnit, const Value offset) const noexcept;
+
+};
+
+/**
+ * Maintains RollupStats for fixed time buckets at one or more
+ * resolutions (eg. per second and per minute) from every sample, so
+ * dashboards can read summaries without sampling themselves.
+ * 
+ * push updates the current bucket of each resolution in constant time
+ * without allocating or locking. Each resolution keeps its last history
+ * buckets in a ring guarded by a sequence counter (a seqlock): readers
+ * copy a bucket and retry if push changed it meanwhile, so they never
+ * block the sampling thread and are never blocked by each other.
+ * 
+ * Stats are of raw values; use RollupStats::calibrated for weights.
+ * Buckets in which no samples were read are skipped, not stored empty.
+ */
+class RollupAggregator : public SampleSink {
+
+protected:
+
+    static const std::size_t _DEFAULT_HISTORY = 60;
+
+    struct _Bucket {
+        std::atomic<std::int64_t> start;
+        std::atomic<std::uint64_t> count;
+        std::atomic<double> min;
+        std::atomic<double> max;
+        std::atomic<double> mean;
+        std::atomic<double> m2;
+    };
+
+    struct _Resolution {
+
+        //odd while push is updating a bucket
+        std::atomic<std::uint64_t> sequence;
+
+        //number of buckets ever started; the newest is at head - 1
+        std::atomic<std::uint64_t> head;
+
+        std::unique_ptr<_Bucket[]> buckets;
+
+        //only used by push
+        std::int64_t interval;
+        RollupStats working;
+
+    };
+
+    const std::size_t _history;
+    std::vector<std::unique_ptr<_Resolution>> _resolutions;
+
+    static void _store(_Bucket* const b, const RollupStats& s) noexcept;
+    static void _load(const _Bucket* const b, RollupStats* const s) noexcept;
+
+
+public:
+
+    /**
+     * One resolution per interval, each keeping history buckets.
+     * Throws std::invalid_argument if there are no intervals, any is
+     * not positive, or history is 0.
+     */
+    explicit RollupAggregator(
+        const std::vector<std::chrono::nanoseconds>& intervals = {
+            std::chrono::seconds(1),
+            std::chrono::minutes(1)
+        },
+        const std::size_t history = _DEFAULT_HISTORY);
+
+    RollupAggregator(const RollupAggregator& that) = delete;
+    RollupAggregator& operator=(const RollupAggregator& that) = delete;
+
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept override;
+
+    std::size_t getResolutions() const noexcept;
+    std::chrono::nanoseconds getInterval(const std::size_t resolution) const noexcept;
+    std::size_t getHistory() const noexcept;
+
+    /**
+     * Copies a bucket of a resolution into out: ago 0 is the current
+     * (still filling) bucket, 1 the one before it, and so on. Returns
+     * false if there is no such bucket.
+     */
+    bool get(
+        const std::size_t resolution,
+        const std::size_t ago,
+        RollupStats* const out) const noexcept;
+
+    /**
+     * Copies every stored bucket of a resolution into out, oldest
+     * first, as one consistent snapshot
+     */
+    void getAll(
+        const std::size_t resolution,
+        std::vector<RollupStats>* const out) const;
+
+};
+};
+#endif
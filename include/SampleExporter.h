@@ -0,0 +1,167 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_SAMPLEEXPORTER_H_DDB3865D_CA33_4F4F_A39D_7398EE3C7484
+#define HX711_SAMPLEEXPORTER_H_DDB3865D_CA33_4F4F_A39D_7398EE3C7484
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CompressedLog.h"
+#include "SampleLog.h"
+#include "Value.h"
+
+namespace HX711 {
+
+enum class ExportFormat : unsigned char {
+
+    //a header line, then unix_ns,value,weight per sample
+    CSV,
+
+    //{"unix_ns":...,"value":...,"weight":...} per sample
+    JSONL
+
+};
+
+/**
+ * Writes samples as text to a file descriptor.
+ * 
+ * Lines are formatted straight into a fixed buffer with integer
+ * arithmetic (as MassFormatter does) and written out whenever it fills,
+ * so memory use does not depend on how many samples are exported and
+ * each write is large. Weights are calibrated with refUnit and offset
+ * and written with a fixed number of decimals.
+ */
+class SampleExporter {
+
+protected:
+
+    static const std::size_t _DEFAULT_BUFFER_SIZE = 1 << 20;
+
+    //longest possible line, in either format
+    static const std::size_t _MAX_LINE = 128;
+
+    static const int _MAX_DECIMALS = 9;
+
+    //longest formatted number, including the sign
+    static const std::size_t _MAX_NUMBER = 25;
+
+    int _fd;
+    bool _ownsFd;
+    const ExportFormat _format;
+    double _refUnit;
+    double _offset;
+    std::int64_t _timeOffset;
+    const int _decimals;
+    const double _scale;
+    std::vector<char> _buff;
+    std::size_t _used;
+    bool _failed;
+    std::uint64_t _rows;
+    std::uint64_t _bytes;
+
+    //writes v at p and returns the end of it
+    static char* _writeInt(char* p, const std::int64_t v) noexcept;
+
+    void _init();
+    char* _formatWeight(char* p, const double w) const noexcept;
+    char* _formatRecord(char* p, const SampleRecord& r) const noexcept;
+
+
+public:
+
+    /**
+     * Writes to fd, which is not closed. timeOffset is added to each
+     * sample's time to give a Unix time (see offsetOf). Throws
+     * std::invalid_argument if refUnit is 0 or decimals is not from 0
+     * to 9.
+     */
+    SampleExporter(
+        const int fd,
+        const ExportFormat format,
+        const Value refUnit = 1,
+        const Value offset = 0,
+        const std::int64_t timeOffset = 0,
+        const int decimals = 3,
+        const std::size_t bufferSize = _DEFAULT_BUFFER_SIZE);
+
+    /**
+     * Creates (or truncates) and writes to the file at path. Also throws
+     * std::runtime_error if it cannot be opened.
+     */
+    SampleExporter(
+        const std::string& path,
+        const ExportFormat format,
+        const Value refUnit = 1,
+        const Value offset = 0,
+        const std::int64_t timeOffset = 0,
+        const int decimals = 3,
+        const std::size_t bufferSize = _DEFAULT_BUFFER_SIZE);
+
+    SampleExporter(const SampleExporter& that) = delete;
+    SampleExporter& operator=(const SampleExporter& that) = delete;
+
+    /**
+     * Flushes, and closes the file if the exporter opened it
+     */
+    ~SampleExporter();
+
+    void append(const SampleRecord& r) noexcept;
+    void append(const SampleRecord* const recs, const std::size_t count) noexcept;
+
+    /**
+     * Every record in the log, in order
+     */
+    void append(const SampleLog& log) noexcept;
+
+    /**
+     * Every record in the log, in order, decoded a block at a time
+     */
+    void append(const CompressedLog& log);
+
+    /**
+     * Writes anything buffered. Returns false if any write so far has
+     * failed; output after a failure is discarded.
+     */
+    bool flush() noexcept;
+
+    /**
+     * Apply to records appended from now on, eg. when exporting live
+     * samples from a scale which is re-tared. setCalibration throws
+     * std::invalid_argument if refUnit is 0.
+     */
+    void setCalibration(const Value refUnit, const Value offset);
+    void setTimeOffset(const std::int64_t timeOffset) noexcept;
+
+    std::uint64_t getRows() const noexcept;
+    std::uint64_t getBytes() const noexcept;
+
+    /**
+     * The timeOffset which converts a log's times to Unix times
+     */
+    static std::int64_t offsetOf(const SampleLog& log) noexcept;
+    static std::int64_t offsetOf(const CompressedLog& log) noexcept;
+
+};
+};
+#endif
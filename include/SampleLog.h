@@ -0,0 +1,178 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_SAMPLELOG_H_4EE5EA4C_1090_4447_B490_EAEBB628C61B
+#define HX711_SAMPLELOG_H_4EE5EA4C_1090_4447_B490_EAEBB628C61B
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "AbstractScale.h"
+#include "HX711.h"
+#include "Mass.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * Binary sample log format
+ * 
+ * A log is a SampleLogHeader followed immediately by any number of
+ * SampleRecords. All fields are in the host's byte order. Both structs
+ * have fixed sizes and alignment so a log can be used directly from
+ * memory once mapped; see SampleLog.
+ * 
+ * Records are only ever appended. A partially written record at the end
+ * of a file (eg. after a crash) is ignored by readers.
+ */
+
+struct SampleLogHeader {
+
+    static constexpr const char* const MAGIC = "HX711LOG";
+    static const std::size_t MAGIC_SIZE = 8;
+    static const std::uint32_t VERSION = 2;
+
+    char magic[MAGIC_SIZE];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t recordSize;
+    std::uint32_t flags;
+
+    /**
+     * Real (wall clock) time and Utility::getnanos time at which the log
+     * was created. Together they map record times to wall clock times.
+     */
+    std::int64_t createdRealtime;
+    std::int64_t createdMonotonic;
+
+    //calibration of the scale being recorded
+    std::int32_t refUnit;
+    std::int32_t offset;
+    std::int32_t dataPin;
+    std::int32_t clockPin;
+    std::uint8_t rate;
+    std::uint8_t channel;
+    std::uint8_t gain;
+    std::uint8_t unit;
+
+    std::uint8_t reserved[4];
+
+    //Utility::getBootId when the log was created; records are only
+    //appended during the same boot
+    std::uint8_t bootId[16];
+
+};
+
+struct SampleRecord {
+
+    //Utility::getnanos time at which the value was read
+    std::int64_t when;
+    std::int32_t value;
+    std::uint32_t flags;
+
+};
+
+static_assert(sizeof(SampleLogHeader) == 80, "unexpected SampleLogHeader size");
+static_assert(sizeof(SampleRecord) == 16, "unexpected SampleRecord size");
+
+/**
+ * Calibration and configuration of a scale, written into a log's header
+ */
+struct SampleLogMeta {
+
+    Value refUnit;
+    Value offset;
+    int dataPin;
+    int clockPin;
+    Rate rate;
+    Channel channel;
+    Gain gain;
+    Mass::Unit unit;
+
+    SampleLogMeta() noexcept;
+
+    //for SimpleHX711 and AdvancedHX711, pass the same object twice
+    SampleLogMeta(const AbstractScale& scale, const HX711& hx) noexcept;
+
+    void writeTo(SampleLogHeader* const h) const noexcept;
+
+};
+
+/**
+ * Read-only view of a sample log. The file is memory-mapped so records
+ * are accessed in place without parsing or copying.
+ */
+class SampleLog {
+
+protected:
+    int _fd;
+    const std::uint8_t* _map;
+    std::size_t _mapSize;
+    std::size_t _count;
+
+    void _unmap() noexcept;
+
+
+public:
+
+    /**
+     * Throws std::runtime_error if the file cannot be opened or is not
+     * a compatible sample log
+     */
+    explicit SampleLog(const std::string& path);
+
+    SampleLog(const SampleLog& that) = delete;
+    SampleLog& operator=(const SampleLog& that) = delete;
+
+    ~SampleLog();
+
+    /**
+     * Remaps the file to pick up any records appended since it was
+     * opened or last refreshed. If it throws, the log is left as it
+     * was.
+     */
+    void refresh();
+
+    const SampleLogHeader& header() const noexcept;
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    const SampleRecord* begin() const noexcept;
+    const SampleRecord* end() const noexcept;
+    const SampleRecord& operator[](const std::size_t i) const noexcept;
+
+    /**
+     * Converts a record time to a wall clock time since the epoch
+     */
+    std::chrono::nanoseconds toRealtime(const std::int64_t when) const noexcept;
+
+    /**
+     * Throws std::runtime_error if h is not a header this version of
+     * the library can read
+     */
+    static void validate(const SampleLogHeader& h);
+
+};
+};
+#endif
@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_SAMPLERECORDER_H_A93BB73C_F5EB_408F_91A8_E71A8EEDF21D
+#define HX711_SAMPLERECORDER_H_A93BB73C_F5EB_408F_91A8_E71A8EEDF21D
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SampleLog.h"
+#include "SampleSink.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * Writes samples to a binary sample log (see SampleLog.h).
+ * 
+ * push only copies the sample into a fixed-size ring buffer, so it never
+ * allocates, blocks, or touches the disk. A background thread drains the
+ * ring and writes records to the file in large batches. If the ring is
+ * full, the sample is dropped and counted (see getDropped).
+ */
+class SampleRecorder : public SampleSink {
+
+protected:
+
+    static const std::size_t _DEFAULT_CAPACITY = 1 << 16;
+
+    static constexpr auto _DEFAULT_FLUSH_INTERVAL = std::chrono::duration_cast
+        <std::chrono::nanoseconds>(std::chrono::milliseconds(250));
+
+    int _fd;
+    std::vector<SampleRecord> _ring;
+    const std::size_t _mask;
+    const std::chrono::nanoseconds _flushInterval;
+
+    //_head is written only by push; _tail only by the writer thread
+    std::atomic<std::size_t> _head;
+    std::atomic<std::size_t> _tail;
+
+    std::atomic<bool> _running;
+    std::atomic<std::uint64_t> _written;
+    std::atomic<std::uint64_t> _dropped;
+    std::atomic<std::uint64_t> _writeErrors;
+    std::thread _writer;
+
+    void _openLog(const std::string& path, const SampleLogMeta& meta);
+    void _writeLoop() noexcept;
+    std::size_t _drain() noexcept;
+
+
+public:
+
+    /**
+     * Appends to the log at path, creating it with meta in its header
+     * if it does not exist. Throws std::runtime_error if the log was
+     * written before the system last booted. capacity is the number of
+     * samples the ring can hold and is rounded up to a power of 2.
+     */
+    SampleRecorder(
+        const std::string& path,
+        const SampleLogMeta& meta = SampleLogMeta(),
+        const std::size_t capacity = _DEFAULT_CAPACITY,
+        const std::chrono::nanoseconds flushInterval = _DEFAULT_FLUSH_INTERVAL);
+
+    SampleRecorder(const SampleRecorder& that) = delete;
+    SampleRecorder& operator=(const SampleRecorder& that) = delete;
+
+    /**
+     * Writes any remaining samples and closes the log
+     */
+    virtual ~SampleRecorder();
+
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept override;
+
+    std::uint64_t getWritten() const noexcept;
+    std::uint64_t getDropped() const noexcept;
+    std::uint64_t getWriteErrors() const noexcept;
+
+};
+};
+#endif
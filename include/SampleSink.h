@@ -0,0 +1,52 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_SAMPLESINK_H_E6B7FEF9_A352_49F0_A0FB_D2170A3F5663
+#define HX711_SAMPLESINK_H_E6B7FEF9_A352_49F0_A0FB_D2170A3F5663
+
+#include <chrono>
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * A SampleSink receives every Value read from a HX711 chip along with
+ * the time (see Utility::getnanos) at which the read began. Attach one
+ * with HX711::addSink.
+ * 
+ * push is called on whichever thread read the value - for an
+ * AdvancedHX711 that is the watcher thread - so implementations must
+ * return quickly and must not block.
+ * 
+ * A HX711 pushes to its sinks while holding a lock, so it never calls
+ * push from two threads at once. Implementations rely on this and are
+ * single-producer: unless it says otherwise, a sink must not be
+ * attached to more than one HX711 or pushed to from more than one
+ * thread.
+ */
+class SampleSink {
+public:
+    virtual ~SampleSink() = default;
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept = 0;
+};
+};
+#endif
@@ -0,0 +1,190 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_SHAREDRING_H_858D4A0A_E748_4F15_9AD6_9AFB223161EF
+#define HX711_SHAREDRING_H_858D4A0A_E748_4F15_9AD6_9AFB223161EF
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "SampleLog.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * Shared memory sample ring format
+ * 
+ * A POSIX shared memory object holding a SharedRingHeader followed by
+ * capacity SharedRingSlots. One process publishes samples into it (see
+ * SharedRingPublisher) and any number of others map it read-only and
+ * read them (see SharedRingReader) without system calls or locks.
+ * 
+ * Sample n is stored in slot n % capacity. The publisher zeroes the
+ * slot's generation, writes the sample, then sets the generation to
+ * n + 1. A reader copies the slot between two reads of the generation
+ * and keeps the copy only if both equal n + 1; otherwise the slot was
+ * overwritten while it was being read and the sample is lost.
+ * 
+ * The calibration is guarded by its own sequence counter, which is odd
+ * while it is being changed.
+ * 
+ * Every atomic must be lock-free, as locks would not be shared between
+ * processes.
+ */
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64-bit atomics must be lock-free");
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "32-bit atomics must be lock-free");
+
+struct SharedRingSlot {
+    std::atomic<std::uint64_t> generation;
+    std::atomic<std::int64_t> when;
+    std::atomic<std::int32_t> value;
+    std::atomic<std::uint32_t> flags;
+};
+
+struct SharedRingHeader {
+
+    static constexpr const char* const MAGIC = "HX711SHM";
+    static const std::size_t MAGIC_SIZE = 8;
+    static const std::uint32_t VERSION = 1;
+
+    char magic[MAGIC_SIZE];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t slotSize;
+
+    //always a power of 2
+    std::uint32_t capacity;
+
+    //as SampleLogHeader
+    std::int64_t createdRealtime;
+    std::int64_t createdMonotonic;
+    std::int32_t dataPin;
+    std::int32_t clockPin;
+    std::uint8_t rate;
+    std::uint8_t channel;
+    std::uint8_t gain;
+    std::uint8_t unit;
+
+    //non-zero once the publisher has gone away
+    std::atomic<std::uint32_t> closed;
+
+    //number of samples ever published; kept apart from the calibration
+    //so readers polling it do not share a cache line with its writes
+    alignas(64) std::atomic<std::uint64_t> head;
+
+    alignas(64) std::atomic<std::uint64_t> calibrationSequence;
+    std::atomic<std::int32_t> refUnit;
+    std::atomic<std::int32_t> offset;
+
+};
+
+static_assert(sizeof(SharedRingSlot) == 24, "unexpected SharedRingSlot size");
+static_assert(sizeof(SharedRingHeader) == 192, "unexpected SharedRingHeader size");
+
+/**
+ * The most recent sample, and the calibration at the time it was read
+ */
+struct SharedRingSnapshot {
+    std::uint64_t sequence;
+    std::int64_t when;
+    Value value;
+    Value refUnit;
+    Value offset;
+};
+
+/**
+ * Reads samples from a shared memory ring. The ring is mapped
+ * read-only, so nothing a reader does can affect the publisher or any
+ * other reader. Nothing here makes a system call.
+ * 
+ * Each reader has its own position in the ring, which starts at the
+ * newest sample. A reader which falls more than the ring's capacity
+ * behind loses the samples it missed (see getLost).
+ */
+class SharedRingReader {
+
+protected:
+    const SharedRingHeader* _header;
+    const SharedRingSlot* _slots;
+    std::size_t _mapSize;
+    std::uint64_t _mask;
+    std::uint64_t _position;
+    std::uint64_t _lost;
+
+    bool _readSlot(const std::uint64_t n, SampleRecord* const out) const noexcept;
+
+
+public:
+
+    /**
+     * name is as given to SharedRingPublisher, eg. "/hx711.0". Throws
+     * std::runtime_error if it does not exist or is not a compatible
+     * ring.
+     */
+    explicit SharedRingReader(const std::string& name);
+
+    SharedRingReader(const SharedRingReader& that) = delete;
+    SharedRingReader& operator=(const SharedRingReader& that) = delete;
+
+    ~SharedRingReader();
+
+    const SharedRingHeader& header() const noexcept;
+
+    /**
+     * Copies up to max samples published since the last call into out,
+     * oldest first, and returns how many were copied. Returns 0 if
+     * there are none; it does not wait.
+     */
+    std::size_t read(SampleRecord* const out, const std::size_t max) noexcept;
+
+    /**
+     * Moves back to the oldest sample still in the ring
+     */
+    void rewind() noexcept;
+
+    /**
+     * Number of samples the publisher has written which this reader has
+     * not yet read
+     */
+    std::size_t available() const noexcept;
+
+    std::uint64_t getLost() const noexcept;
+
+    /**
+     * Copies the newest sample and the current calibration. Returns
+     * false if nothing has been published yet.
+     */
+    bool getLatest(SharedRingSnapshot* const out) const noexcept;
+
+    /**
+     * True once the publisher has been destroyed. Samples already in
+     * the ring can still be read.
+     */
+    bool isClosed() const noexcept;
+
+};
+};
+#endif
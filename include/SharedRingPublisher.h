@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_SHAREDRINGPUBLISHER_H_EE464102_8CC2_4969_9755_4692AE589A1D
+#define HX711_SHAREDRINGPUBLISHER_H_EE464102_8CC2_4969_9755_4692AE589A1D
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "SampleLog.h"
+#include "SampleSink.h"
+#include "SharedRing.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * Publishes samples into a POSIX shared memory ring (see SharedRing.h)
+ * for other processes to read with SharedRingReader.
+ * 
+ * push writes the sample straight into the shared memory. It never
+ * allocates, blocks, makes a system call, or waits for readers.
+ * 
+ * setCalibration may only be called from one thread at a time.
+ */
+class SharedRingPublisher : public SampleSink {
+
+protected:
+
+    //51 seconds at 80Hz
+    static const std::size_t _DEFAULT_CAPACITY = 1 << 12;
+
+    const std::string _name;
+    SharedRingHeader* _header;
+    SharedRingSlot* _slots;
+    std::size_t _mapSize;
+    std::uint64_t _mask;
+    std::uint64_t _next;
+
+
+public:
+
+    /**
+     * Creates the shared memory object name, which must start with a
+     * '/' and contain no others, replacing any existing one. Its
+     * capacity is rounded up to a power of 2. Throws std::runtime_error
+     * if it cannot be created.
+     */
+    SharedRingPublisher(
+        const std::string& name,
+        const SampleLogMeta& meta,
+        const std::size_t capacity = _DEFAULT_CAPACITY);
+
+    SharedRingPublisher(const SharedRingPublisher& that) = delete;
+    SharedRingPublisher& operator=(const SharedRingPublisher& that) = delete;
+
+    /**
+     * Marks the ring closed and removes its name. Readers which have it
+     * mapped can still read it.
+     */
+    virtual ~SharedRingPublisher();
+
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept override;
+
+    void setCalibration(const Value refUnit, const Value offset) noexcept;
+
+    const std::string& getName() const noexcept;
+
+};
+};
+#endif
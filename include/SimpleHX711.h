@@ -26,6 +26,7 @@
 #include <cstdint>
 #include <vector>
 #include "AbstractScale.h"
+#include "GpioDriver.h"
 #include "HX711.h"
 #include "Value.h"
 
@@ -38,7 +39,8 @@ public:
         const int clockPin,
         const Value refUnit = 1,
         const Value offset = 0,
-        const Rate rate = Rate::HZ_10);
+        const Rate rate = Rate::HZ_10,
+        GpioDriver* const gpio = nullptr);
 
     virtual std::vector<Value> getValues(const std::chrono::nanoseconds timeout) override;
     virtual std::vector<Value> getValues(const std::size_t samples) override;
@@ -0,0 +1,152 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_SIMULATEDCHIP_H_B66331E4_066C_49CF_AABD_8B579FFA91E5
+#define HX711_SIMULATEDCHIP_H_B66331E4_066C_49CF_AABD_8B579FFA91E5
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+#include "HX711.h"
+#include "Mass.h"
+#include "VirtualChip.h"
+
+namespace HX711 {
+
+/**
+ * A VirtualChip which models a HX711 connected to a load cell.
+ * 
+ * - conversions happen every 100ms (10Hz) or 12.5ms (80Hz) whether or
+ *   not they are read; an unread conversion is replaced by the next
+ * - after a reset or change of input/gain, no data is ready until the
+ *   settling time (400ms or 50ms) has passed (datasheet pg. 3)
+ * - the load cell outputs offset + load * refUnit + drift counts at a
+ *   gain of 128, scaled down for a gain of 64 or 32, plus Gaussian noise
+ * - output saturates at 800000h and 7FFFFFh (datasheet pg. 4)
+ * 
+ * offset and refUnit have the same meaning as in AbstractScale. The
+ * noise source is seeded, so a given configuration and sequence of
+ * reads produces the same values on every run.
+ * 
+ * Times given to addLoadStep are relative to when the chip was created.
+ */
+class SimulatedChip : public VirtualChip {
+
+protected:
+
+    typedef std::pair<std::chrono::nanoseconds, double> _step_t;
+
+    static const std::uint32_t _DEFAULT_SEED = 5489u;
+
+    const std::chrono::nanoseconds _period;
+    const std::chrono::nanoseconds _settlingTime;
+    const std::chrono::nanoseconds _epoch;
+    std::mt19937 _rng;
+    std::normal_distribution<double> _normal;
+
+    double _offset;
+    double _refUnit;
+    double _noise;
+    double _drift;
+    double _load;
+    std::vector<_step_t> _steps;
+    std::size_t _nextStep;
+
+    std::chrono::nanoseconds _nextAt;
+    Channel _convChannel;
+    Gain _convGain;
+    std::uint64_t _conversions;
+    std::uint64_t _overruns;
+
+    static std::chrono::nanoseconds _periodOf(const Rate r);
+    double _sample(const std::chrono::nanoseconds at);
+
+    virtual bool _nextConversion(
+        const std::chrono::nanoseconds now,
+        std::uint32_t* const v) override;
+
+    virtual bool _nextConversionAt(std::chrono::nanoseconds* const at) const override;
+
+    virtual void _reset(
+        const std::chrono::nanoseconds now,
+        const bool discarded) override;
+
+
+public:
+
+    /**
+     * Throws std::invalid_argument if rate is not 10Hz or 80Hz
+     */
+    explicit SimulatedChip(
+        const Rate rate = Rate::HZ_80,
+        const std::uint32_t seed = _DEFAULT_SEED);
+
+    /**
+     * Raw value (at a gain of 128) output with no load
+     */
+    void setOffset(const double offset) noexcept;
+
+    /**
+     * Raw counts (at a gain of 128) per gram of load. Throws
+     * std::invalid_argument if 0.
+     */
+    void setReferenceUnit(const double refUnit);
+
+    /**
+     * Standard deviation of the noise in raw counts
+     */
+    void setNoise(const double stddev);
+
+    /**
+     * Raw counts (at a gain of 128) the output drifts by per second
+     */
+    void setDrift(const double countsPerSecond) noexcept;
+
+    /**
+     * Sets the load on the cell immediately
+     */
+    void setLoad(const Mass& m) noexcept;
+
+    /**
+     * Changes the load on the cell to m at the given time since the
+     * chip was created. Steps must be added in time order.
+     */
+    void addLoadStep(const std::chrono::nanoseconds at, const Mass& m);
+
+    Mass getLoad() const noexcept;
+
+    /**
+     * Number of conversions made available to be read
+     */
+    std::uint64_t getConversions() const noexcept;
+
+    /**
+     * Number of conversions which were not made available because
+     * nothing polled the chip in time
+     */
+    std::uint64_t getOverruns() const noexcept;
+
+};
+};
+#endif
@@ -20,47 +20,27 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include <cstdlib>
-#include <iostream>
-#include <string>
-#include <iomanip>
-#include <chrono>
-#include <pthread.h>
-#include <sched.h>
-#include <time.h>
-#include <sys/time.h>
-#include "../include/common.h"
-
-int main(int argc, char** argv) {
-
-    using namespace std;
-    using namespace std::chrono;
-    using namespace HX711;
-
-    const char* const err = "Usage: [DATA PIN] [CLOCK PIN]";
-
-    if(argc != 3) {
-        cout << err << endl;
-        return EXIT_FAILURE;
-    }
-
-    const int dataPin = stoi(argv[1]);
-    const int clockPin = stoi(argv[2]);
-
-    struct sched_param schParams = {
-        sched_get_priority_max(SCHED_FIFO)
-    };
+#ifndef HX711_SYSTEMCLOCK_H_7B018508_9866_4E6F_B0F1_0B8AE09F9647
+#define HX711_SYSTEMCLOCK_H_7B018508_9866_4E6F_B0F1_0B8AE09F9647
 
-    ::pthread_setschedparam(
-        pthread_self(),
-        SCHED_FIFO,
-        &schParams);
-
-    
-
-
-
-
-    return EXIT_SUCCESS;
-
-}
\ No newline at end of file
+#include <chrono>
+#include "Clock.h"
+
+namespace HX711 {
+
+/**
+ * Clock using the system's CLOCK_MONOTONIC_RAW
+ */
+class SystemClock : public Clock {
+public:
+    virtual std::chrono::nanoseconds now() noexcept override;
+    virtual void sleep(const std::chrono::nanoseconds ns) noexcept override;
+    virtual void delay(const std::chrono::nanoseconds ns) noexcept override;
+
+    /**
+     * Shared instance used by default; the clock itself holds no state
+     */
+    static SystemClock* getInstance() noexcept;
+};
+};
+#endif
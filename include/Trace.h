@@ -0,0 +1,153 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_TRACE_H_F0145550_D52C_4579_A319_BA0E095244BF
+#define HX711_TRACE_H_F0145550_D52C_4579_A319_BA0E095244BF
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace HX711 {
+
+/**
+ * Opt-in timeline tracing of what the library's threads are doing:
+ * waiting for the chip, clocking out values, waiting for locks,
+ * enqueueing and draining values, sleeping, and watcher state changes.
+ * The result is Chrome trace JSON, which can be opened in Perfetto
+ * (ui.perfetto.dev) or chrome://tracing.
+ * 
+ * Each thread records into its own fixed-size ring, so recording takes
+ * no locks and, once the ring exists, never allocates. When a ring is
+ * full the oldest events are overwritten, so a dump shows the most
+ * recent activity. When a thread exits its ring, with its events, is
+ * kept for the next new thread to record, so there are only as many
+ * rings as threads have recorded at once. While tracing is disabled
+ * each call costs one atomic load.
+ * 
+ * Event names are stored as pointers and must outlive the trace; use
+ * string literals. Times are from Utility::getnanos.
+ */
+class Trace {
+
+public:
+
+    struct Event {
+        std::int64_t when;
+        const char* name;
+        char phase;
+    };
+
+protected:
+
+    static const std::size_t _DEFAULT_CAPACITY = 1 << 16;
+
+    struct ThreadBuffer {
+        long tid;
+        std::string name;
+        std::vector<Event> events;
+
+        //written only by the owning thread
+        std::atomic<std::uint64_t> head;
+
+        //the owning thread has exited; guarded by _lock
+        bool retired;
+    };
+
+    //retires the thread's ring when the thread exits
+    struct LocalSlot {
+        ThreadBuffer* buff;
+        LocalSlot() noexcept;
+        ~LocalSlot();
+    };
+
+    static std::atomic<bool> _enabled;
+    static std::atomic<std::size_t> _capacity;
+
+    static std::mutex& _lock() noexcept;
+    static std::vector<std::unique_ptr<ThreadBuffer>>& _buffers() noexcept;
+    static ThreadBuffer*& _localSlot() noexcept;
+    static std::string& _localName() noexcept;
+    static ThreadBuffer* _local() noexcept;
+    static void _record(const char* const name, const char phase) noexcept;
+
+    Trace();
+
+
+public:
+
+    /**
+     * Start recording. eventsPerThread is the size of each thread's
+     * ring, and only applies to threads which have not recorded yet.
+     */
+    static void enable(const std::size_t eventsPerThread = _DEFAULT_CAPACITY) noexcept;
+    static void disable() noexcept;
+    static bool isEnabled() noexcept;
+
+    static void begin(const char* const name) noexcept;
+    static void end(const char* const name) noexcept;
+    static void instant(const char* const name) noexcept;
+
+    /**
+     * Name the calling thread in the trace
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * Discard all recorded events
+     */
+    static void clear() noexcept;
+
+    /**
+     * Events can be written while tracing continues, but any being
+     * overwritten at that moment may be reported wrongly. Disable
+     * first for an exact snapshot.
+     */
+    static void write(std::ostream& os);
+    static void dump(const std::string& path);
+
+};
+
+/**
+ * Records a begin event when created and the matching end event when
+ * destroyed
+ */
+class TraceScope {
+
+protected:
+    const char* const _name;
+
+public:
+    explicit TraceScope(const char* const name) noexcept;
+    ~TraceScope();
+
+    TraceScope(const TraceScope& that) = delete;
+    TraceScope& operator=(const TraceScope& that) = delete;
+
+};
+};
+#endif
@@ -0,0 +1,198 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_TRIGGEREDCAPTURE_H_76115DDC_6680_44DF_BA5F_693C7685600D
+#define HX711_TRIGGEREDCAPTURE_H_76115DDC_6680_44DF_BA5F_693C7685600D
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SampleLog.h"
+#include "SampleSink.h"
+#include "Value.h"
+
+namespace HX711 {
+
+enum class TriggerType : unsigned char {
+
+    //a value at or above level, after one below it
+    ABOVE,
+
+    //a value at or below level, after one above it
+    BELOW,
+
+    //a value differing from the one before it by level or more
+    STEP,
+
+    //a saturated value (see Value::isSaturated), after one which was not
+    SATURATED
+
+};
+
+/**
+ * Levels are raw values, as the sampling path does not apply the
+ * calibration. For a weight w, use refUnit * w + offset.
+ */
+struct TriggerCondition {
+
+    TriggerType type;
+    Value level;
+
+    static TriggerCondition above(const Value level) noexcept;
+    static TriggerCondition below(const Value level) noexcept;
+    static TriggerCondition step(const Value level) noexcept;
+    static TriggerCondition saturated() noexcept;
+
+};
+
+/**
+ * Samples around a trigger: up to preSamples before the triggering
+ * sample, the triggering sample itself, then postSamples after it
+ */
+struct Capture {
+
+    //sequence number of the capture, from 0
+    std::uint64_t sequence;
+
+    //index of the condition which fired
+    std::size_t condition;
+
+    //index of the triggering sample in samples
+    std::size_t triggerIndex;
+
+    std::vector<SampleRecord> samples;
+
+};
+
+/**
+ * Captures samples around events, as detected by a list of trigger
+ * conditions.
+ * 
+ * Every sample goes into a small ring holding the pre-trigger window.
+ * When a condition fires, the window is copied into a free capture slot,
+ * which then takes the post-trigger samples. A full slot is passed to
+ * the consumer on a background thread and freed once the consumer
+ * returns. Slots are allocated up front, so push never allocates, locks,
+ * or waits for the consumer. If no slot is free when a condition fires,
+ * the trigger is dropped and counted (see getDropped).
+ * 
+ * Conditions are not evaluated while a capture is taking its
+ * post-trigger samples.
+ */
+class TriggeredCapture : public SampleSink {
+
+public:
+    typedef std::function<void(const Capture&)> Consumer;
+
+
+protected:
+
+    static const std::size_t _DEFAULT_SLOTS = 4;
+
+    //how often the consumer thread checks whether it should stop
+    static constexpr auto _STOP_CHECK = std::chrono::milliseconds(250);
+
+    static const int _SLOT_FREE = 0;
+    static const int _SLOT_FILLING = 1;
+    static const int _SLOT_READY = 2;
+
+    struct _Slot {
+        std::atomic<int> state;
+        Capture capture;
+    };
+
+    const std::vector<TriggerCondition> _conditions;
+    const std::size_t _preSamples;
+    const std::size_t _postSamples;
+    const Consumer _consumer;
+
+    //pre-trigger ring; only touched by push
+    std::vector<SampleRecord> _history;
+    const std::size_t _historyMask;
+    std::uint64_t _pushed;
+    Value _previous;
+
+    std::unique_ptr<_Slot[]> _slots;
+    const std::size_t _slotCount;
+    _Slot* _filling;
+    std::size_t _remaining;
+    std::uint64_t _nextSequence;
+
+    std::atomic<std::uint64_t> _captures;
+    std::atomic<std::uint64_t> _dropped;
+
+    std::atomic<bool> _running;
+    std::mutex _readyLock;
+    std::condition_variable _ready;
+    std::thread _thread;
+
+    std::ptrdiff_t _evaluate(const Value v) const noexcept;
+    void _begin(const std::size_t condition, const SampleRecord& r) noexcept;
+    void _complete() noexcept;
+    _Slot* _nextReady() noexcept;
+    void _deliverLoop() noexcept;
+
+
+public:
+
+    /**
+     * consumer is called on the background thread, one capture at a
+     * time, oldest first
+     */
+    TriggeredCapture(
+        const std::vector<TriggerCondition>& conditions,
+        const std::size_t preSamples,
+        const std::size_t postSamples,
+        const Consumer consumer,
+        const std::size_t slots = _DEFAULT_SLOTS);
+
+    TriggeredCapture(const TriggeredCapture& that) = delete;
+    TriggeredCapture& operator=(const TriggeredCapture& that) = delete;
+
+    /**
+     * Passes any full captures to the consumer, then stops the thread.
+     * A capture still taking post-trigger samples is discarded.
+     */
+    virtual ~TriggeredCapture();
+
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept override;
+
+    /**
+     * Captures passed to the consumer
+     */
+    std::uint64_t getCaptures() const noexcept;
+
+    /**
+     * Triggers ignored because every slot was in use
+     */
+    std::uint64_t getDropped() const noexcept;
+
+};
+};
+#endif
@@ -24,6 +24,7 @@
 #define HX711_UTILITY_H_2F1DEBBD_F7BB_4202_BE2A_A33018D2AF5A
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <climits>
 #include <cstdint>
@@ -31,8 +32,10 @@
 #include <numeric>
 #include <pthread.h>
 #include <stdexcept>
+#include <sys/uio.h>
 #include <time.h>
 #include <vector>
+#include "Clock.h"
 
 namespace HX711 {
 
@@ -44,6 +47,8 @@ enum class GpioLevel : bool {
 class Utility {
 protected:
     static constexpr const char* const _VERSION = "2.19.0";
+    static std::atomic<Clock*> _clock;
+    static const char _DIGIT_PAIRS[201];
     static void _throwGpioExIfErr(const int code);
     Utility();
 
@@ -60,6 +65,15 @@ public:
     static GpioLevel readGpio(const int handle, const int pin);
     static void writeGpio(const int handle, const int pin, const GpioLevel lev);
 
+    /**
+     * Sets the clock used by sleep, delay, and getnanos, and so by the
+     * rest of the library. Set it before creating any HX711 objects.
+     * The clock is not owned. Pass nullptr to go back to the default
+     * SystemClock.
+     */
+    static void setClock(Clock* const clock) noexcept;
+    static Clock* getClock() noexcept;
+
     /**
      * Sleep for ns nanoseconds. The _sleep/_delay functions are
      * an attempt to be analogous to usleep/udelay in the kernel.
@@ -82,6 +96,44 @@ public:
     static void setThreadPriority(
         const int pri, const int policy, const pthread_t th) noexcept;
 
+    /**
+     * Receive exactly len bytes from a socket, or send every byte
+     * described by iov, retrying on short transfers and EINTR. Sending
+     * never raises SIGPIPE. Both return false if the connection failed
+     * or was closed; sendAll modifies iov. If a timeout is given,
+     * sendAll also fails if every byte has not been sent within it,
+     * however slowly the other end keeps reading.
+     */
+    static bool recvAll(const int fd, void* const buf, const std::size_t len) noexcept;
+    static bool sendAll(
+        const int fd,
+        iovec* iov,
+        std::size_t count,
+        const std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) noexcept;
+
+    /**
+     * Writes the decimal digits of v backwards so that they end just
+     * before end, and returns a pointer to the first digit. There must
+     * be room for 20 chars before end. Nothing is null-terminated.
+     */
+    static char* writeUint(char* const end, std::uint64_t v) noexcept;
+
+    static const std::size_t BOOT_ID_SIZE = 16;
+
+    /**
+     * Copies the ID the kernel picked at random for the current boot
+     * (/proc/sys/kernel/random/boot_id) to id, or zeroes id if it cannot
+     * be read. Monotonic times from different boots cannot be compared,
+     * so logs keep this to tell whether they were written since the
+     * system last booted.
+     */
+    static void getBootId(std::uint8_t* const id) noexcept;
+
+    /**
+     * true if id, from getBootId, is the ID of the current boot
+     */
+    static bool isCurrentBoot(const std::uint8_t* const id) noexcept;
+
     template <typename T>
     static double average(const std::vector<T>* const vals) noexcept {
 
@@ -133,6 +185,20 @@ public:
 
     }
 
+    //smallest power of 2 >= n (and >= 1); used to size ring buffers
+    //so indices can be masked rather than divided
+    static std::size_t roundUpPow2(const std::size_t n) noexcept {
+
+        std::size_t p = 1;
+
+        while(p < n) {
+            p <<= 1;
+        }
+
+        return p;
+
+    }
+
     //reverseBits bits in int
     //https://stackoverflow.com/a/2602871/570787
     template <typename T>
@@ -52,9 +52,9 @@ protected:
 public:
 
     /**
-     * Saturation values
+     * Saturation values, after conversion from two's complement
      */
-    static const val_t SATURATION_MIN = 0x800000;
+    static const val_t SATURATION_MIN = -0x800000;
     static const val_t SATURATION_MAX = 0x7FFFFF;
 
     /**
@@ -79,6 +79,7 @@ public:
     //cppcheck-suppress noExplicitConstructor
     Value(const val_t v) noexcept;
     Value() noexcept;
+    Value(const Value& v2) noexcept = default;
     Value& operator=(const Value& v2) noexcept;
 
 };
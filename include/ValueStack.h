@@ -34,14 +34,14 @@ protected:
 
     struct StackEntry {
         Value val;
-        std::chrono::steady_clock::time_point when;
+        std::chrono::nanoseconds when;
     };
 
     static const size_t _DEFAULT_MAX_SIZE = 80;
     static constexpr auto _DEFAULT_MAX_AGE = std::chrono::duration_cast
         <std::chrono::nanoseconds>(std::chrono::seconds(1));
 
-    void _update();
+    std::size_t _update();
 
     std::list<StackEntry> _container;
     std::size_t _maxSize;
@@ -53,8 +53,18 @@ public:
         const std::size_t maxSize = _DEFAULT_MAX_SIZE,
         const std::chrono::nanoseconds maxAge = _DEFAULT_MAX_AGE) noexcept;
 
-    void push(const Value val) noexcept;
+    /**
+     * Returns the number of older entries discarded to make room or
+     * because they had expired
+     */
+    std::size_t push(const Value val) noexcept;
     Value pop() noexcept;
+
+    /**
+     * As pop, and also sets when to the time (see Utility::getnanos)
+     * at which the value was pushed.
+     */
+    Value pop(std::chrono::nanoseconds* const when) noexcept;
     std::size_t size() const noexcept;
     void clear() noexcept;
     bool empty() const noexcept;
@@ -0,0 +1,148 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_VIRTUALCHIP_H_6A4F46A7_A015_417B_9E21_6E92907F4ECA
+#define HX711_VIRTUALCHIP_H_6A4F46A7_A015_417B_9E21_6E92907F4ECA
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include "GpioDriver.h"
+#include "HX711.h"
+#include "Utility.h"
+#include "Value.h"
+
+namespace HX711 {
+
+/**
+ * A GpioDriver which behaves like a HX711 on the other end of the pins,
+ * so HX711 objects can be used without any hardware.
+ * 
+ * The serial interface follows the datasheet (pg. 4-5):
+ * - DOUT is low while a conversion is ready to be read
+ * - each rising edge of PD_SCK shifts out the next bit, MSB first
+ * - after 25, 26, or 27 pulses DOUT goes high and the input and gain
+ *   for the next conversion are Channel A 128, Channel B 32, or
+ *   Channel A 64 respectively
+ * - PD_SCK held high for 60us or more powers the chip down, and
+ *   returning it low resets the chip
+ * 
+ * Where conversions come from is left to derived classes.
+ */
+class VirtualChip : public GpioDriver {
+
+protected:
+
+    static const int _HANDLE = 0;
+    static const unsigned char _BITS = 24;
+    static constexpr auto _POWER_DOWN_TIMEOUT = std::chrono::microseconds(60);
+
+    mutable std::mutex _lock;
+
+    /**
+     * If true, _nextConversion is also polled while a conversion is
+     * ready but not yet being read, and a new one replaces it (as on a
+     * real chip). If false, a ready conversion waits until it is read.
+     */
+    bool _replaceUnread;
+
+    //DOUT reads since the clock last changed
+    unsigned int _idleReads;
+
+    bool _open;
+    int _dataPin;
+    int _clockPin;
+    GpioLevel _clock;
+    GpioLevel _dout;
+    std::chrono::nanoseconds _clockHighSince;
+    bool _poweredDown;
+    bool _resetPending;
+    bool _ready;
+    unsigned char _pulses;
+    std::uint32_t _data;
+    Channel _channel;
+    Gain _gain;
+
+    void _checkHandle(const int handle) const;
+    void _poll(const std::chrono::nanoseconds now);
+    void _risingEdge(const std::chrono::nanoseconds now);
+    void _fallingEdge(const std::chrono::nanoseconds now);
+    void _doReset(const std::chrono::nanoseconds now);
+
+    /**
+     * Called while the chip is waiting for its next conversion (see
+     * also _replaceUnread). Return
+     * true and set *v to a raw 24 bit two's complement value to make it
+     * ready to be read, or false if it is not yet available. The input
+     * and gain the conversion is for are in _channel and _gain.
+     * 
+     * Called with _lock held.
+     */
+    virtual bool _nextConversion(
+        const std::chrono::nanoseconds now,
+        std::uint32_t* const v) = 0;
+
+    /**
+     * If the time at which the next conversion will be ready is known,
+     * set *at to it and return true. The chip uses this to let a
+     * VirtualClock skip ahead while the HX711 waits for data. Called
+     * with _lock held, just after _nextConversion returned false.
+     */
+    virtual bool _nextConversionAt(std::chrono::nanoseconds* const at) const;
+
+    /**
+     * Called when the chip is reset after being powered down. discarded
+     * is true if a conversion was lost without being fully read. Called
+     * with _lock held.
+     */
+    virtual void _reset(
+        const std::chrono::nanoseconds now,
+        const bool discarded);
+
+
+public:
+
+    VirtualChip() noexcept;
+    virtual ~VirtualChip() = default;
+
+    VirtualChip(const VirtualChip& that) = delete;
+    VirtualChip& operator=(const VirtualChip& that) = delete;
+
+    virtual int openHandle(const int chip) override;
+    virtual void closeHandle(const int handle) override;
+    virtual void openInput(const int handle, const int pin) override;
+    virtual void openOutput(const int handle, const int pin) override;
+    virtual void closePin(const int handle, const int pin) override;
+    virtual GpioLevel read(const int handle, const int pin) override;
+    virtual void write(const int handle, const int pin, const GpioLevel lev) override;
+
+    bool isPoweredDown() const noexcept;
+
+    /**
+     * Converts a value to the raw 24 bit two's complement form a
+     * chip would send
+     */
+    static std::uint32_t toRaw(const val_t v) noexcept;
+
+};
+};
+#endif
@@ -0,0 +1,97 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_VIRTUALCLOCK_H_423E78C7_F114_498C_B25C_63455C138079
+#define HX711_VIRTUALCLOCK_H_423E78C7_F114_498C_B25C_63455C138079
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include "Clock.h"
+
+namespace HX711 {
+
+/**
+ * Clock whose time only moves when it is told to, for running
+ * simulations (eg. against a SimulatedChip) faster than real time.
+ * 
+ * - delay returns immediately, having moved time forward to when it
+ *   would have returned
+ * - sleep does the same once no other thread is using the clock, and
+ *   sleeping threads wake in order of their wake times
+ * - each call to now moves time forward by tick, so code which busy
+ *   waits still makes progress
+ * - idleUntil skips ahead, so busy waiting on a VirtualChip (eg. by
+ *   SimpleHX711) jumps straight to its next conversion
+ * 
+ * With one thread, a run is deterministic. When several threads use
+ * the clock (eg. AdvancedHX711's watcher) the order they run in still
+ * depends on the OS, so runs are fast but not exactly repeatable.
+ */
+class VirtualClock : public Clock {
+
+protected:
+    static constexpr auto _DEFAULT_TICK = std::chrono::nanoseconds(1000);
+
+    /**
+     * Real time a sleeping thread waits for the clock to stop moving
+     * before it decides every other thread is asleep or idle
+     */
+    static constexpr auto _QUIET_PERIOD = std::chrono::microseconds(20);
+
+    std::atomic<std::int64_t> _now;
+    std::atomic<std::int64_t> _tick;
+
+    std::mutex _sleepLock;
+    std::condition_variable _sleepCond;
+    std::multiset<std::int64_t> _sleepers;
+
+    void _advanceTo(const std::int64_t t) noexcept;
+
+
+public:
+
+    explicit VirtualClock(
+        const std::chrono::nanoseconds start = std::chrono::nanoseconds(0),
+        const std::chrono::nanoseconds tick = _DEFAULT_TICK) noexcept;
+
+    virtual std::chrono::nanoseconds now() noexcept override;
+    virtual void sleep(const std::chrono::nanoseconds ns) noexcept override;
+    virtual void delay(const std::chrono::nanoseconds ns) noexcept override;
+    virtual void idleUntil(const std::chrono::nanoseconds t) noexcept override;
+
+    /**
+     * Current time without advancing by tick
+     */
+    std::chrono::nanoseconds peek() const noexcept;
+
+    void advance(const std::chrono::nanoseconds ns) noexcept;
+
+    std::chrono::nanoseconds getTick() const noexcept;
+    void setTick(const std::chrono::nanoseconds tick) noexcept;
+
+};
+};
+#endif
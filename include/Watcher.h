@@ -63,7 +63,12 @@ protected:
     std::chrono::nanoseconds _notReadySleep;
     std::chrono::nanoseconds _pollSleep;
 
+    //time of the last read since watching began; guarded by _pinWatchLock
+    std::chrono::nanoseconds _lastRead;
+
     static void* _watchPin(void* const watcherPtr);
+    static std::chrono::nanoseconds _conversionPeriod(const Rate r) noexcept;
+    void _countRead() noexcept;
     void _changeWatchState(const WatchState state);
     void _recoverHX711(const std::chrono::nanoseconds maxWait);
 
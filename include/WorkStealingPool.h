@@ -0,0 +1,104 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_WORKSTEALINGPOOL_H_E4469F78_A13E_46F4_969E_AFF7A6CDE12B
+#define HX711_WORKSTEALINGPOOL_H_E4469F78_A13E_46F4_969E_AFF7A6CDE12B
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HX711 {
+
+/**
+ * A fixed set of threads which run numbered tasks.
+ * 
+ * run deals the task numbers out to the threads' own queues in
+ * contiguous runs. Each thread works through its queue from the front
+ * and, once it is empty, steals from the back of another's, so uneven
+ * tasks still keep every thread busy until the end.
+ * 
+ * Tasks are given only their number; any results should be written to
+ * a slot indexed by it, so they can be combined in a fixed order no
+ * matter which thread ran which task.
+ */
+class WorkStealingPool {
+
+public:
+    typedef std::function<void(const std::size_t)> Task;
+
+
+protected:
+
+    struct _Queue {
+        std::mutex mtx;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<_Queue>> _queues;
+    std::vector<std::thread> _threads;
+
+    std::mutex _mtx;
+    std::condition_variable _start;
+    std::condition_variable _done;
+
+    //guarded by _mtx
+    const Task* _task;
+    std::size_t _generation;
+    std::size_t _busy;
+    bool _stopping;
+    std::exception_ptr _error;
+
+    void _worker(const std::size_t id) noexcept;
+    bool _next(const std::size_t id, std::size_t* const task) noexcept;
+
+
+public:
+
+    /**
+     * threads of 0 uses one per core
+     */
+    explicit WorkStealingPool(const std::size_t threads = 0);
+
+    WorkStealingPool(const WorkStealingPool& that) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool& that) = delete;
+
+    ~WorkStealingPool();
+
+    /**
+     * Runs task(0) to task(count - 1) and returns when all have
+     * finished. If any throw, the rest still run and the first
+     * exception is rethrown. Only one run may be in progress at a time.
+     */
+    void run(const std::size_t count, const Task& task);
+
+    std::size_t size() const noexcept;
+
+};
+};
+#endif
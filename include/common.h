@@ -22,13 +22,48 @@
 
 #include "AbstractScale.h"
 #include "AdvancedHX711.h"
+#include "BitTiming.h"
+#include "Clock.h"
+#include "CompressedLog.h"
+#include "CompressedRecorder.h"
+#include "DaemonProtocol.h"
+#include "FlightLog.h"
+#include "FlightRecorder.h"
+#include "GpioDriver.h"
 #include "GpioException.h"
 #include "HX711.h"
 #include "IntegrityException.h"
+#include "LatencyHistogram.h"
+#include "LgpioDriver.h"
+#include "LogAnalyzer.h"
+#include "Metrics.h"
+#include "MetricsExporter.h"
 #include "Mass.h"
+#include "MassFormatter.h"
+#include "PackedValueBuffer.h"
+#include "PerfCounters.h"
+#include "QuantileSink.h"
+#include "QuantileSketch.h"
+#include "RemoteScale.h"
+#include "ReplayChip.h"
+#include "RollupAggregator.h"
+#include "SampleExporter.h"
+#include "SampleLog.h"
+#include "SampleRecorder.h"
+#include "SampleSink.h"
+#include "SharedRing.h"
+#include "SharedRingPublisher.h"
+#include "Quantity.h"
 #include "SimpleHX711.h"
+#include "SimulatedChip.h"
+#include "SystemClock.h"
 #include "TimeoutException.h"
+#include "Trace.h"
+#include "TriggeredCapture.h"
 #include "Utility.h"
 #include "Value.h"
 #include "ValueStack.h"
+#include "VirtualChip.h"
+#include "VirtualClock.h"
 #include "Watcher.h"
+#include "WorkStealingPool.h"
@@ -20,13 +20,18 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <stdexcept>
 #include <vector>
 #include "../include/AbstractScale.h"
+#include "../include/LatencyHistogram.h"
 #include "../include/Mass.h"
+#include "../include/Metrics.h"
+#include "../include/PerfCounters.h"
+#include "../include/Trace.h"
 #include "../include/Utility.h"
 #include "../include/Value.h"
 
@@ -53,7 +58,8 @@ AbstractScale::AbstractScale(
     const Value offset) noexcept : 
         _massUnit(massUnit),
         _refUnit(refUnit),
-        _offset(offset) {
+        _offset(offset),
+        _weightMetrics(nullptr) {
 }
 
 void AbstractScale::setUnit(const Mass::Unit unit) noexcept {
@@ -90,7 +96,7 @@ double AbstractScale::normalise(const double v) const noexcept {
     return (v - this->_offset) / this->_refUnit;
 }
 
-double AbstractScale::read(const Options o) {
+double AbstractScale::_read(const Options o) {
 
     std::vector<Value> vals;
 
@@ -110,16 +116,29 @@ double AbstractScale::read(const Options o) {
     }
 
     switch(o.readType) {
-        case ReadType::Median:
+        case ReadType::Median: {
+            PerfScope perf(PerfOp::MEDIAN);
             return Utility::median(&vals);
-        case ReadType::Average:
+        }
+        case ReadType::Average: {
+            PerfScope perf(PerfOp::AVERAGE);
             return Utility::average(&vals);
+        }
         default:
             throw std::invalid_argument("unknown read type");
     }
 
 }
 
+double AbstractScale::read(const Options o) {
+    TraceScope trace("read");
+    PerfScope perf(PerfOp::SCALE_READ);
+    const auto start = Utility::getnanos();
+    const double v = this->_read(o);
+    this->_readLatency.record(Utility::getnanos() - start);
+    return v;
+}
+
 void AbstractScale::zero(const Options o) {
 
     const auto refBackup = this->_refUnit;
@@ -140,7 +159,17 @@ void AbstractScale::zero(const Options o) {
 }
 
 Mass AbstractScale::weight(const Options o) {
-    return Mass(this->normalise(this->read(o)), this->_massUnit);
+
+    const Mass m(this->normalise(this->read(o)), this->_massUnit);
+
+    if(this->_weightMetrics != nullptr) {
+        this->_weightMetrics->weight.store(
+            m.getValue(Mass::Unit::G),
+            std::memory_order_relaxed);
+    }
+
+    return m;
+
 }
 
 Mass AbstractScale::weight(const std::chrono::nanoseconds timeout) {
@@ -151,4 +180,8 @@ Mass AbstractScale::weight(const std::size_t samples) {
     return this->weight(Options(samples));
 }
 
+LatencyHistogram& AbstractScale::getReadLatency() noexcept {
+    return this->_readLatency;
+}
+
 };
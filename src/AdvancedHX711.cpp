@@ -22,12 +22,16 @@
 
 #include <chrono>
 #include <cstdint>
+#include <mutex>
 #include <stdexcept>
 #include <thread>
 #include <vector>
+#include "../include/GpioDriver.h"
 #include "../include/AdvancedHX711.h"
 #include "../include/HX711.h"
+#include "../include/LatencyHistogram.h"
 #include "../include/Mass.h"
+#include "../include/Trace.h"
 #include "../include/Utility.h"
 #include "../include/Value.h"
 #include "../include/Watcher.h"
@@ -39,9 +43,11 @@ AdvancedHX711::AdvancedHX711(
     const int clockPin,
     const Value refUnit,
     const Value offset,
-    const Rate rate) : 
+    const Rate rate,
+    GpioDriver* const gpio) : 
         AbstractScale(Mass::Unit::G, refUnit, offset),
-        HX711(dataPin, clockPin, rate) {
+        HX711(dataPin, clockPin, rate, gpio) {
+            this->_weightMetrics = &this->_metrics;
             this->_wx = new Watcher(this);
             this->_wx->begin();
             this->connect();
@@ -51,6 +57,26 @@ AdvancedHX711::~AdvancedHX711() {
     delete this->_wx;
 }
 
+void AdvancedHX711::_takeValues(
+    std::vector<Value>* const vals,
+    const std::size_t max) {
+
+        TraceScope trace("drain");
+
+        Trace::begin("wait valuesLock");
+        std::lock_guard<std::mutex> lock(this->_wx->valuesLock);
+        Trace::end("wait valuesLock");
+
+        const auto now = Utility::getnanos();
+        std::chrono::nanoseconds when;
+
+        while(!this->_wx->values.empty() && vals->size() < max) {
+            vals->push_back(this->_wx->values.pop(&when));
+            this->_queueLatency.record(now - when);
+        }
+
+}
+
 std::vector<Value> AdvancedHX711::getValues(const std::chrono::nanoseconds timeout) {
 
     using namespace std::chrono;
@@ -59,22 +85,18 @@ std::vector<Value> AdvancedHX711::getValues(const std::chrono::nanoseconds timeo
     this->_wx->watch();
 
     std::vector<Value> vals;
-    const auto endTime = steady_clock::now() + timeout;
+    const auto endTime = Utility::getnanos() + timeout;
 
     while(true) {
 
-        if(steady_clock::now() >= endTime) {
+        if(Utility::getnanos() >= endTime) {
             this->_wx->pause();
             return vals;
         }
 
         if(!this->_wx->values.empty()) {
 
-            this->_wx->valuesLock.lock();
-            while(!this->_wx->values.empty()) {
-                vals.push_back(this->_wx->values.pop());
-            }
-            this->_wx->valuesLock.unlock();
+            this->_takeValues(&vals, SIZE_MAX);
 
             continue;
 
@@ -116,15 +138,9 @@ std::vector<Value> AdvancedHX711::getValues(const std::size_t samples) {
         }
 
         //not empty; data available!
-        this->_wx->valuesLock.lock();
-
         //now, take as many values as which are available
         //up to however many are left to fill the array
-        while(!this->_wx->values.empty() && vals.size() < samples) {
-            vals.push_back(this->_wx->values.pop());
-        }
-
-        this->_wx->valuesLock.unlock();
+        this->_takeValues(&vals, samples);
 
     }
 
@@ -134,4 +150,8 @@ std::vector<Value> AdvancedHX711::getValues(const std::size_t samples) {
 
 }
 
+LatencyHistogram& AdvancedHX711::getQueueLatency() noexcept {
+    return this->_queueLatency;
+}
+
 };
@@ -0,0 +1,241 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/common.h"
+
+using namespace HX711;
+
+/**
+ * Offline log analysis
+ * 
+ * Usage: hx711analyze FILE... [--samples n | --time ms] [--average]
+ *                     [--ref-unit r] [--offset o] [--threads n]
+ *                     [--csv output]
+ * 
+ * Re-processes sample logs (see SampleLog.h) or compressed logs (see
+ * CompressedLog.h) into weights with LogAnalyzer, using every core.
+ * Readings are taken every --samples samples (default 3) or every
+ * --time milliseconds, through the median (or with --average, the
+ * mean), as AbstractScale::weight would. --ref-unit and --offset
+ * replace the calibration stored in each file.
+ * 
+ * A summary of each file is printed, including estimated percentiles
+ * (see QuantileSketch.h). --csv also writes every reading:
+ * the Unix time in nanoseconds of its first sample, and its weight.
+ */
+
+struct Calibration {
+    bool hasRefUnit = false;
+    bool hasOffset = false;
+    Value refUnit;
+    Value offset;
+};
+
+static bool isCompressed(const std::string& path) {
+
+    std::ifstream f(path, std::ios::binary);
+    char magic[CompressedLogHeader::MAGIC_SIZE];
+
+    return f.read(magic, sizeof(magic)) &&
+        std::memcmp(magic, CompressedLogHeader::MAGIC, sizeof(magic)) == 0;
+
+}
+
+template <typename Log>
+static void analyzeLog(
+    const std::string& path,
+    const Log& log,
+    const Options& o,
+    const Calibration& cal,
+    const std::size_t threads,
+    std::ostream* const csv) {
+
+        const auto& h = log.header();
+        const Value refUnit = cal.hasRefUnit ? cal.refUnit : Value(h.refUnit);
+        const Value offset = cal.hasOffset ? cal.offset : Value(h.offset);
+
+        LogAnalyzer analyzer(
+            o,
+            static_cast<Mass::Unit>(h.unit),
+            refUnit == 0 ? Value(1) : refUnit,
+            offset,
+            threads);
+
+        std::vector<AnalysisReading> readings;
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto s = analyzer.analyze(log, csv != nullptr ? &readings : nullptr);
+        const auto secs = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        const auto unit = Mass::getUnitName(static_cast<Mass::Unit>(h.unit));
+
+        std::printf("%s\n", path.c_str());
+        std::printf("  samples:  %llu\n", static_cast<unsigned long long>(s.samples));
+        std::printf("  readings: %llu\n", static_cast<unsigned long long>(s.readings));
+
+        if(s.readings > 0) {
+
+            const double qs[] = { 0.01, 0.5, 0.99 };
+            double q[3];
+            s.quantiles.quantiles(qs, 3, q);
+
+            std::printf("  min:      %.3f %s\n", s.min, unit);
+            std::printf("  p1:       %.3f %s\n", q[0], unit);
+            std::printf("  median:   %.3f %s\n", q[1], unit);
+            std::printf("  mean:     %.3f %s\n", s.mean(), unit);
+            std::printf("  p99:      %.3f %s\n", q[2], unit);
+            std::printf("  max:      %.3f %s\n", s.max, unit);
+
+        }
+
+        std::printf("  time:     %.3f s (%.1f M samples/s, %zu threads)\n",
+            secs,
+            secs > 0 ? static_cast<double>(s.samples) / secs / 1e6 : 0,
+            analyzer.getThreads());
+
+        if(csv == nullptr) {
+            return;
+        }
+
+        char buff[64];
+
+        for(const auto& r : readings) {
+            std::snprintf(buff, sizeof(buff), "%lld,%.3f\n",
+                static_cast<long long>(log.toRealtime(r.when).count()),
+                r.weight);
+            *csv << buff;
+        }
+
+}
+
+int main(int argc, char** argv) {
+
+    using namespace std;
+
+    const char* const err = "Usage: hx711analyze FILE... [--samples n | --time ms] "
+        "[--average] [--ref-unit r] [--offset o] [--threads n] [--csv output]";
+
+    vector<string> paths;
+    Options o;
+    Calibration cal;
+    size_t threads = 0;
+    const char* csvPath = nullptr;
+
+    try {
+        for(int i = 1; i < argc; ++i) {
+
+            const bool hasValue = i + 1 < argc;
+
+            if(strcmp(argv[i], "--samples") == 0 && hasValue) {
+                o = Options(static_cast<size_t>(stoul(argv[++i])), o.readType);
+            }
+            else if(strcmp(argv[i], "--time") == 0 && hasValue) {
+                o = Options(
+                    chrono::duration_cast<chrono::nanoseconds>(
+                        chrono::milliseconds(stoll(argv[++i]))),
+                    o.readType);
+            }
+            else if(strcmp(argv[i], "--average") == 0) {
+                o.readType = ReadType::Average;
+            }
+            else if(strcmp(argv[i], "--ref-unit") == 0 && hasValue) {
+                cal.refUnit = stoi(argv[++i]);
+                cal.hasRefUnit = true;
+            }
+            else if(strcmp(argv[i], "--offset") == 0 && hasValue) {
+                cal.offset = stoi(argv[++i]);
+                cal.hasOffset = true;
+            }
+            else if(strcmp(argv[i], "--threads") == 0 && hasValue) {
+                threads = static_cast<size_t>(stoul(argv[++i]));
+            }
+            else if(strcmp(argv[i], "--csv") == 0 && hasValue) {
+                csvPath = argv[++i];
+            }
+            else if(argv[i][0] != '-') {
+                paths.push_back(argv[i]);
+            }
+            else {
+                cerr << err << endl;
+                return EXIT_FAILURE;
+            }
+
+        }
+    }
+    catch(const exception& ex) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    if(paths.empty()) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    unique_ptr<ofstream> csv;
+
+    if(csvPath != nullptr) {
+        csv.reset(new ofstream(csvPath, ios::trunc));
+        if(!*csv) {
+            cerr << "cannot open " << csvPath << endl;
+            return EXIT_FAILURE;
+        }
+        *csv << "unix_ns,weight" << endl;
+    }
+
+    try {
+        for(const auto& path : paths) {
+            if(isCompressed(path)) {
+                const CompressedLog log(path);
+                analyzeLog(path, log, o, cal, threads, csv.get());
+            }
+            else {
+                const SampleLog log(path);
+                analyzeLog(path, log, o, cal, threads, csv.get());
+            }
+        }
+    }
+    catch(const exception& ex) {
+        cerr << ex.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    if(csv && !*csv) {
+        cerr << "unable to write " << csvPath << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,676 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+#include "../include/common.h"
+
+using namespace HX711;
+
+/**
+ * On-hardware benchmark
+ * 
+ * Usage: hx711bench [DATA PIN] [CLOCK PIN] [--seconds n] [--rate 10|80]
+ *                   [--json file] [--simulate] [--perf]
+ * 
+ * Runs SimpleHX711 with each combination of delays and strict timing,
+ * and AdvancedHX711 with and without strict timing, against the chip
+ * on the given pins. For each run it reports:
+ * 
+ * - the achieved conversion rate
+ * - integrity failures (IntegrityException with strict timing), and
+ *   reads where any bit's clock-high time reached the 60us power down
+ *   threshold (whether or not it was detected)
+ * - edge-to-read latency: from the last poll which saw DOUT high to the
+ *   first clock pulse of the read which followed (an upper bound)
+ * - the distribution of per-bit clock-high durations
+ * - process CPU usage as a percentage of one core
+ * 
+ * --simulate runs against a SimulatedChip instead of real pins. --perf
+ * adds the cycles, instructions, context switches, and page faults per
+ * readValue call, for whichever counters the system allows.
+ */
+
+static const std::chrono::microseconds POWER_DOWN(60);
+
+/**
+ * GpioDriver which passes everything through to another driver and
+ * times clock pulses and DOUT polls along the way. AdvancedHX711's
+ * watcher thread calls it while the benchmark thread starts and stops
+ * timing. Only the rise time is taken while the clock is high; the
+ * pulse is recorded once it is low again, so the clock-high time being
+ * measured is not stretched. The results are only read once stop has
+ * returned, and stop waits for any recording under way to finish.
+ */
+class TimingGpio : public GpioDriver {
+
+protected:
+    GpioDriver* const _inner;
+    std::atomic<bool> _enabled;
+    std::atomic<unsigned int> _inside;
+    int _dataPin;
+    int _clockPin;
+    unsigned char _pulsesPerRead;
+
+    //only used by the thread reading the chip
+    std::int64_t _riseAt;
+
+    //reset by start, otherwise only used between _enter and _leave
+    unsigned char _pulses;
+    bool _sawLow;
+    std::int64_t _lastHighPoll;
+    std::int64_t _readMaxHigh;
+
+    static std::int64_t _now() noexcept {
+        return Utility::getnanos().count();
+    }
+
+    template <typename T>
+    static void _record(std::vector<T>& v, const T x) noexcept {
+        //preallocated; never grow while timing
+        if(v.size() < v.capacity()) {
+            v.push_back(x);
+        }
+    }
+
+    /**
+     * Returns true, and must then be followed by _leave, if timing is
+     * enabled. Sequentially consistent, so either stop sees _inside
+     * raised and waits, or this sees _enabled cleared.
+     */
+    bool _enter() noexcept {
+
+        this->_inside.fetch_add(1);
+
+        if(this->_enabled.load()) {
+            return true;
+        }
+
+        this->_leave();
+        return false;
+
+    }
+
+    void _leave() noexcept {
+        this->_inside.fetch_sub(1, std::memory_order_release);
+    }
+
+    void _reset() noexcept {
+        this->_pulses = 0;
+        this->_sawLow = false;
+        this->_lastHighPoll = 0;
+        this->_readMaxHigh = 0;
+        this->highs.clear();
+        this->latencies.clear();
+        this->reads = 0;
+        this->powerDownReads = 0;
+    }
+
+public:
+    std::vector<std::int64_t> highs;
+    std::vector<std::int64_t> latencies;
+    std::size_t reads;
+    std::size_t powerDownReads;
+
+    TimingGpio(GpioDriver* const inner, const std::size_t capacity) :
+        _inner(inner),
+        _enabled(false),
+        _inside(0),
+        _dataPin(-1),
+        _clockPin(-1),
+        _pulsesPerRead(25),
+        _riseAt(0) {
+            this->highs.reserve(capacity * 27);
+            this->latencies.reserve(capacity);
+            this->_reset();
+    }
+
+    //clears the results and starts timing; timing must be stopped
+    void start() {
+        this->_reset();
+        this->_enabled.store(true);
+    }
+
+    void stop() {
+
+        this->_enabled.store(false);
+
+        while(this->_inside.load() != 0) {
+            std::this_thread::yield();
+        }
+
+    }
+
+    virtual int openHandle(const int chip) override {
+        return this->_inner->openHandle(chip);
+    }
+
+    virtual void closeHandle(const int handle) override {
+        this->_inner->closeHandle(handle);
+    }
+
+    virtual void openInput(const int handle, const int pin) override {
+        this->_dataPin = pin;
+        this->_inner->openInput(handle, pin);
+    }
+
+    virtual void openOutput(const int handle, const int pin) override {
+        this->_clockPin = pin;
+        this->_inner->openOutput(handle, pin);
+    }
+
+    virtual void closePin(const int handle, const int pin) override {
+        this->_inner->closePin(handle, pin);
+    }
+
+    virtual GpioLevel read(const int handle, const int pin) override {
+
+        const auto lev = this->_inner->read(handle, pin);
+
+        if(pin != this->_dataPin) {
+            return lev;
+        }
+
+        const auto t = _now();
+
+        if(!this->_enter()) {
+            return lev;
+        }
+
+        //polls between reads, not bits within one
+        if(this->_pulses == 0) {
+            if(lev == GpioLevel::HIGH) {
+                this->_lastHighPoll = t;
+                this->_sawLow = false;
+            }
+            else {
+                this->_sawLow = true;
+            }
+        }
+
+        this->_leave();
+
+        return lev;
+
+    }
+
+    virtual void write(const int handle, const int pin, const GpioLevel lev) override {
+
+        this->_inner->write(handle, pin, lev);
+
+        if(pin != this->_clockPin) {
+            return;
+        }
+
+        const auto t = _now();
+
+        //nothing more until the clock is low again
+        if(lev == GpioLevel::HIGH) {
+            this->_riseAt = t;
+            return;
+        }
+
+        if(!this->_enter()) {
+            return;
+        }
+
+        if(this->_pulses == 0) {
+            if(this->_sawLow && this->_lastHighPoll != 0) {
+                _record(this->latencies, this->_riseAt - this->_lastHighPoll);
+            }
+            this->_sawLow = false;
+            this->_readMaxHigh = 0;
+        }
+
+        const auto high = t - this->_riseAt;
+        _record(this->highs, high);
+        this->_readMaxHigh = std::max(this->_readMaxHigh, high);
+
+        if(++this->_pulses == this->_pulsesPerRead) {
+            ++this->reads;
+            if(this->_readMaxHigh >= std::chrono::nanoseconds(POWER_DOWN).count()) {
+                ++this->powerDownReads;
+            }
+            this->_pulses = 0;
+        }
+
+        this->_leave();
+
+    }
+
+};
+
+struct RunResult {
+    std::string scale;
+    bool delays;
+    bool strict;
+    double seconds;
+    std::size_t values;
+    std::size_t failures;
+    std::size_t powerDownReads;
+    double rate;
+    double latencyP50;
+    double latencyP99;
+    double highP50;
+    double highP99;
+    double highMax;
+    double cpu;
+    PerfProfiler::Stats readPerf;
+};
+
+static std::chrono::nanoseconds cpuTime() {
+    timespec ts;
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return Utility::timespec_to_nanos(&ts);
+}
+
+//in microseconds
+static double percentile(std::vector<std::int64_t>& v, const double p) {
+
+    if(v.empty()) {
+        return 0;
+    }
+
+    std::sort(v.begin(), v.end());
+    const auto i = static_cast<std::size_t>(p * (v.size() - 1) + 0.5);
+    return v[i] / 1000.0;
+
+}
+
+static RunResult finish(
+    const char* const scale,
+    const bool delays,
+    const bool strict,
+    const std::chrono::nanoseconds wall,
+    const std::chrono::nanoseconds cpu,
+    const std::size_t values,
+    const std::size_t failures,
+    TimingGpio& gpio) {
+
+        RunResult r;
+        r.scale = scale;
+        r.delays = delays;
+        r.strict = strict;
+        r.seconds = wall.count() / 1e9;
+        r.values = values;
+        r.failures = failures;
+        r.powerDownReads = gpio.powerDownReads;
+        r.rate = values / r.seconds;
+        r.latencyP50 = percentile(gpio.latencies, 0.5);
+        r.latencyP99 = percentile(gpio.latencies, 0.99);
+        r.highP50 = percentile(gpio.highs, 0.5);
+        r.highP99 = percentile(gpio.highs, 0.99);
+        r.highMax = gpio.highs.empty() ? 0 : gpio.highs.back() / 1000.0;
+        r.cpu = 100.0 * cpu.count() / wall.count();
+        r.readPerf = PerfProfiler::getStats(PerfOp::READ_VALUE);
+
+        return r;
+
+}
+
+static RunResult runSimple(
+    SimpleHX711& hx,
+    TimingGpio& gpio,
+    const bool delays,
+    const bool strict,
+    const std::chrono::seconds duration) {
+
+        hx.useDelays(delays);
+        hx.setStrictTiming(strict);
+
+        std::size_t values = 0;
+        std::size_t failures = 0;
+
+        gpio.start();
+        PerfProfiler::reset();
+
+        const auto cpuStart = cpuTime();
+        const auto start = Utility::getnanos();
+        const auto end = start + duration;
+
+        //as SimpleHX711::getValues does, but counting failures
+        while(Utility::getnanos() < end) {
+
+            if(!hx.isReady()) {
+                continue;
+            }
+
+            try {
+                hx.readValue();
+                ++values;
+            }
+            catch(const IntegrityException& ex) {
+                ++failures;
+            }
+
+        }
+
+        const auto wall = Utility::getnanos() - start;
+        const auto cpu = cpuTime() - cpuStart;
+        gpio.stop();
+
+        return finish("simple", delays, strict, wall, cpu, values, failures, gpio);
+
+}
+
+static RunResult runAdvanced(
+    AdvancedHX711& hx,
+    TimingGpio& gpio,
+    const bool strict,
+    const std::chrono::seconds duration) {
+
+        hx.setStrictTiming(strict);
+
+        gpio.start();
+        PerfProfiler::reset();
+
+        //the watcher retries failed reads itself, so they are counted
+        //from the scale's metrics
+        const auto& failures = hx.getMetrics().integrityFailures;
+        const auto failuresStart = failures.load(std::memory_order_relaxed);
+
+        const auto cpuStart = cpuTime();
+        const auto start = Utility::getnanos();
+
+        const auto vals = hx.getValues(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
+
+        const auto wall = Utility::getnanos() - start;
+        const auto cpu = cpuTime() - cpuStart;
+        gpio.stop();
+
+        return finish(
+            "advanced",
+            false,
+            strict,
+            wall,
+            cpu,
+            vals.size(),
+            static_cast<std::size_t>(failures.load(std::memory_order_relaxed) - failuresStart),
+            gpio);
+
+}
+
+static void printTable(const std::vector<RunResult>& results) {
+
+    using namespace std;
+
+    cout    << left << setw(10) << "scale"
+            << setw(8) << "delays"
+            << setw(8) << "strict"
+            << right << setw(9) << "rate Hz"
+            << setw(8) << "fails"
+            << setw(8) << ">=60us"
+            << setw(12) << "lat p50 us"
+            << setw(12) << "lat p99 us"
+            << setw(12) << "high p50 us"
+            << setw(12) << "high p99 us"
+            << setw(12) << "high max us"
+            << setw(8) << "cpu %"
+            << endl;
+
+    cout << fixed << setprecision(1);
+
+    for(const auto& r : results) {
+        cout    << left << setw(10) << r.scale
+                << setw(8) << (r.delays ? "on" : "off")
+                << setw(8) << (r.strict ? "on" : "off")
+                << right << setw(9) << r.rate
+                << setw(8) << r.failures
+                << setw(8) << r.powerDownReads
+                << setw(12) << r.latencyP50
+                << setw(12) << r.latencyP99
+                << setw(12) << r.highP50
+                << setw(12) << r.highP99
+                << setw(12) << r.highMax
+                << setw(8) << r.cpu
+                << endl;
+    }
+
+}
+
+static void printPerfTable(const std::vector<RunResult>& results) {
+
+    using namespace std;
+
+    cout    << endl << "per readValue:" << endl
+            << left << setw(10) << "scale"
+            << setw(8) << "delays"
+            << setw(8) << "strict";
+
+    for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+        cout << right << setw(18) << PerfCounters::getName(static_cast<PerfCounter>(c));
+    }
+
+    cout << endl << fixed << setprecision(1);
+
+    for(const auto& r : results) {
+
+        cout    << left << setw(10) << r.scale
+                << setw(8) << (r.delays ? "on" : "off")
+                << setw(8) << (r.strict ? "on" : "off")
+                << right;
+
+        for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+            if(r.readPerf.available[c] && r.readPerf.calls > 0) {
+                cout << setw(18) << static_cast<double>(r.readPerf.values[c]) / r.readPerf.calls;
+            }
+            else {
+                cout << setw(18) << "n/a";
+            }
+        }
+
+        cout << endl;
+
+    }
+
+}
+
+static void writeJson(
+    std::ostream& os,
+    const std::vector<RunResult>& results,
+    const int dataPin,
+    const int clockPin,
+    const bool simulated) {
+
+        os  << "{\n"
+            << "  \"version\": \"" << Utility::getVersion() << "\",\n"
+            << "  \"dataPin\": " << dataPin << ",\n"
+            << "  \"clockPin\": " << clockPin << ",\n"
+            << "  \"simulated\": " << (simulated ? "true" : "false") << ",\n"
+            << "  \"runs\": [\n";
+
+        os << std::fixed << std::setprecision(3);
+
+        for(std::size_t i = 0; i < results.size(); ++i) {
+            const RunResult& r = results[i];
+            os  << "    {\"scale\": \"" << r.scale << "\""
+                << ", \"delays\": " << (r.delays ? "true" : "false")
+                << ", \"strict\": " << (r.strict ? "true" : "false")
+                << ", \"seconds\": " << r.seconds
+                << ", \"values\": " << r.values
+                << ", \"rate_hz\": " << r.rate
+                << ", \"integrity_failures\": " << r.failures
+                << ", \"power_down_reads\": " << r.powerDownReads
+                << ", \"latency_p50_us\": " << r.latencyP50
+                << ", \"latency_p99_us\": " << r.latencyP99
+                << ", \"bit_high_p50_us\": " << r.highP50
+                << ", \"bit_high_p99_us\": " << r.highP99
+                << ", \"bit_high_max_us\": " << r.highMax
+                << ", \"cpu_pct\": " << r.cpu;
+
+            for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+                if(r.readPerf.available[c] && r.readPerf.calls > 0) {
+                    os  << ", \"" << PerfCounters::getName(static_cast<PerfCounter>(c))
+                        << "_per_read\": "
+                        << static_cast<double>(r.readPerf.values[c]) / r.readPerf.calls;
+                }
+            }
+
+            os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+
+        os << "  ]\n}\n";
+
+}
+
+int main(int argc, char** argv) {
+
+    using namespace std;
+    using namespace std::chrono;
+
+    const char* const err = "Usage: hx711bench [DATA PIN] [CLOCK PIN] "
+        "[--seconds n] [--rate 10|80] [--json file] [--simulate] [--perf]";
+
+    int dataPin = -1;
+    int clockPin = -1;
+    seconds duration(5);
+    Rate rate = Rate::HZ_10;
+    const char* json = nullptr;
+    bool simulate = false;
+    int positional = 0;
+
+    try {
+        for(int i = 1; i < argc; ++i) {
+
+            const bool hasValue = i + 1 < argc;
+
+            if(strcmp(argv[i], "--seconds") == 0 && hasValue) {
+                duration = seconds(stoul(argv[++i]));
+            }
+            else if(strcmp(argv[i], "--rate") == 0 && hasValue) {
+                rate = stoi(argv[++i]) == 80 ? Rate::HZ_80 : Rate::HZ_10;
+            }
+            else if(strcmp(argv[i], "--json") == 0 && hasValue) {
+                json = argv[++i];
+            }
+            else if(strcmp(argv[i], "--simulate") == 0) {
+                simulate = true;
+            }
+            else if(strcmp(argv[i], "--perf") == 0) {
+                PerfProfiler::enable();
+            }
+            else if(positional == 0) {
+                dataPin = stoi(argv[i]);
+                ++positional;
+            }
+            else if(positional == 1) {
+                clockPin = stoi(argv[i]);
+                ++positional;
+            }
+            else {
+                throw invalid_argument(argv[i]);
+            }
+
+        }
+    }
+    catch(const exception& ex) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    if(positional != 2 || duration.count() == 0) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    //best effort; as with AdvancedHX711's watcher, needs root
+    struct sched_param schParams = {
+        sched_get_priority_max(SCHED_FIFO)
+    };
+
+    ::pthread_setschedparam(
+        pthread_self(),
+        SCHED_FIFO,
+        &schParams);
+
+    unique_ptr<GpioDriver> sim;
+
+    if(simulate) {
+        sim.reset(new SimulatedChip(rate == Rate::HZ_80 ? Rate::HZ_80 : Rate::HZ_10));
+    }
+
+    GpioDriver* const inner = sim ? sim.get() : LgpioDriver::getInstance();
+    TimingGpio gpio(inner, 80 * static_cast<std::size_t>(duration.count()) * 2);
+    vector<RunResult> results;
+
+    try {
+
+        {
+            SimpleHX711 hx(dataPin, clockPin, 1, 0, rate, &gpio);
+            for(const bool strict : { false, true }) {
+                for(const bool delays : { false, true }) {
+                    results.push_back(runSimple(hx, gpio, delays, strict, duration));
+                }
+            }
+        }
+
+        {
+            AdvancedHX711 hx(dataPin, clockPin, 1, 0, rate, &gpio);
+            for(const bool strict : { false, true }) {
+                results.push_back(runAdvanced(hx, gpio, strict, duration));
+            }
+        }
+
+    }
+    catch(const GpioException& ex) {
+        cerr << "Failed to connect to HX711 chip: " << ex.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    printTable(results);
+
+    if(PerfProfiler::isEnabled()) {
+        printPerfTable(results);
+    }
+
+    if(json != nullptr) {
+
+        ofstream file(json);
+
+        if(!file) {
+            cerr << "cannot open " << json << endl;
+            return EXIT_FAILURE;
+        }
+
+        writeJson(file, results, dataPin, clockPin, simulate);
+
+    }
+
+    return EXIT_SUCCESS;
+
+}
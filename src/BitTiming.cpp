@@ -0,0 +1,198 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "../include/BitTiming.h"
+
+namespace HX711 {
+
+constexpr std::chrono::microseconds BitTiming::POWER_DOWN_TIME;
+
+std::uint32_t BitTiming::_toUint(const std::chrono::nanoseconds d) noexcept {
+
+    if(d.count() <= 0) {
+        return 0;
+    }
+
+    if(d.count() > std::numeric_limits<std::uint32_t>::max()) {
+        return std::numeric_limits<std::uint32_t>::max();
+    }
+
+    return static_cast<std::uint32_t>(d.count());
+
+}
+
+BitTiming::BitTiming(const std::size_t reads) :
+    _next(0),
+    _count(0),
+    _lastFall(0) {
+
+        if(reads == 0) {
+            throw std::invalid_argument("reads must be at least 1");
+        }
+
+        this->_reads.resize(reads);
+        this->_current = Read();
+
+}
+
+void BitTiming::beginRead() noexcept {
+    this->_current.pulses = 0;
+    this->_current.failed = false;
+}
+
+void BitTiming::recordPulse(
+    const std::chrono::nanoseconds rise,
+    const std::chrono::nanoseconds fall) noexcept {
+
+        Read& r = this->_current;
+
+        if(r.pulses >= MAX_PULSES) {
+            return;
+        }
+
+        if(r.pulses == 0) {
+            r.when = rise;
+            r.low[0] = 0;
+        }
+        else {
+            r.low[r.pulses] = _toUint(rise - this->_lastFall);
+        }
+
+        r.high[r.pulses] = _toUint(fall - rise);
+        ++r.pulses;
+
+        this->_lastFall = fall;
+
+}
+
+void BitTiming::endRead(const bool failed) noexcept {
+
+    //nothing was clocked out (eg. a GPIO error before the first pulse)
+    if(this->_current.pulses == 0) {
+        return;
+    }
+
+    this->_current.failed = failed;
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+
+    this->_reads[this->_next] = this->_current;
+    this->_next = (this->_next + 1) % this->_reads.size();
+    this->_count = std::min(this->_count + 1, this->_reads.size());
+
+}
+
+std::size_t BitTiming::getCapacity() const noexcept {
+    return this->_reads.size();
+}
+
+void BitTiming::clear() noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_next = 0;
+    this->_count = 0;
+}
+
+std::vector<BitTiming::Read> BitTiming::getReads() const {
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+
+    std::vector<Read> reads;
+    reads.reserve(this->_count);
+
+    const std::size_t cap = this->_reads.size();
+    const std::size_t first = (this->_next + cap - this->_count) % cap;
+
+    for(std::size_t i = 0; i < this->_count; ++i) {
+        reads.push_back(this->_reads[(first + i) % cap]);
+    }
+
+    return reads;
+
+}
+
+BitTiming::Summary BitTiming::summarise() const {
+
+    using namespace std::chrono;
+
+    const auto reads = this->getReads();
+    const std::uint32_t limit = static_cast<std::uint32_t>(
+        duration_cast<nanoseconds>(POWER_DOWN_TIME).count());
+
+    Summary s;
+    s.reads = reads.size();
+    s.failedReads = 0;
+    s.overLimit = 0;
+    s.lowMax = nanoseconds(0);
+
+    std::vector<std::uint32_t> highs;
+    highs.reserve(reads.size() * MAX_PULSES);
+
+    for(const auto& r : reads) {
+
+        if(r.failed) {
+            ++s.failedReads;
+        }
+
+        for(unsigned char i = 0; i < r.pulses; ++i) {
+            highs.push_back(r.high[i]);
+            if(r.high[i] >= limit) {
+                ++s.overLimit;
+            }
+            s.lowMax = std::max(s.lowMax, nanoseconds(r.low[i]));
+        }
+
+    }
+
+    s.pulses = highs.size();
+
+    if(highs.empty()) {
+        s.highP50 = s.highP99 = s.highP999 = s.highMax = nanoseconds(0);
+        s.margin = POWER_DOWN_TIME;
+        return s;
+    }
+
+    std::sort(highs.begin(), highs.end());
+
+    const auto at = [&highs](const double p) {
+        return nanoseconds(highs[static_cast<std::size_t>(
+            p * (highs.size() - 1) + 0.5)]);
+    };
+
+    s.highP50 = at(0.5);
+    s.highP99 = at(0.99);
+    s.highP999 = at(0.999);
+    s.highMax = nanoseconds(highs.back());
+    s.margin = POWER_DOWN_TIME - s.highMax;
+
+    return s;
+
+}
+
+};
@@ -0,0 +1,908 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "../include/CompressedLog.h"
+#include "../include/SampleLog.h"
+#include "../include/Utility.h"
+
+namespace HX711 {
+
+constexpr const char* const CompressedLogHeader::MAGIC;
+constexpr const char* const CompressedLogTrailer::MAGIC;
+
+static inline std::uint64_t zigzag(const std::int64_t v) noexcept {
+    return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+static inline std::int64_t unzigzag(const std::uint64_t v) noexcept {
+    return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+static inline std::uint8_t bitsFor(const std::uint64_t v) noexcept {
+    return v == 0 ? 0 : static_cast<std::uint8_t>(64 - __builtin_clzll(v));
+}
+
+static CompressedIndexEntry indexEntry(
+    const CompressedBlockHeader& h,
+    const std::uint64_t offset,
+    const std::uint32_t timeUnit) noexcept {
+
+        CompressedIndexEntry e;
+        std::memset(&e, 0, sizeof(e));
+        e.offset = offset;
+        e.firstWhen = h.firstWhen * timeUnit;
+        e.lastWhen = h.lastWhen * timeUnit;
+        e.sum = h.sum;
+        e.count = h.count;
+        e.min = h.min;
+        e.max = h.max;
+
+        return e;
+
+}
+
+/**
+ * Appends values of a fixed width to a zeroed buffer, 64 bits at a time
+ */
+class BitWriter {
+
+protected:
+    std::uint8_t* _p;
+    std::uint64_t _acc;
+    unsigned _fill;
+
+public:
+    explicit BitWriter(std::uint8_t* const p) noexcept : _p(p), _acc(0), _fill(0) { }
+
+    inline void put(const std::uint64_t v, const unsigned bits) noexcept {
+
+        if(bits == 0) {
+            return;
+        }
+
+        this->_acc |= v << this->_fill;
+
+        if(this->_fill + bits < 64) {
+            this->_fill += bits;
+            return;
+        }
+
+        std::memcpy(this->_p, &this->_acc, sizeof(this->_acc));
+        this->_p += sizeof(this->_acc);
+
+        //whatever of v did not fit
+        this->_acc = this->_fill == 0 ? 0 : v >> (64 - this->_fill);
+        this->_fill = this->_fill + bits - 64;
+
+    }
+
+    inline void finish() noexcept {
+        if(this->_fill > 0) {
+            std::memcpy(this->_p, &this->_acc, sizeof(this->_acc));
+        }
+    }
+
+};
+
+/**
+ * Reads a value of the given width at any bit position. Relies on the
+ * payload's padding to read whole words past the last value.
+ */
+static inline std::uint64_t getBits(
+    const std::uint8_t* const p,
+    const std::uint64_t pos,
+    const unsigned bits) noexcept {
+
+        const auto byte = pos >> 3;
+        const auto shift = static_cast<unsigned>(pos & 7);
+
+        std::uint64_t w;
+        std::memcpy(&w, p + byte, sizeof(w));
+        w >>= shift;
+
+        if(shift + bits > 64) {
+            w |= static_cast<std::uint64_t>(p[byte + 8]) << (64 - shift);
+        }
+
+        return bits == 64 ? w : w & ((static_cast<std::uint64_t>(1) << bits) - 1);
+
+}
+
+SampleSummary::SampleSummary() noexcept :
+    count(0),
+    sum(0),
+    min(std::numeric_limits<std::int32_t>::max()),
+    max(std::numeric_limits<std::int32_t>::min()) {
+}
+
+void SampleSummary::add(const SampleRecord& r) noexcept {
+    ++this->count;
+    this->sum += r.value;
+    this->min = std::min(this->min, r.value);
+    this->max = std::max(this->max, r.value);
+}
+
+void SampleSummary::merge(const SampleSummary& s) noexcept {
+    this->count += s.count;
+    this->sum += s.sum;
+    this->min = std::min(this->min, s.min);
+    this->max = std::max(this->max, s.max);
+}
+
+void SampleSummary::merge(const CompressedIndexEntry& e) noexcept {
+    this->count += e.count;
+    this->sum += e.sum;
+    this->min = std::min(this->min, e.min);
+    this->max = std::max(this->max, e.max);
+}
+
+double SampleSummary::mean() const noexcept {
+    return this->count == 0
+        ? 0
+        : static_cast<double>(this->sum) / static_cast<double>(this->count);
+}
+
+void CompressedBlock::encode(
+    const SampleRecord* const recs,
+    const std::size_t count,
+    const std::uint32_t timeUnit,
+    std::vector<std::uint8_t>* const out) {
+
+        if(count == 0 || count > UINT32_MAX) {
+            throw std::invalid_argument("block must have between 1 and 2^32-1 records");
+        }
+
+        CompressedBlockHeader h;
+        std::memset(&h, 0, sizeof(h));
+        h.marker = CompressedBlockHeader::MARKER;
+        h.count = static_cast<std::uint32_t>(count);
+        h.firstWhen = recs[0].when / timeUnit;
+        h.firstValue = recs[0].value;
+        h.firstDelta = count > 1 ? recs[1].when / timeUnit - h.firstWhen : 0;
+        h.lastWhen = recs[count - 1].when / timeUnit;
+
+        SampleSummary s;
+
+        for(std::size_t i = 0; i < count; ++i) {
+            s.add(recs[i]);
+        }
+
+        h.sum = s.sum;
+        h.min = s.min;
+        h.max = s.max;
+
+        //first pass finds the width of each stream
+        std::uint64_t timeOr = 0;
+        std::uint64_t valueOr = 0;
+        std::uint64_t flagOr = recs[0].flags;
+        std::int64_t prevDelta = h.firstDelta;
+        std::int64_t prevTick = h.firstWhen + h.firstDelta;
+
+        for(std::size_t i = 1; i < count; ++i) {
+
+            if(i >= 2) {
+                const std::int64_t tick = recs[i].when / timeUnit;
+                timeOr |= zigzag(tick - prevTick - prevDelta);
+                prevDelta = tick - prevTick;
+                prevTick = tick;
+            }
+
+            valueOr |= zigzag(static_cast<std::int64_t>(recs[i].value) - recs[i - 1].value);
+            flagOr |= recs[i].flags;
+
+        }
+
+        h.timeBits = bitsFor(timeOr);
+        h.valueBits = bitsFor(valueOr);
+        h.flagBits = bitsFor(flagOr);
+
+        const std::uint64_t bits =
+            static_cast<std::uint64_t>(h.timeBits) * (count > 2 ? count - 2 : 0) +
+            static_cast<std::uint64_t>(h.valueBits) * (count - 1) +
+            static_cast<std::uint64_t>(h.flagBits) * count;
+
+        //whole words, plus one word of padding
+        h.payloadSize = static_cast<std::uint32_t>(((bits + 63) / 64 + 1) * 8);
+
+        out->assign(sizeof(h) + h.payloadSize, 0);
+        std::uint8_t* const payload = out->data() + sizeof(h);
+        BitWriter w(payload);
+
+        prevDelta = h.firstDelta;
+        prevTick = h.firstWhen + h.firstDelta;
+
+        for(std::size_t i = 2; i < count; ++i) {
+            const std::int64_t tick = recs[i].when / timeUnit;
+            w.put(zigzag(tick - prevTick - prevDelta), h.timeBits);
+            prevDelta = tick - prevTick;
+            prevTick = tick;
+        }
+
+        for(std::size_t i = 1; i < count; ++i) {
+            w.put(zigzag(static_cast<std::int64_t>(recs[i].value) - recs[i - 1].value), h.valueBits);
+        }
+
+        for(std::size_t i = 0; i < count; ++i) {
+            w.put(recs[i].flags, h.flagBits);
+        }
+
+        w.finish();
+
+        h.checksum = checksum(payload, h.payloadSize);
+        std::memcpy(out->data(), &h, sizeof(h));
+
+}
+
+void CompressedBlock::decode(
+    const CompressedBlockHeader& h,
+    const std::uint8_t* const payload,
+    const std::uint32_t timeUnit,
+    SampleRecord* const out) noexcept {
+
+        const std::size_t count = h.count;
+        std::uint64_t pos = 0;
+
+        //each stream is decoded in its own loop, which keeps them tight
+
+        std::int64_t t = h.firstWhen;
+        std::int64_t delta = h.firstDelta;
+        out[0].when = t * timeUnit;
+
+        if(count > 1) {
+            t += delta;
+            out[1].when = t * timeUnit;
+        }
+
+        for(std::size_t i = 2; i < count; ++i) {
+            delta += unzigzag(getBits(payload, pos, h.timeBits));
+            pos += h.timeBits;
+            t += delta;
+            out[i].when = t * timeUnit;
+        }
+
+        std::int64_t v = h.firstValue;
+        out[0].value = h.firstValue;
+
+        for(std::size_t i = 1; i < count; ++i) {
+            v += unzigzag(getBits(payload, pos, h.valueBits));
+            pos += h.valueBits;
+            out[i].value = static_cast<std::int32_t>(v);
+        }
+
+        if(h.flagBits == 0) {
+            for(std::size_t i = 0; i < count; ++i) {
+                out[i].flags = 0;
+            }
+            return;
+        }
+
+        for(std::size_t i = 0; i < count; ++i) {
+            out[i].flags = static_cast<std::uint32_t>(getBits(payload, pos, h.flagBits));
+            pos += h.flagBits;
+        }
+
+}
+
+std::uint32_t CompressedBlock::checksum(
+    const std::uint8_t* const payload,
+    const std::size_t size) noexcept {
+
+        //FNV-1a over words rather than bytes
+        std::uint64_t hash = 0xcbf29ce484222325ULL;
+
+        for(std::size_t i = 0; i + 8 <= size; i += 8) {
+            std::uint64_t w;
+            std::memcpy(&w, payload + i, sizeof(w));
+            hash = (hash ^ w) * 0x100000001b3ULL;
+        }
+
+        return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+
+}
+
+std::size_t CompressedLog::findEnd(
+    const std::uint8_t* const map,
+    const std::size_t size,
+    std::vector<CompressedIndexEntry>* const index) {
+
+        const auto& lh = *reinterpret_cast<const CompressedLogHeader*>(map);
+        std::size_t pos = lh.headerSize;
+
+        index->clear();
+
+        while(pos + sizeof(CompressedBlockHeader) <= size) {
+
+            CompressedBlockHeader h;
+            std::memcpy(&h, map + pos, sizeof(h));
+
+            const auto end = pos + sizeof(h) + h.payloadSize;
+
+            if( h.marker != CompressedBlockHeader::MARKER ||
+                h.count == 0 ||
+                h.count > lh.blockSize ||
+                h.payloadSize % 8 != 0 ||
+                end > size) {
+                    break;
+            }
+
+            //the header holds everything the index needs, so payloads
+            //are skipped rather than read
+            index->push_back(indexEntry(h, pos, lh.timeUnit));
+            pos = end;
+
+        }
+
+        /**
+         * Blocks are written one after another, so only the last can
+         * have been cut short (eg. the file grew but a power cut kept
+         * the block's data from reaching the disk)
+         */
+        while(!index->empty()) {
+
+            const auto offset = index->back().offset;
+            CompressedBlockHeader h;
+            std::memcpy(&h, map + offset, sizeof(h));
+
+            if(CompressedBlock::checksum(map + offset + sizeof(h), h.payloadSize) == h.checksum) {
+                break;
+            }
+
+            index->pop_back();
+            pos = offset;
+
+        }
+
+        return pos;
+
+}
+
+bool CompressedLog::_readIndex() noexcept {
+
+    if(this->_mapSize < this->header().headerSize + sizeof(CompressedLogTrailer)) {
+        return false;
+    }
+
+    CompressedLogTrailer t;
+    std::memcpy(&t, this->_map + this->_mapSize - sizeof(t), sizeof(t));
+
+    if(std::memcmp(t.magic, CompressedLogTrailer::MAGIC, CompressedLogTrailer::MAGIC_SIZE) != 0 ||
+        t.indexOffset < this->header().headerSize ||
+        t.indexOffset + t.entries * sizeof(CompressedIndexEntry) + sizeof(t) != this->_mapSize) {
+            return false;
+    }
+
+    const auto* const first = reinterpret_cast<const CompressedIndexEntry*>(
+        this->_map + t.indexOffset);
+
+    this->_index.assign(first, first + t.entries);
+
+    return true;
+
+}
+
+void CompressedLog::_scan() {
+    findEnd(this->_map, this->_mapSize, &this->_index);
+}
+
+CompressedLog::CompressedLog(const std::string& path) :
+    _map(nullptr),
+    _mapSize(0),
+    _count(0) {
+
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if(fd < 0) {
+            throw std::runtime_error("unable to open compressed sample log");
+        }
+
+        struct stat st;
+
+        if(::fstat(fd, &st) != 0 ||
+            static_cast<std::size_t>(st.st_size) < sizeof(CompressedLogHeader)) {
+                ::close(fd);
+                throw std::runtime_error("compressed sample log is too small");
+        }
+
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void* const m = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if(m == MAP_FAILED) {
+            throw std::runtime_error("unable to map compressed sample log");
+        }
+
+        this->_map = static_cast<const std::uint8_t*>(m);
+        this->_mapSize = size;
+
+        try {
+            validate(this->header());
+            if(!this->_readIndex()) {
+                this->_scan();
+            }
+        }
+        catch(...) {
+            ::munmap(m, size);
+            throw;
+        }
+
+        for(const auto& e : this->_index) {
+            this->_count += e.count;
+        }
+
+        ::madvise(m, size, MADV_SEQUENTIAL);
+
+}
+
+CompressedLog::~CompressedLog() {
+    ::munmap(const_cast<std::uint8_t*>(this->_map), this->_mapSize);
+}
+
+const CompressedLogHeader& CompressedLog::header() const noexcept {
+    return *reinterpret_cast<const CompressedLogHeader*>(this->_map);
+}
+
+std::size_t CompressedLog::size() const noexcept {
+    return this->_count;
+}
+
+const std::vector<CompressedIndexEntry>& CompressedLog::getIndex() const noexcept {
+    return this->_index;
+}
+
+void CompressedLog::decodeBlock(const std::size_t i, SampleRecord* const out) const noexcept {
+
+    const auto pos = this->_index[i].offset;
+    CompressedBlockHeader h;
+    std::memcpy(&h, this->_map + pos, sizeof(h));
+
+    CompressedBlock::decode(h, this->_map + pos + sizeof(h), this->header().timeUnit, out);
+
+}
+
+void CompressedLog::decode(std::vector<SampleRecord>* const out) const {
+
+    auto pos = out->size();
+    out->resize(pos + this->_count);
+
+    for(std::size_t i = 0; i < this->_index.size(); ++i) {
+        this->decodeBlock(i, out->data() + pos);
+        pos += this->_index[i].count;
+    }
+
+}
+
+std::size_t CompressedLog::findBlock(const std::int64_t when) const noexcept {
+
+    const auto it = std::lower_bound(
+        this->_index.begin(),
+        this->_index.end(),
+        when,
+        [](const CompressedIndexEntry& e, const std::int64_t w) {
+            return e.lastWhen < w;
+        });
+
+    return static_cast<std::size_t>(it - this->_index.begin());
+
+}
+
+void CompressedLog::range(
+    const std::int64_t from,
+    const std::int64_t to,
+    std::vector<SampleRecord>* const out) const {
+
+        std::vector<SampleRecord> block;
+
+        for(auto i = this->findBlock(from);
+            i < this->_index.size() && this->_index[i].firstWhen < to;
+            ++i) {
+
+                block.resize(this->_index[i].count);
+                this->decodeBlock(i, block.data());
+
+                for(const auto& r : block) {
+                    if(r.when >= from && r.when < to) {
+                        out->push_back(r);
+                    }
+                }
+
+        }
+
+}
+
+SampleSummary CompressedLog::summarise(
+    const std::int64_t from,
+    const std::int64_t to) const {
+
+        SampleSummary s;
+        std::vector<SampleRecord> block;
+
+        for(auto i = this->findBlock(from);
+            i < this->_index.size() && this->_index[i].firstWhen < to;
+            ++i) {
+
+                const auto& e = this->_index[i];
+
+                if(e.firstWhen >= from && e.lastWhen < to) {
+                    s.merge(e);
+                    continue;
+                }
+
+                block.resize(e.count);
+                this->decodeBlock(i, block.data());
+
+                for(const auto& r : block) {
+                    if(r.when >= from && r.when < to) {
+                        s.add(r);
+                    }
+                }
+
+        }
+
+        return s;
+
+}
+
+void CompressedLog::rollup(
+    const std::int64_t from,
+    const std::int64_t to,
+    const std::chrono::nanoseconds interval,
+    std::vector<SampleSummary>* const out) const {
+
+        const auto width = interval.count();
+
+        if(width <= 0) {
+            throw std::invalid_argument("interval must be greater than 0");
+        }
+
+        if(to <= from) {
+            out->clear();
+            return;
+        }
+
+        out->assign(static_cast<std::size_t>((to - from + width - 1) / width), SampleSummary());
+
+        std::vector<SampleRecord> block;
+
+        for(auto i = this->findBlock(from);
+            i < this->_index.size() && this->_index[i].firstWhen < to;
+            ++i) {
+
+                const auto& e = this->_index[i];
+
+                if( e.firstWhen >= from &&
+                    e.lastWhen < to &&
+                    (e.firstWhen - from) / width == (e.lastWhen - from) / width) {
+                        (*out)[static_cast<std::size_t>((e.firstWhen - from) / width)].merge(e);
+                        continue;
+                }
+
+                block.resize(e.count);
+                this->decodeBlock(i, block.data());
+
+                for(const auto& r : block) {
+                    if(r.when >= from && r.when < to) {
+                        (*out)[static_cast<std::size_t>((r.when - from) / width)].add(r);
+                    }
+                }
+
+        }
+
+}
+
+std::size_t CompressedLog::getFileSize() const noexcept {
+    return this->_mapSize;
+}
+
+std::chrono::nanoseconds CompressedLog::toRealtime(const std::int64_t when) const noexcept {
+    const auto& h = this->header();
+    return std::chrono::nanoseconds(h.createdRealtime + (when - h.createdMonotonic));
+}
+
+std::int64_t CompressedLog::fromRealtime(const std::chrono::nanoseconds t) const noexcept {
+    const auto& h = this->header();
+    return h.createdMonotonic + (t.count() - h.createdRealtime);
+}
+
+void CompressedLog::validate(const CompressedLogHeader& h) {
+
+    if(std::memcmp(h.magic, CompressedLogHeader::MAGIC, CompressedLogHeader::MAGIC_SIZE) != 0) {
+        throw std::runtime_error("not a compressed sample log");
+    }
+
+    if(h.version != CompressedLogHeader::VERSION) {
+        throw std::runtime_error("unsupported compressed sample log version");
+    }
+
+    if( h.headerSize < sizeof(CompressedLogHeader) ||
+        h.timeUnit == 0 ||
+        h.blockSize == 0) {
+            throw std::runtime_error("unsupported compressed sample log layout");
+    }
+
+}
+
+void CompressedLogWriter::_open(const std::string& path, const SampleLogMeta& meta) {
+
+    this->_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    if(this->_fd < 0) {
+        throw std::runtime_error("unable to open compressed sample log");
+    }
+
+    struct stat st;
+
+    if(::fstat(this->_fd, &st) != 0) {
+        throw std::runtime_error("unable to stat compressed sample log");
+    }
+
+    if(st.st_size > 0) {
+
+        //existing log; drop its index and any incomplete block, then
+        //carry on after its last complete block
+        const auto size = static_cast<std::size_t>(st.st_size);
+
+        if(size < sizeof(CompressedLogHeader)) {
+            throw std::runtime_error("compressed sample log is too small");
+        }
+
+        void* const m = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, this->_fd, 0);
+
+        if(m == MAP_FAILED) {
+            throw std::runtime_error("unable to map compressed sample log");
+        }
+
+        const auto* const map = static_cast<const std::uint8_t*>(m);
+        const auto& h = *reinterpret_cast<const CompressedLogHeader*>(map);
+
+        try {
+
+            CompressedLog::validate(h);
+
+            /**
+             * Times are monotonic times, which restart when the system
+             * boots. Appending to a log from an earlier boot would mix
+             * times which cannot be compared, breaking both the mapping
+             * to wall clock time and the time ordered index.
+             */
+            if(!Utility::isCurrentBoot(h.bootId)) {
+                throw std::runtime_error(
+                    "compressed sample log was written before the system last booted; use a new log");
+            }
+
+            this->_timeUnit = h.timeUnit;
+            this->_blockSize = h.blockSize;
+            this->_end = CompressedLog::findEnd(map, size, &this->_index);
+
+        }
+        catch(...) {
+            ::munmap(m, size);
+            throw;
+        }
+
+        ::munmap(m, size);
+
+        if(::ftruncate(this->_fd, static_cast<off_t>(this->_end)) != 0) {
+            throw std::runtime_error("unable to truncate compressed sample log");
+        }
+
+        return;
+
+    }
+
+    CompressedLogHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, CompressedLogHeader::MAGIC, CompressedLogHeader::MAGIC_SIZE);
+    h.version = CompressedLogHeader::VERSION;
+    h.headerSize = sizeof(CompressedLogHeader);
+    h.timeUnit = this->_timeUnit;
+    h.blockSize = static_cast<std::uint32_t>(this->_blockSize);
+
+    timespec ts;
+    ::clock_gettime(CLOCK_REALTIME, &ts);
+    h.createdRealtime = Utility::timespec_to_nanos(&ts).count();
+    h.createdMonotonic = Utility::getnanos().count();
+    Utility::getBootId(h.bootId);
+
+    h.refUnit = meta.refUnit;
+    h.offset = meta.offset;
+    h.dataPin = meta.dataPin;
+    h.clockPin = meta.clockPin;
+    h.rate = static_cast<std::uint8_t>(meta.rate);
+    h.channel = static_cast<std::uint8_t>(meta.channel);
+    h.gain = static_cast<std::uint8_t>(meta.gain);
+    h.unit = static_cast<std::uint8_t>(meta.unit);
+
+    if(!this->_write(&h, sizeof(h))) {
+        throw std::runtime_error("unable to write compressed sample log header");
+    }
+
+}
+
+bool CompressedLogWriter::_write(const void* const buf, const std::size_t len) noexcept {
+
+    const auto* p = static_cast<const std::uint8_t*>(buf);
+    std::size_t done = 0;
+
+    while(done < len) {
+
+        const auto n = ::pwrite(
+            this->_fd,
+            p + done,
+            len - done,
+            static_cast<off_t>(this->_end + done));
+
+        if(n < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        done += static_cast<std::size_t>(n);
+
+    }
+
+    this->_end += len;
+    return true;
+
+}
+
+CompressedLogWriter::CompressedLogWriter(
+    const std::string& path,
+    const SampleLogMeta& meta,
+    const std::size_t blockSize,
+    const std::uint32_t timeUnit) :
+        _fd(-1),
+        _timeUnit(timeUnit),
+        _blockSize(blockSize),
+        _end(0) {
+
+            if(blockSize == 0 || blockSize > UINT32_MAX || timeUnit == 0) {
+                throw std::invalid_argument("invalid block size or time unit");
+            }
+
+            try {
+                this->_open(path, meta);
+            }
+            catch(...) {
+                if(this->_fd >= 0) {
+                    ::close(this->_fd);
+                }
+                throw;
+            }
+
+            this->_pending.reserve(this->_blockSize);
+
+}
+
+CompressedLogWriter::~CompressedLogWriter() {
+
+    if(this->flush()) {
+
+        CompressedLogTrailer t;
+        std::memcpy(t.magic, CompressedLogTrailer::MAGIC, CompressedLogTrailer::MAGIC_SIZE);
+        t.indexOffset = this->_end;
+        t.entries = this->_index.size();
+
+        const auto end = this->_end;
+
+        //the index is rebuilt when the log is next appended to, so
+        //_end does not move past it
+        if(this->_write(this->_index.data(), this->_index.size() * sizeof(CompressedIndexEntry))) {
+            this->_write(&t, sizeof(t));
+        }
+
+        this->_end = end;
+
+    }
+
+    ::close(this->_fd);
+
+}
+
+bool CompressedLogWriter::append(const SampleRecord& r) noexcept {
+
+    this->_pending.push_back(r);
+
+    if(this->_pending.size() < this->_blockSize) {
+        return true;
+    }
+
+    return this->flush();
+
+}
+
+bool CompressedLogWriter::flush() noexcept {
+
+    if(this->_pending.empty()) {
+        return true;
+    }
+
+    const auto pos = this->_end;
+    bool ok;
+
+    try {
+        CompressedBlock::encode(
+            this->_pending.data(),
+            this->_pending.size(),
+            this->_timeUnit,
+            &this->_encoded);
+        ok = this->_write(this->_encoded.data(), this->_encoded.size());
+    }
+    catch(...) {
+        ok = false;
+    }
+
+    if(ok) {
+
+        CompressedBlockHeader h;
+        std::memcpy(&h, this->_encoded.data(), sizeof(h));
+
+        //_index grows by one entry per block, which is not worth avoiding
+        try {
+            this->_index.push_back(indexEntry(h, pos, this->_timeUnit));
+        }
+        catch(...) {
+        }
+
+    }
+    else {
+        //a partly written block is cut off so the next starts cleanly
+        this->_end = pos;
+        if(::ftruncate(this->_fd, static_cast<off_t>(pos)) != 0) {
+            //the torn block is detected by its checksum anyway
+        }
+    }
+
+    this->_pending.clear();
+    return ok;
+
+}
+
+std::size_t CompressedLogWriter::getPending() const noexcept {
+    return this->_pending.size();
+}
+
+std::int64_t CompressedLogWriter::getPendingSince() const noexcept {
+    return this->_pending.empty() ? 0 : this->_pending.front().when;
+}
+
+std::uint64_t CompressedLogWriter::getSize() const noexcept {
+    return this->_end;
+}
+
+};
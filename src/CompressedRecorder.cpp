@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "../include/CompressedLog.h"
+#include "../include/CompressedRecorder.h"
+#include "../include/SampleLog.h"
+#include "../include/SystemClock.h"
+#include "../include/Utility.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+constexpr std::chrono::nanoseconds CompressedRecorder::_FLUSH_INTERVAL;
+constexpr std::chrono::nanoseconds CompressedRecorder::_DEFAULT_SEAL_INTERVAL;
+
+void CompressedRecorder::_count(const std::size_t samples, const bool ok) noexcept {
+    if(ok) {
+        this->_written.fetch_add(samples, std::memory_order_relaxed);
+    }
+    else {
+        //the block which failed is discarded rather than retried
+        this->_writeErrors.fetch_add(1, std::memory_order_relaxed);
+        this->_dropped.fetch_add(samples, std::memory_order_relaxed);
+    }
+}
+
+void CompressedRecorder::_drain() noexcept {
+
+    const auto tail = this->_tail.load(std::memory_order_relaxed);
+    const auto head = this->_head.load(std::memory_order_acquire);
+
+    for(auto i = tail; i != head; ++i) {
+
+        //samples only count as written once their block is
+        const auto block = this->_log.getPending() + 1;
+        const bool ok = this->_log.append(this->_ring[i & this->_mask]);
+
+        if(this->_log.getPending() == 0) {
+            this->_count(block, ok);
+        }
+
+    }
+
+    this->_tail.store(head, std::memory_order_release);
+
+}
+
+void CompressedRecorder::_writeLoop() noexcept {
+
+    while(this->_running.load(std::memory_order_acquire)) {
+
+        SystemClock::getInstance()->sleep(_FLUSH_INTERVAL);
+        this->_drain();
+
+        //sample times are Utility::getnanos times, so compare with it
+        const auto pending = this->_log.getPending();
+        const auto since = this->_log.getPendingSince();
+
+        if( pending > 0 &&
+            Utility::getnanos().count() - since >= this->_sealInterval.count()) {
+                this->_count(pending, this->_log.flush());
+        }
+
+    }
+
+    this->_drain();
+
+    const auto pending = this->_log.getPending();
+
+    if(pending > 0) {
+        this->_count(pending, this->_log.flush());
+    }
+
+}
+
+CompressedRecorder::CompressedRecorder(
+    const std::string& path,
+    const SampleLogMeta& meta,
+    const std::chrono::nanoseconds sealInterval) :
+        _log(path, meta),
+        _ring(_DEFAULT_CAPACITY),
+        _mask(_ring.size() - 1),
+        _sealInterval(sealInterval),
+        _head(0),
+        _tail(0),
+        _running(true),
+        _written(0),
+        _dropped(0),
+        _writeErrors(0) {
+
+            this->_writer = std::thread(&CompressedRecorder::_writeLoop, this);
+
+}
+
+CompressedRecorder::~CompressedRecorder() {
+    this->_running.store(false, std::memory_order_release);
+    this->_writer.join();
+}
+
+void CompressedRecorder::push(const Value v, const std::chrono::nanoseconds when) noexcept {
+
+    const auto head = this->_head.load(std::memory_order_relaxed);
+
+    if(head - this->_tail.load(std::memory_order_acquire) >= this->_ring.size()) {
+        this->_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    SampleRecord& r = this->_ring[head & this->_mask];
+    r.when = when.count();
+    r.value = v;
+    r.flags = 0;
+
+    this->_head.store(head + 1, std::memory_order_release);
+
+}
+
+std::uint64_t CompressedRecorder::getWritten() const noexcept {
+    return this->_written.load(std::memory_order_relaxed);
+}
+
+std::uint64_t CompressedRecorder::getDropped() const noexcept {
+    return this->_dropped.load(std::memory_order_relaxed);
+}
+
+std::uint64_t CompressedRecorder::getWriteErrors() const noexcept {
+    return this->_writeErrors.load(std::memory_order_relaxed);
+}
+
+};
@@ -0,0 +1,1004 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../include/common.h"
+
+using namespace HX711;
+
+/**
+ * Daemon serving HX711 readings over a Unix domain socket
+ * 
+ * Usage: hx711d --socket PATH --scale DATA,CLOCK[,RATE[,REFUNIT[,OFFSET]]]
+ *               [--scale ...] [--batch ms] [--metrics file] [--shm NAME]
+ *               [--flight PATH] [--flight-minutes n] [--mode octal]
+ *               [--max-clients n] [--simulate]
+ * 
+ * hx711d claims the pins of every scale given and reads each one
+ * continuously on its own thread. Any number of processes can then
+ * connect to the socket to list the scales, get values, tare, or
+ * subscribe to every sample; see DaemonProtocol.h and RemoteScale.h.
+ * Scales are numbered from 0 in the order given.
+ * 
+ * --batch is how often subscribers are sent new samples (default 100).
+ * --metrics rewrites a file with the Prometheus metrics of every scale
+ * each second. --shm also publishes each scale's samples to a shared
+ * memory ring named NAME.N, where N is the scale's number, for other
+ * processes to read with SharedRingReader. --flight keeps the last
+ * --flight-minutes (default 10) of each scale's samples in a flight
+ * recorder file named PATH.N; see FlightRecorder.h. --simulate reads
+ * SimulatedChips instead of real pins.
+ * 
+ * Any client can tare and change calibration, so the socket is only
+ * open to the daemon's user and group (--mode, default 0660). At most
+ * --max-clients (default 32) are served at once; others are
+ * disconnected as soon as they connect.
+ * 
+ * Stops on SIGINT or SIGTERM.
+ */
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+/**
+ * A scale owned by the daemon. The sampler thread reads every
+ * conversion into a ring of SampleRecords, from which values are sent
+ * to clients without copying. The ring is large enough that a record
+ * being sent cannot be overwritten before the send completes or times
+ * out (see _SEND_TIMEOUT).
+ * 
+ * As an AbstractScale, values come from the ring, so zero tares the
+ * scale for every client. Hold calibrationLock to use the calibration.
+ */
+class DaemonScale : public AbstractScale, public SampleSink {
+
+protected:
+    static const std::size_t _RING_SIZE = 1 << 13;
+
+    static constexpr auto _NOT_READY_SLEEP = std::chrono::duration_cast
+        <std::chrono::nanoseconds>(std::chrono::milliseconds(1));
+
+    //longest a waiting client goes without checking the ring
+    static constexpr auto _WAIT_CHECK = std::chrono::milliseconds(100);
+
+    std::unique_ptr<GpioDriver> _sim;
+    HX711::HX711 _hx;
+    std::vector<SampleRecord> _ring;
+    std::atomic<std::uint64_t> _head;
+    std::mutex _notifyLock;
+    std::condition_variable _notify;
+    std::atomic<bool> _running;
+    std::unique_ptr<SharedRingPublisher> _shm;
+    std::unique_ptr<FlightRecorder> _flight;
+    std::thread _sampler;
+
+    void _sample() noexcept {
+
+        //best effort; needs root, as with AdvancedHX711's watcher
+        Utility::setThreadPriority(
+            ::sched_get_priority_max(SCHED_FIFO),
+            SCHED_FIFO,
+            ::pthread_self());
+
+        while(this->_running.load(std::memory_order_acquire)) {
+
+            try {
+                if(this->_hx.isReady()) {
+                    //pushed to the ring as a sink
+                    this->_hx.readValue();
+                    continue;
+                }
+            }
+            catch(const std::exception& ex) {
+                //already counted in the scale's metrics; try again
+            }
+
+            Utility::sleep(_NOT_READY_SLEEP);
+
+        }
+
+    }
+
+    std::chrono::nanoseconds _conversionPeriod() const noexcept {
+        return this->_hx.getRate() == Rate::HZ_80
+            ? std::chrono::nanoseconds(12500000)
+            : std::chrono::nanoseconds(100000000);
+    }
+
+    std::vector<Value> _copy(const Options o) {
+
+        std::uint64_t first;
+        std::uint64_t last;
+
+        this->await(o, &first, &last, [] { return stopRequested != 0; });
+
+        std::vector<Value> vals;
+        vals.reserve(static_cast<std::size_t>(last - first));
+
+        for(auto i = first; i < last; ++i) {
+            vals.push_back(this->_ring[i % _RING_SIZE].value);
+        }
+
+        return vals;
+
+    }
+
+
+public:
+    std::mutex calibrationLock;
+
+    DaemonScale(
+        const int dataPin,
+        const int clockPin,
+        const Rate rate,
+        const Value refUnit,
+        const Value offset,
+        const bool simulate) :
+            AbstractScale(Mass::Unit::G, refUnit, offset),
+            _sim(simulate ? new SimulatedChip(rate) : nullptr),
+            _hx(dataPin, clockPin, rate, this->_sim.get()),
+            _ring(_RING_SIZE),
+            _head(0),
+            _running(true) {
+
+                this->_weightMetrics = &this->_hx.getMetrics();
+                this->_hx.addSink(this);
+                this->_hx.connect();
+                this->_sampler = std::thread(&DaemonScale::_sample, this);
+
+    }
+
+    DaemonScale(const DaemonScale& that) = delete;
+    DaemonScale& operator=(const DaemonScale& that) = delete;
+
+    virtual ~DaemonScale() {
+        this->_running.store(false, std::memory_order_release);
+        this->_sampler.join();
+        this->_hx.removeSink(this);
+        if(this->_shm) {
+            this->_hx.removeSink(this->_shm.get());
+        }
+        if(this->_flight) {
+            this->_hx.removeSink(this->_flight.get());
+        }
+    }
+
+    /**
+     * Also publish samples to a shared memory ring. Call before any
+     * clients connect.
+     */
+    void publish(const std::string& name) {
+        std::lock_guard<std::mutex> lock(this->calibrationLock);
+        this->_shm.reset(new SharedRingPublisher(name, SampleLogMeta(*this, this->_hx)));
+        this->_hx.addSink(this->_shm.get());
+    }
+
+    /**
+     * Also keep recent samples in a flight recorder file. Call before
+     * any clients connect.
+     */
+    void record(const std::string& path, const std::chrono::seconds duration) {
+        std::lock_guard<std::mutex> lock(this->calibrationLock);
+        this->_flight.reset(new FlightRecorder(path, SampleLogMeta(*this, this->_hx), duration));
+        this->_hx.addSink(this->_flight.get());
+    }
+
+    /**
+     * Call with calibrationLock held after changing the calibration
+     */
+    void calibrated() noexcept {
+        if(this->_shm) {
+            this->_shm->setCalibration(this->_refUnit, this->_offset);
+        }
+        if(this->_flight) {
+            this->_flight->setCalibration(this->_refUnit, this->_offset);
+        }
+    }
+
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept override {
+
+        const auto head = this->_head.load(std::memory_order_relaxed);
+
+        SampleRecord& r = this->_ring[head % _RING_SIZE];
+        r.when = when.count();
+        r.value = v;
+        r.flags = 0;
+
+        this->_head.store(head + 1, std::memory_order_release);
+
+        /**
+         * Waiters are notified without taking _notifyLock so the sampler
+         * never blocks. A wake-up missed here is caught by waiters
+         * checking the ring every _WAIT_CHECK anyway.
+         */
+        this->_notify.notify_all();
+
+    }
+
+    std::uint64_t getHead() const noexcept {
+        return this->_head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Blocks until head has passed from, deadline passes, or stop
+     * returns true. Returns the head.
+     */
+    template <typename Stop>
+    std::uint64_t waitPast(
+        const std::uint64_t from,
+        const std::chrono::nanoseconds deadline,
+        Stop stop) {
+
+            std::unique_lock<std::mutex> lock(this->_notifyLock);
+            std::uint64_t head;
+
+            while((head = this->getHead()) <= from && !stop()) {
+
+                const auto now = Utility::getnanos();
+
+                if(now >= deadline) {
+                    break;
+                }
+
+                this->_notify.wait_for(lock, std::min<std::chrono::nanoseconds>(
+                    deadline - now, _WAIT_CHECK));
+
+            }
+
+            return head;
+
+    }
+
+    /**
+     * Waits for the samples o asks for, read after the call, and sets
+     * first and last to the range of them in the ring. A samples request
+     * gives up once no conversion has arrived for several periods.
+     */
+    void await(
+        const Options& o,
+        std::uint64_t* const first,
+        std::uint64_t* const last,
+        const std::function<bool()>& stop) {
+
+            const auto start = this->getHead();
+            const auto now = Utility::getnanos();
+            *first = start;
+
+            if(o.stratType == StrategyType::Time) {
+
+                const auto deadline = now + o.timeout;
+                std::uint64_t head = start;
+
+                while(Utility::getnanos() < deadline && !stop()) {
+                    head = this->waitPast(head, deadline, stop);
+                }
+
+                *last = std::min<std::uint64_t>(
+                    this->getHead(),
+                    start + DAEMON_MAX_SAMPLES);
+
+                return;
+
+            }
+
+            const auto count = std::min<std::uint64_t>(o.samples, DAEMON_MAX_SAMPLES);
+            const auto stall = this->_conversionPeriod() * 4 + std::chrono::seconds(1);
+            std::uint64_t head = start;
+
+            while(head < start + count && !stop()) {
+
+                const auto next = this->waitPast(head, Utility::getnanos() + stall, stop);
+
+                if(next == head) {
+                    break;
+                }
+
+                head = next;
+
+            }
+
+            *last = std::min<std::uint64_t>(head, start + count);
+
+    }
+
+    /**
+     * Points iov at the records in [first, last), in at most two
+     * pieces. Returns the number of iovecs used.
+     */
+    std::size_t describe(
+        const std::uint64_t first,
+        const std::uint64_t last,
+        iovec* const iov) noexcept {
+
+            const auto count = static_cast<std::size_t>(last - first);
+            const auto start = static_cast<std::size_t>(first % _RING_SIZE);
+            const auto firstPart = std::min(count, _RING_SIZE - start);
+
+            iov[0].iov_base = &this->_ring[start];
+            iov[0].iov_len = firstPart * sizeof(SampleRecord);
+            iov[1].iov_base = &this->_ring[0];
+            iov[1].iov_len = (count - firstPart) * sizeof(SampleRecord);
+
+            return count > firstPart ? 2 : 1;
+
+    }
+
+    /**
+     * Oldest sample still in the ring, with room left for sends in
+     * progress to finish
+     */
+    std::uint64_t oldest() const noexcept {
+        const auto head = this->getHead();
+        const auto keep = _RING_SIZE - DAEMON_MAX_SAMPLES;
+        return head > keep ? head - keep : 0;
+    }
+
+    virtual std::vector<Value> getValues(const std::size_t samples) override {
+
+        if(samples == 0) {
+            throw std::range_error("samples must be at least 1");
+        }
+
+        return this->_copy(Options(samples));
+
+    }
+
+    virtual std::vector<Value> getValues(const std::chrono::nanoseconds timeout) override {
+        return this->_copy(Options(timeout));
+    }
+
+    DaemonScaleInfo getInfo() const noexcept {
+
+        DaemonScaleInfo info;
+        std::memset(&info, 0, sizeof(info));
+
+        info.dataPin = this->_hx.getDataPin();
+        info.clockPin = this->_hx.getClockPin();
+        info.refUnit = this->_refUnit;
+        info.offset = this->_offset;
+        info.rate = static_cast<std::uint8_t>(this->_hx.getRate());
+        info.unit = static_cast<std::uint8_t>(this->_massUnit);
+
+        return info;
+
+    }
+
+};
+
+constexpr std::chrono::nanoseconds DaemonScale::_NOT_READY_SLEEP;
+constexpr std::chrono::milliseconds DaemonScale::_WAIT_CHECK;
+
+class Daemon {
+
+protected:
+
+    //how often the accept loop checks whether it should stop
+    static constexpr auto _STOP_CHECK = std::chrono::milliseconds(250);
+
+    /**
+     * A client which has not taken the whole of a message after this
+     * long is disconnected, however slowly it is reading. Must be far
+     * shorter than the time the sampler takes to go around a
+     * DaemonScale's ring, as messages are sent straight from the ring.
+     */
+    static constexpr auto _SEND_TIMEOUT = std::chrono::seconds(1);
+
+    struct Client {
+        int fd;
+        std::atomic<bool> done;
+        std::thread thread;
+    };
+
+    const std::string _path;
+    const std::chrono::milliseconds _batch;
+    const std::size_t _maxClients;
+    std::vector<std::unique_ptr<DaemonScale>>& _scales;
+    int _fd;
+    std::atomic<bool> _running;
+    std::list<std::unique_ptr<Client>> _clients;
+
+    bool _stopping() const noexcept {
+        return !this->_running.load(std::memory_order_acquire) || stopRequested != 0;
+    }
+
+    static DaemonHeader _header(
+        const DaemonHeader& req,
+        const DaemonStatus status,
+        const std::uint32_t count = 0) noexcept {
+
+            DaemonHeader h;
+            std::memset(&h, 0, sizeof(h));
+            h.magic = DaemonHeader::MAGIC;
+            h.type = req.type;
+            h.status = static_cast<std::uint8_t>(status);
+            h.scale = req.scale;
+            h.count = count;
+            return h;
+
+    }
+
+    /**
+     * Sends h followed by up to two pieces of payload in one call,
+     * within _SEND_TIMEOUT
+     */
+    static bool _send(
+        const int fd,
+        DaemonHeader h,
+        const iovec* const payload = nullptr,
+        const std::size_t payloadCount = 0) noexcept {
+
+            iovec iov[3];
+            iov[0].iov_base = &h;
+            iov[0].iov_len = sizeof(h);
+
+            for(std::size_t i = 0; i < payloadCount; ++i) {
+                iov[i + 1] = payload[i];
+            }
+
+            return Utility::sendAll(fd, iov, payloadCount + 1, _SEND_TIMEOUT);
+
+    }
+
+    bool _list(const int fd, const DaemonHeader& req) {
+
+        std::vector<DaemonScaleInfo> infos;
+
+        for(auto& s : this->_scales) {
+            std::lock_guard<std::mutex> lock(s->calibrationLock);
+            infos.push_back(s->getInfo());
+        }
+
+        const iovec iov = { infos.data(), infos.size() * sizeof(DaemonScaleInfo) };
+
+        return _send(
+            fd,
+            _header(req, DaemonStatus::OK, static_cast<std::uint32_t>(infos.size())),
+            &iov,
+            1);
+
+    }
+
+    bool _getValues(const int fd, const DaemonHeader& req, const Options& o) {
+
+        DaemonScale& s = *this->_scales[req.scale];
+        std::uint64_t first;
+        std::uint64_t last;
+
+        s.await(o, &first, &last, [this] { return this->_stopping(); });
+
+        if(first == last) {
+            return _send(fd, _header(req, DaemonStatus::NO_SAMPLES));
+        }
+
+        iovec iov[2];
+        const auto n = s.describe(first, last, iov);
+
+        return _send(
+            fd,
+            _header(req, DaemonStatus::OK, static_cast<std::uint32_t>(last - first)),
+            iov,
+            n);
+
+    }
+
+    bool _tare(const int fd, const DaemonHeader& req, const Options& o) {
+
+        DaemonScale& s = *this->_scales[req.scale];
+        DaemonScaleInfo info;
+
+        {
+            std::lock_guard<std::mutex> lock(s.calibrationLock);
+
+            try {
+                s.zero(o);
+                s.calibrated();
+            }
+            catch(const std::runtime_error& ex) {
+                return _send(fd, _header(req, DaemonStatus::NO_SAMPLES));
+            }
+
+            info = s.getInfo();
+
+        }
+
+        const iovec iov = { &info, sizeof(info) };
+
+        return _send(fd, _header(req, DaemonStatus::OK, 1), &iov, 1);
+
+    }
+
+    /**
+     * Sends every sample from the scale in batches until the client
+     * goes away or the daemon stops. A subscriber which falls so far
+     * behind that its samples have been overwritten skips ahead, and is
+     * told how many it lost.
+     */
+    void _subscribe(const int fd, const DaemonHeader& req) {
+
+        DaemonScale& s = *this->_scales[req.scale];
+        std::uint64_t cursor = s.getHead();
+
+        while(!this->_stopping()) {
+
+            const auto batchEnd = Utility::getnanos() + this->_batch;
+            const auto stop = [this] { return this->_stopping(); };
+
+            if(s.waitPast(cursor, batchEnd, stop) == cursor) {
+                continue;
+            }
+
+            //let the rest of the batch arrive
+            const auto now = Utility::getnanos();
+
+            if(now < batchEnd) {
+                Utility::sleep(batchEnd - now);
+            }
+
+            std::uint32_t lost = 0;
+            const auto oldest = s.oldest();
+
+            if(cursor < oldest) {
+                lost = static_cast<std::uint32_t>(oldest - cursor);
+                cursor = oldest;
+            }
+
+            const auto last = std::min<std::uint64_t>(
+                s.getHead(),
+                cursor + DAEMON_MAX_SAMPLES);
+
+            auto h = _header(req, DaemonStatus::OK, static_cast<std::uint32_t>(last - cursor));
+            h.type = static_cast<std::uint8_t>(DaemonMessageType::SAMPLES);
+            h.lost = lost;
+
+            iovec iov[2];
+            const auto n = s.describe(cursor, last, iov);
+
+            if(!_send(fd, h, iov, n)) {
+                return;
+            }
+
+            cursor = last;
+
+        }
+
+    }
+
+    void _serve(Client* const c) noexcept {
+
+        const int fd = c->fd;
+
+        try {
+
+            while(!this->_stopping()) {
+
+                DaemonHeader h;
+                DaemonRequest r;
+
+                if(!Utility::recvAll(fd, &h, sizeof(h)) ||
+                    h.magic != DaemonHeader::MAGIC ||
+                    !Utility::recvAll(fd, &r, sizeof(r))) {
+                        break;
+                }
+
+                const auto type = static_cast<DaemonMessageType>(h.type);
+
+                if(type == DaemonMessageType::LIST) {
+                    if(!this->_list(fd, h)) {
+                        break;
+                    }
+                    continue;
+                }
+
+                if(h.scale >= this->_scales.size()) {
+                    if(!_send(fd, _header(h, DaemonStatus::NO_SUCH_SCALE))) {
+                        break;
+                    }
+                    continue;
+                }
+
+                Options o;
+                o.stratType = static_cast<StrategyType>(r.strategy);
+                o.readType = static_cast<ReadType>(r.readType);
+                o.samples = static_cast<std::size_t>(r.samples);
+                o.timeout = std::chrono::nanoseconds(r.timeout);
+
+                const bool valid =
+                    r.strategy <= static_cast<std::uint8_t>(StrategyType::Time) &&
+                    r.readType <= static_cast<std::uint8_t>(ReadType::Average) &&
+                    (o.stratType == StrategyType::Time
+                        ? o.timeout.count() >= 0
+                        : o.samples > 0);
+
+                bool ok;
+
+                switch(type) {
+                    case DaemonMessageType::GET_VALUES:
+                        ok = valid
+                            ? this->_getValues(fd, h, o)
+                            : _send(fd, _header(h, DaemonStatus::BAD_REQUEST));
+                        break;
+                    case DaemonMessageType::TARE:
+                        ok = valid
+                            ? this->_tare(fd, h, o)
+                            : _send(fd, _header(h, DaemonStatus::BAD_REQUEST));
+                        break;
+                    case DaemonMessageType::SUBSCRIBE:
+                        this->_subscribe(fd, h);
+                        ok = false;
+                        break;
+                    default:
+                        ok = _send(fd, _header(h, DaemonStatus::BAD_REQUEST));
+                        break;
+                }
+
+                if(!ok) {
+                    break;
+                }
+
+            }
+
+        }
+        catch(const std::exception& ex) {
+            std::cerr << "client error: " << ex.what() << std::endl;
+        }
+
+        c->done.store(true, std::memory_order_release);
+
+    }
+
+    void _accept() {
+
+        const int fd = ::accept4(this->_fd, nullptr, nullptr, SOCK_CLOEXEC);
+
+        if(fd < 0) {
+            return;
+        }
+
+        //each client has its own thread; those which have finished
+        //are reaped first so they do not count
+        this->_reap(false);
+
+        if(this->_clients.size() >= this->_maxClients) {
+            ::close(fd);
+            return;
+        }
+
+        std::unique_ptr<Client> c(new Client());
+        c->fd = fd;
+        c->done = false;
+        c->thread = std::thread(&Daemon::_serve, this, c.get());
+
+        this->_clients.push_back(std::move(c));
+
+    }
+
+    void _reap(const bool all) {
+
+        for(auto it = this->_clients.begin(); it != this->_clients.end();) {
+
+            Client* const c = it->get();
+
+            if(all) {
+                //wakes a thread blocked in recv or send
+                ::shutdown(c->fd, SHUT_RDWR);
+            }
+            else if(!c->done.load(std::memory_order_acquire)) {
+                ++it;
+                continue;
+            }
+
+            c->thread.join();
+            ::close(c->fd);
+            it = this->_clients.erase(it);
+
+        }
+
+    }
+
+
+public:
+    Daemon(
+        const std::string& path,
+        const mode_t mode,
+        const std::size_t maxClients,
+        const std::chrono::milliseconds batch,
+        std::vector<std::unique_ptr<DaemonScale>>& scales) :
+            _path(path),
+            _batch(batch),
+            _maxClients(maxClients),
+            _scales(scales),
+            _fd(-1),
+            _running(true) {
+
+                sockaddr_un addr;
+                std::memset(&addr, 0, sizeof(addr));
+                addr.sun_family = AF_UNIX;
+
+                if(path.size() >= sizeof(addr.sun_path)) {
+                    throw std::invalid_argument("socket path too long");
+                }
+
+                std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+                ::unlink(path.c_str());
+
+                this->_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+                if(this->_fd < 0) {
+                    throw std::runtime_error("unable to create socket");
+                }
+
+                //the mode is set before listening, so no client can
+                //connect while it is still the umask's
+                if(::bind(this->_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+                    ::chmod(path.c_str(), mode) != 0 ||
+                    ::listen(this->_fd, SOMAXCONN) != 0) {
+                        ::close(this->_fd);
+                        throw std::runtime_error("unable to listen on " + path);
+                }
+
+    }
+
+    Daemon(const Daemon& that) = delete;
+    Daemon& operator=(const Daemon& that) = delete;
+
+    ~Daemon() {
+        this->_running.store(false, std::memory_order_release);
+        this->_reap(true);
+        ::close(this->_fd);
+        ::unlink(this->_path.c_str());
+    }
+
+    void run() {
+
+        pollfd pfd;
+        pfd.fd = this->_fd;
+        pfd.events = POLLIN;
+
+        while(stopRequested == 0) {
+
+            pfd.revents = 0;
+
+            if(::poll(&pfd, 1, static_cast<int>(_STOP_CHECK.count())) > 0) {
+                this->_accept();
+            }
+
+            this->_reap(false);
+
+        }
+
+    }
+
+};
+
+constexpr std::chrono::milliseconds Daemon::_STOP_CHECK;
+constexpr std::chrono::seconds Daemon::_SEND_TIMEOUT;
+
+static std::vector<std::string> split(const std::string& s, const char delim) {
+
+    std::vector<std::string> parts;
+    std::size_t start = 0;
+
+    while(true) {
+
+        const auto end = s.find(delim, start);
+        parts.push_back(s.substr(start, end - start));
+
+        if(end == std::string::npos) {
+            return parts;
+        }
+
+        start = end + 1;
+
+    }
+
+}
+
+struct ScaleConfig {
+    int dataPin;
+    int clockPin;
+    Rate rate;
+    Value refUnit;
+    Value offset;
+};
+
+static ScaleConfig parseScale(const std::string& arg) {
+
+    const auto parts = split(arg, ',');
+
+    if(parts.size() < 2 || parts.size() > 5) {
+        throw std::invalid_argument(arg);
+    }
+
+    ScaleConfig c;
+    c.dataPin = std::stoi(parts[0]);
+    c.clockPin = std::stoi(parts[1]);
+    c.rate = parts.size() > 2 && std::stoi(parts[2]) == 80 ? Rate::HZ_80 : Rate::HZ_10;
+    c.refUnit = parts.size() > 3 ? std::stoi(parts[3]) : 1;
+    c.offset = parts.size() > 4 ? std::stoi(parts[4]) : 0;
+
+    if(c.refUnit == 0) {
+        throw std::invalid_argument(arg);
+    }
+
+    return c;
+
+}
+
+int main(int argc, char** argv) {
+
+    using namespace std;
+    using namespace std::chrono;
+
+    const char* const err = "Usage: hx711d --socket PATH "
+        "--scale DATA,CLOCK[,RATE[,REFUNIT[,OFFSET]]] [--scale ...] "
+        "[--batch ms] [--metrics file] [--shm NAME] [--flight PATH] "
+        "[--flight-minutes n] [--mode octal] [--max-clients n] [--simulate]";
+
+    string path;
+    vector<ScaleConfig> configs;
+    milliseconds batch(100);
+    string metricsPath;
+    string shmName;
+    string flightPath;
+    minutes flightDuration(10);
+    mode_t mode = 0660;
+    size_t maxClients = 32;
+    bool simulate = false;
+
+    try {
+        for(int i = 1; i < argc; ++i) {
+
+            const bool hasValue = i + 1 < argc;
+
+            if(strcmp(argv[i], "--socket") == 0 && hasValue) {
+                path = argv[++i];
+            }
+            else if(strcmp(argv[i], "--scale") == 0 && hasValue) {
+                configs.push_back(parseScale(argv[++i]));
+            }
+            else if(strcmp(argv[i], "--batch") == 0 && hasValue) {
+                batch = milliseconds(stoul(argv[++i]));
+            }
+            else if(strcmp(argv[i], "--metrics") == 0 && hasValue) {
+                metricsPath = argv[++i];
+            }
+            else if(strcmp(argv[i], "--shm") == 0 && hasValue) {
+                shmName = argv[++i];
+            }
+            else if(strcmp(argv[i], "--flight") == 0 && hasValue) {
+                flightPath = argv[++i];
+            }
+            else if(strcmp(argv[i], "--flight-minutes") == 0 && hasValue) {
+                flightDuration = minutes(stoul(argv[++i]));
+            }
+            else if(strcmp(argv[i], "--mode") == 0 && hasValue) {
+                mode = static_cast<mode_t>(stoul(argv[++i], nullptr, 8));
+            }
+            else if(strcmp(argv[i], "--max-clients") == 0 && hasValue) {
+                maxClients = stoul(argv[++i]);
+            }
+            else if(strcmp(argv[i], "--simulate") == 0) {
+                simulate = true;
+            }
+            else {
+                throw invalid_argument(argv[i]);
+            }
+
+        }
+    }
+    catch(const exception& ex) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    if(path.empty() || configs.empty() || batch.count() == 0 ||
+        flightDuration.count() == 0 || maxClients == 0 || mode > 0777) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = &onStopSignal;
+    ::sigaction(SIGINT, &sa, nullptr);
+    ::sigaction(SIGTERM, &sa, nullptr);
+    ::signal(SIGPIPE, SIG_IGN);
+
+    vector<unique_ptr<DaemonScale>> scales;
+
+    try {
+        for(const auto& c : configs) {
+            scales.emplace_back(new DaemonScale(
+                c.dataPin,
+                c.clockPin,
+                c.rate,
+                c.refUnit,
+                c.offset,
+                simulate));
+        }
+    }
+    catch(const GpioException& ex) {
+        cerr << "Failed to connect to HX711 chip: " << ex.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    unique_ptr<MetricsExporter> exporter;
+
+    try {
+
+        if(!metricsPath.empty()) {
+            exporter.reset(new MetricsExporter(metricsPath));
+        }
+
+        if(!shmName.empty()) {
+            for(size_t i = 0; i < scales.size(); ++i) {
+                scales[i]->publish(shmName + "." + to_string(i));
+            }
+        }
+
+        if(!flightPath.empty()) {
+            for(size_t i = 0; i < scales.size(); ++i) {
+                scales[i]->record(flightPath + "." + to_string(i), flightDuration);
+            }
+        }
+
+        Daemon d(path, mode, maxClients, batch, scales);
+        d.run();
+
+    }
+    catch(const exception& ex) {
+        cerr << ex.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+
+}
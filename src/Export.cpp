@@ -0,0 +1,298 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "../include/common.h"
+
+using namespace HX711;
+
+/**
+ * Text export
+ * 
+ * Usage: hx711export FILE [--format csv|jsonl] [--output file]
+ *                    [--decimals n] [--ref-unit r] [--offset o]
+ *        hx711export --socket PATH [--scale n] [options as above]
+ * 
+ * Writes every sample in a sample log (see SampleLog.h) or compressed
+ * log (see CompressedLog.h) as CSV (the default) or JSON Lines, with
+ * its Unix time in nanoseconds, raw value, and weight. --ref-unit and
+ * --offset replace the file's calibration, and --decimals sets the
+ * weight's decimals (default 3).
+ * 
+ * With --socket, samples are instead streamed from a scale served by
+ * hx711d until SIGINT or SIGTERM. Unless --ref-unit or --offset are
+ * given, the scale's calibration is fetched from hx711d each second, so
+ * weights follow tares.
+ * 
+ * Output goes to stdout unless --output is given.
+ */
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::CSV;
+    int decimals = 3;
+    bool hasRefUnit = false;
+    bool hasOffset = false;
+    Value refUnit = 1;
+    Value offset = 0;
+};
+
+static bool isCompressed(const std::string& path) {
+
+    std::ifstream f(path, std::ios::binary);
+    char magic[CompressedLogHeader::MAGIC_SIZE];
+
+    return f.read(magic, sizeof(magic)) &&
+        std::memcmp(magic, CompressedLogHeader::MAGIC, sizeof(magic)) == 0;
+
+}
+
+template <typename Log>
+static std::uint64_t exportLog(const Log& log, const int fd, const ExportOptions& eo) {
+
+    const Value refUnit = eo.hasRefUnit ? eo.refUnit : Value(log.header().refUnit);
+    const Value offset = eo.hasOffset ? eo.offset : Value(log.header().offset);
+
+    SampleExporter ex(
+        fd,
+        eo.format,
+        refUnit == 0 ? Value(1) : refUnit,
+        offset,
+        SampleExporter::offsetOf(log),
+        eo.decimals);
+
+    ex.append(log);
+
+    if(!ex.flush()) {
+        throw std::runtime_error("unable to write output");
+    }
+
+    return ex.getRows();
+
+}
+
+static std::uint64_t exportStream(
+    const std::string& socket,
+    const std::size_t scale,
+    const int fd,
+    const ExportOptions& eo) {
+
+        SampleExporter ex(fd, eo.format, eo.refUnit, eo.offset, 0, eo.decimals);
+        RemoteSubscription sub(socket, scale);
+        std::vector<SampleRecord> recs;
+        auto nextUpdate = std::chrono::steady_clock::now();
+
+        while(stopRequested == 0) {
+
+            /**
+             * The daemon's times are this machine's monotonic clock,
+             * which drifts from (and is not stepped with) the wall
+             * clock, so the offset between them is kept up to date, as
+             * is the calibration unless it was given
+             */
+            if(std::chrono::steady_clock::now() >= nextUpdate) {
+
+                timespec ts;
+                ::clock_gettime(CLOCK_REALTIME, &ts);
+                ex.setTimeOffset(
+                    Utility::timespec_to_nanos(&ts).count() - Utility::getnanos().count());
+
+                if(!eo.hasRefUnit || !eo.hasOffset) {
+
+                    const auto infos = RemoteScale::list(socket);
+
+                    if(scale >= infos.size()) {
+                        throw std::runtime_error("no such scale");
+                    }
+
+                    const Value refUnit = eo.hasRefUnit ? eo.refUnit : Value(infos[scale].refUnit);
+                    const Value offset = eo.hasOffset ? eo.offset : Value(infos[scale].offset);
+
+                    ex.setCalibration(refUnit == 0 ? Value(1) : refUnit, offset);
+
+                }
+
+                nextUpdate = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+            }
+
+            pollfd pfd;
+            pfd.fd = sub.getFd();
+            pfd.events = POLLIN;
+
+            if(::poll(&pfd, 1, 250) <= 0) {
+                continue;
+            }
+
+            recs.clear();
+            sub.next(&recs);
+            ex.append(recs.data(), recs.size());
+
+            //batches arrive a few times a second, so each is written
+            //promptly for anything reading the output as it goes
+            if(!ex.flush()) {
+                throw std::runtime_error("unable to write output");
+            }
+
+        }
+
+        if(sub.getLost() > 0) {
+            std::cerr << sub.getLost() << " samples lost" << std::endl;
+        }
+
+        return ex.getRows();
+
+}
+
+int main(int argc, char** argv) {
+
+    using namespace std;
+
+    const char* const err = "Usage: hx711export FILE [--format csv|jsonl] [--output file] "
+        "[--decimals n] [--ref-unit r] [--offset o]\n"
+        "       hx711export --socket PATH [--scale n] [options as above]";
+
+    const char* path = nullptr;
+    const char* socket = nullptr;
+    const char* output = nullptr;
+    size_t scale = 0;
+    ExportOptions eo;
+
+    try {
+        for(int i = 1; i < argc; ++i) {
+
+            const bool hasValue = i + 1 < argc;
+
+            if(strcmp(argv[i], "--format") == 0 && hasValue) {
+                const char* const f = argv[++i];
+                if(strcmp(f, "csv") == 0) {
+                    eo.format = ExportFormat::CSV;
+                }
+                else if(strcmp(f, "jsonl") == 0) {
+                    eo.format = ExportFormat::JSONL;
+                }
+                else {
+                    throw invalid_argument(f);
+                }
+            }
+            else if(strcmp(argv[i], "--output") == 0 && hasValue) {
+                output = argv[++i];
+            }
+            else if(strcmp(argv[i], "--decimals") == 0 && hasValue) {
+                eo.decimals = stoi(argv[++i]);
+            }
+            else if(strcmp(argv[i], "--ref-unit") == 0 && hasValue) {
+                eo.refUnit = stoi(argv[++i]);
+                eo.hasRefUnit = true;
+            }
+            else if(strcmp(argv[i], "--offset") == 0 && hasValue) {
+                eo.offset = stoi(argv[++i]);
+                eo.hasOffset = true;
+            }
+            else if(strcmp(argv[i], "--socket") == 0 && hasValue) {
+                socket = argv[++i];
+            }
+            else if(strcmp(argv[i], "--scale") == 0 && hasValue) {
+                scale = static_cast<size_t>(stoul(argv[++i]));
+            }
+            else if(path == nullptr && argv[i][0] != '-') {
+                path = argv[i];
+            }
+            else {
+                throw invalid_argument(argv[i]);
+            }
+
+        }
+    }
+    catch(const exception& ex) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    if((path == nullptr) == (socket == nullptr)) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    int fd = STDOUT_FILENO;
+
+    if(output != nullptr) {
+        fd = ::open(output, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if(fd < 0) {
+            cerr << "cannot open " << output << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = &onStopSignal;
+    ::sigaction(SIGINT, &sa, nullptr);
+    ::sigaction(SIGTERM, &sa, nullptr);
+
+    uint64_t rows = 0;
+    int rc = EXIT_SUCCESS;
+
+    try {
+        if(socket != nullptr) {
+            rows = exportStream(socket, scale, fd, eo);
+        }
+        else if(isCompressed(path)) {
+            rows = exportLog(CompressedLog(path), fd, eo);
+        }
+        else {
+            rows = exportLog(SampleLog(path), fd, eo);
+        }
+    }
+    catch(const exception& ex) {
+        cerr << ex.what() << endl;
+        rc = EXIT_FAILURE;
+    }
+
+    if(output != nullptr) {
+        ::close(fd);
+    }
+
+    cerr << rows << " samples" << endl;
+
+    return rc;
+
+}
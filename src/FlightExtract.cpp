@@ -0,0 +1,195 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../include/common.h"
+
+using namespace HX711;
+
+/**
+ * Flight recorder extraction
+ * 
+ * Usage: hx711flight FILE [--from t] [--to t] [--last seconds]
+ *                    [--log output]
+ * 
+ * Writes the samples in a flight recorder file (see FlightRecorder.h)
+ * read between --from (inclusive) and --to (exclusive), given as Unix
+ * times in seconds (eg. 1700000000.25), or in the --last seconds before
+ * the newest sample. With neither, every sample is written.
+ * 
+ * Output is CSV on stdout: the Unix time in nanoseconds, the raw value,
+ * and the value as calibrated in the file. --log writes a binary sample
+ * log (see SampleLog.h) instead.
+ */
+
+static std::int64_t toNanos(const char* const seconds) {
+    return static_cast<std::int64_t>(std::stold(seconds) * 1000000000.0L);
+}
+
+static void writeCsv(
+    const std::vector<SampleRecord>& recs,
+    const SampleLogMeta& meta) {
+
+        //record times are already wall clock times
+        SampleExporter ex(
+            STDOUT_FILENO,
+            ExportFormat::CSV,
+            meta.refUnit == 0 ? Value(1) : meta.refUnit,
+            meta.offset);
+
+        ex.append(recs.data(), recs.size());
+
+        if(!ex.flush()) {
+            throw std::runtime_error("unable to write output");
+        }
+
+}
+
+static void writeLog(
+    const std::string& path,
+    const std::vector<SampleRecord>& recs,
+    const SampleLogMeta& meta) {
+
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+
+        if(!f) {
+            throw std::runtime_error("cannot open " + path);
+        }
+
+        SampleLogHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, SampleLogHeader::MAGIC, SampleLogHeader::MAGIC_SIZE);
+        h.version = SampleLogHeader::VERSION;
+        h.headerSize = sizeof(SampleLogHeader);
+        h.recordSize = sizeof(SampleRecord);
+
+        //record times are already wall clock times
+        h.createdRealtime = 0;
+        h.createdMonotonic = 0;
+
+        meta.writeTo(&h);
+
+        f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        f.write(
+            reinterpret_cast<const char*>(recs.data()),
+            static_cast<std::streamsize>(recs.size() * sizeof(SampleRecord)));
+
+        if(!f) {
+            throw std::runtime_error("unable to write " + path);
+        }
+
+}
+
+int main(int argc, char** argv) {
+
+    using namespace std;
+
+    const char* const err = "Usage: hx711flight FILE [--from t] [--to t] "
+        "[--last seconds] [--log output]";
+
+    const char* path = nullptr;
+    const char* logPath = nullptr;
+    int64_t from = INT64_MIN;
+    int64_t to = INT64_MAX;
+    int64_t last = -1;
+
+    try {
+        for(int i = 1; i < argc; ++i) {
+
+            const bool hasValue = i + 1 < argc;
+
+            if(strcmp(argv[i], "--from") == 0 && hasValue) {
+                from = toNanos(argv[++i]);
+            }
+            else if(strcmp(argv[i], "--to") == 0 && hasValue) {
+                to = toNanos(argv[++i]);
+            }
+            else if(strcmp(argv[i], "--last") == 0 && hasValue) {
+                last = toNanos(argv[++i]);
+            }
+            else if(strcmp(argv[i], "--log") == 0 && hasValue) {
+                logPath = argv[++i];
+            }
+            else if(path == nullptr) {
+                path = argv[i];
+            }
+            else {
+                throw invalid_argument(argv[i]);
+            }
+
+        }
+    }
+    catch(const exception& ex) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    if(path == nullptr) {
+        cerr << err << endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+
+        FlightLog log(path);
+        vector<SampleRecord> recs;
+
+        if(last >= 0) {
+            log.extract(INT64_MIN, INT64_MAX, &recs);
+            const int64_t newest = recs.empty() ? 0 : recs.back().when;
+            recs.clear();
+            from = newest - last;
+            to = INT64_MAX;
+        }
+
+        log.extract(from, to, &recs);
+
+        const auto meta = log.getMeta();
+
+        if(logPath != nullptr) {
+            writeLog(logPath, recs, meta);
+        }
+        else {
+            writeCsv(recs, meta);
+        }
+
+        cerr << recs.size() << " samples" << endl;
+
+    }
+    catch(const exception& ex) {
+        cerr << ex.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,212 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "../include/FlightLog.h"
+#include "../include/HX711.h"
+#include "../include/Mass.h"
+#include "../include/SampleLog.h"
+
+namespace HX711 {
+
+constexpr const char* const FlightLogHeader::MAGIC;
+
+FlightLog::FlightLog(const std::string& path) :
+    _map(nullptr),
+    _mapSize(0) {
+
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if(fd < 0) {
+            throw std::runtime_error("unable to open flight recorder file");
+        }
+
+        struct stat st;
+
+        if(::fstat(fd, &st) != 0 ||
+            static_cast<std::size_t>(st.st_size) < sizeof(FlightLogHeader)) {
+                ::close(fd);
+                throw std::runtime_error("flight recorder file is too small");
+        }
+
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void* const m = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if(m == MAP_FAILED) {
+            throw std::runtime_error("unable to map flight recorder file");
+        }
+
+        this->_map = static_cast<const std::uint8_t*>(m);
+        this->_mapSize = size;
+
+        try {
+
+            validate(this->header());
+
+            const auto& h = this->header();
+
+            if(size < h.headerSize + static_cast<std::size_t>(h.capacity) * h.recordSize) {
+                throw std::runtime_error("flight recorder file is too small");
+            }
+
+        }
+        catch(...) {
+            ::munmap(m, size);
+            throw;
+        }
+
+}
+
+FlightLog::~FlightLog() {
+    ::munmap(const_cast<std::uint8_t*>(this->_map), this->_mapSize);
+}
+
+const FlightLogHeader& FlightLog::header() const noexcept {
+    return *reinterpret_cast<const FlightLogHeader*>(this->_map);
+}
+
+std::size_t FlightLog::size() const noexcept {
+    const auto head = this->header().head.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(std::min<std::uint64_t>(head, this->header().capacity));
+}
+
+const SampleRecord& FlightLog::operator[](const std::size_t i) const noexcept {
+
+    const auto& h = this->header();
+    const auto head = h.head.load(std::memory_order_acquire);
+    const auto first = head > h.capacity ? head - h.capacity : 0;
+
+    return reinterpret_cast<const SampleRecord*>(this->_map + h.headerSize)
+        [(first + i) % h.capacity];
+
+}
+
+std::size_t FlightLog::extract(
+    const std::int64_t from,
+    const std::int64_t to,
+    std::vector<SampleRecord>* const out) const {
+
+        const auto& h = this->header();
+        const auto records = reinterpret_cast<const SampleRecord*>(this->_map + h.headerSize);
+
+        //head is read once so indexes do not move while the recorder writes
+        const auto head = h.head.load(std::memory_order_acquire);
+        const auto count = std::min<std::uint64_t>(head, h.capacity);
+        const auto first = head - count;
+        const auto at = [&](const std::uint64_t i) -> const SampleRecord& {
+            return records[(first + i) % h.capacity];
+        };
+
+        /**
+         * Records head says were stored but which did not reach the disk
+         * before a power failure still hold samples from a lap of the
+         * ring earlier (or nothing), so are older than the oldest sample.
+         */
+        std::uint64_t end = count;
+
+        while(end > 1 && at(end - 1).when < at(0).when) {
+            --end;
+        }
+
+        const auto before = out->size();
+        std::int64_t newer = INT64_MAX;
+
+        /**
+         * Walks back from the newest sample. A sample which is not older
+         * than one after it (eg. from before the clock stepped back) is
+         * skipped.
+         */
+        for(std::uint64_t i = end; i > 0; --i) {
+
+            const SampleRecord& r = at(i - 1);
+
+            if(r.when >= newer) {
+                continue;
+            }
+
+            if(r.when < from) {
+                break;
+            }
+
+            newer = r.when;
+
+            if(r.when < to) {
+                out->push_back(r);
+            }
+
+        }
+
+        std::reverse(out->begin() + static_cast<std::ptrdiff_t>(before), out->end());
+
+        return out->size() - before;
+
+}
+
+SampleLogMeta FlightLog::getMeta() const noexcept {
+
+    const auto& h = this->header();
+    SampleLogMeta meta;
+
+    meta.refUnit = h.refUnit;
+    meta.offset = h.offset;
+    meta.dataPin = h.dataPin;
+    meta.clockPin = h.clockPin;
+    meta.rate = static_cast<Rate>(h.rate);
+    meta.channel = static_cast<Channel>(h.channel);
+    meta.gain = static_cast<Gain>(h.gain);
+    meta.unit = static_cast<Mass::Unit>(h.unit);
+
+    return meta;
+
+}
+
+void FlightLog::validate(const FlightLogHeader& h) {
+
+    if(std::memcmp(h.magic, FlightLogHeader::MAGIC, FlightLogHeader::MAGIC_SIZE) != 0) {
+        throw std::runtime_error("not a flight recorder file");
+    }
+
+    if(h.version != FlightLogHeader::VERSION) {
+        throw std::runtime_error("unsupported flight recorder file version");
+    }
+
+    if( h.headerSize != sizeof(FlightLogHeader) ||
+        h.recordSize != sizeof(SampleRecord) ||
+        h.capacity == 0) {
+            throw std::runtime_error("unsupported flight recorder file layout");
+    }
+
+}
+
+};
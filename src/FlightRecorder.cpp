@@ -0,0 +1,241 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/FlightLog.h"
+#include "../include/FlightRecorder.h"
+#include "../include/HX711.h"
+#include "../include/SampleLog.h"
+#include "../include/Utility.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+constexpr std::chrono::seconds FlightRecorder::_DEFAULT_DURATION;
+constexpr std::chrono::seconds FlightRecorder::_OFFSET_INTERVAL;
+
+void FlightRecorder::_updateOffset() noexcept {
+    timespec ts;
+    ::clock_gettime(CLOCK_REALTIME, &ts);
+    this->_offsetAt = Utility::getnanos().count();
+    this->_realtimeOffset = Utility::timespec_to_nanos(&ts).count() - this->_offsetAt;
+}
+
+bool FlightRecorder::_reusable(
+    const std::size_t size,
+    const SampleLogMeta& meta,
+    const std::uint64_t capacity) const noexcept {
+
+        if(size != sizeof(FlightLogHeader) + capacity * sizeof(SampleRecord)) {
+            return false;
+        }
+
+        FlightLogHeader h;
+
+        if(::pread(this->_fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h))) {
+            return false;
+        }
+
+        try {
+            FlightLog::validate(h);
+        }
+        catch(const std::runtime_error& ex) {
+            return false;
+        }
+
+        //samples of a different scale or configuration are not mixed in
+        return h.capacity == capacity &&
+            h.dataPin == meta.dataPin &&
+            h.clockPin == meta.clockPin &&
+            h.rate == static_cast<std::uint8_t>(meta.rate) &&
+            h.channel == static_cast<std::uint8_t>(meta.channel) &&
+            h.gain == static_cast<std::uint8_t>(meta.gain) &&
+            h.refUnit == meta.refUnit;
+
+}
+
+void FlightRecorder::_create(const SampleLogMeta& meta, const std::uint64_t capacity) {
+
+    if(::ftruncate(this->_fd, 0) != 0) {
+        throw std::runtime_error("unable to truncate flight recorder file");
+    }
+
+    //allocate every block now so writes through the mapping cannot fail
+    if(::posix_fallocate(this->_fd, 0, static_cast<off_t>(this->_mapSize)) != 0) {
+        throw std::runtime_error("unable to allocate flight recorder file");
+    }
+
+    FlightLogHeader h{};
+    std::memcpy(h.magic, FlightLogHeader::MAGIC, FlightLogHeader::MAGIC_SIZE);
+    h.version = FlightLogHeader::VERSION;
+    h.headerSize = sizeof(FlightLogHeader);
+    h.recordSize = sizeof(SampleRecord);
+    h.capacity = static_cast<std::uint32_t>(capacity);
+    h.refUnit = meta.refUnit;
+    h.offset = meta.offset;
+    h.dataPin = meta.dataPin;
+    h.clockPin = meta.clockPin;
+    h.rate = static_cast<std::uint8_t>(meta.rate);
+    h.channel = static_cast<std::uint8_t>(meta.channel);
+    h.gain = static_cast<std::uint8_t>(meta.gain);
+    h.unit = static_cast<std::uint8_t>(meta.unit);
+
+    timespec ts;
+    ::clock_gettime(CLOCK_REALTIME, &ts);
+    h.createdRealtime = Utility::timespec_to_nanos(&ts).count();
+
+    if(::pwrite(this->_fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h))) {
+        throw std::runtime_error("unable to write flight recorder header");
+    }
+
+}
+
+FlightRecorder::FlightRecorder(
+    const std::string& path,
+    const SampleLogMeta& meta,
+    const std::chrono::seconds duration) :
+        _fd(-1),
+        _map(nullptr),
+        _mapSize(0),
+        _header(nullptr),
+        _records(nullptr),
+        _capacity(0),
+        _head(0),
+        _realtimeOffset(0),
+        _offsetAt(0) {
+
+            if(duration.count() <= 0) {
+                throw std::invalid_argument("duration must be positive");
+            }
+
+            const std::uint64_t hz = meta.rate == Rate::HZ_10 ? 10 : 80;
+            const auto capacity = static_cast<std::uint64_t>(duration.count()) * hz;
+
+            if(capacity > UINT32_MAX) {
+                throw std::invalid_argument("duration is too long");
+            }
+
+            this->_capacity = capacity;
+            this->_mapSize = sizeof(FlightLogHeader) + capacity * sizeof(SampleRecord);
+
+            this->_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+            if(this->_fd < 0) {
+                throw std::runtime_error("unable to open flight recorder file");
+            }
+
+            try {
+
+                struct stat st;
+
+                if(::fstat(this->_fd, &st) != 0) {
+                    throw std::runtime_error("unable to stat flight recorder file");
+                }
+
+                if(!this->_reusable(static_cast<std::size_t>(st.st_size), meta, capacity)) {
+                    this->_create(meta, capacity);
+                }
+
+                void* const m = ::mmap(
+                    nullptr,
+                    this->_mapSize,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED,
+                    this->_fd,
+                    0);
+
+                if(m == MAP_FAILED) {
+                    throw std::runtime_error("unable to map flight recorder file");
+                }
+
+                this->_map = static_cast<std::uint8_t*>(m);
+
+            }
+            catch(...) {
+                ::close(this->_fd);
+                throw;
+            }
+
+            this->_header = reinterpret_cast<FlightLogHeader*>(this->_map);
+            this->_records = reinterpret_cast<SampleRecord*>(
+                this->_map + sizeof(FlightLogHeader));
+            this->_head = this->_header->head.load(std::memory_order_relaxed);
+            this->_header->opens++;
+
+            //the ring is written in order, over and over
+            ::madvise(this->_map, this->_mapSize, MADV_SEQUENTIAL);
+
+            this->setCalibration(meta.refUnit, meta.offset);
+            this->_updateOffset();
+
+}
+
+FlightRecorder::~FlightRecorder() {
+    //start writing back now rather than wait for the kernel
+    ::msync(this->_map, this->_mapSize, MS_ASYNC);
+    ::munmap(this->_map, this->_mapSize);
+    ::close(this->_fd);
+}
+
+void FlightRecorder::push(const Value v, const std::chrono::nanoseconds when) noexcept {
+
+    if(when.count() - this->_offsetAt >= std::chrono::nanoseconds(_OFFSET_INTERVAL).count()) {
+        this->_updateOffset();
+    }
+
+    SampleRecord& r = this->_records[this->_head % this->_capacity];
+    r.when = when.count() + this->_realtimeOffset;
+    r.value = v;
+    r.flags = 0;
+
+    ++this->_head;
+    this->_header->head.store(this->_head, std::memory_order_release);
+
+}
+
+void FlightRecorder::sync() noexcept {
+    ::msync(this->_map, this->_mapSize, MS_SYNC);
+}
+
+void FlightRecorder::setCalibration(const Value refUnit, const Value offset) noexcept {
+    this->_header->refUnit = refUnit;
+    this->_header->offset = offset;
+}
+
+std::size_t FlightRecorder::getCapacity() const noexcept {
+    return static_cast<std::size_t>(this->_capacity);
+}
+
+};
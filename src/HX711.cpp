@@ -20,16 +20,27 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <mutex>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
+#include <vector>
+#include "../include/BitTiming.h"
+#include "../include/GpioDriver.h"
 #include "../include/GpioException.h"
 #include "../include/HX711.h"
 #include "../include/IntegrityException.h"
+#include "../include/LatencyHistogram.h"
+#include "../include/LgpioDriver.h"
+#include "../include/Metrics.h"
+#include "../include/PerfCounters.h"
+#include "../include/SampleSink.h"
 #include "../include/TimeoutException.h"
+#include "../include/Trace.h"
 #include "../include/Utility.h"
 #include "../include/Value.h"
 
@@ -85,7 +96,7 @@ bool HX711::_readBit() const {
     //first, clock pin is set high to make DOUT ready to be read from
     //and the current ACTUAL time is noted for later
     const auto startNanos = Utility::getnanos();
-    Utility::writeGpio(this->_gpioHandle, this->_clockPin, GpioLevel::HIGH);
+    this->_gpio->write(this->_gpioHandle, this->_clockPin, GpioLevel::HIGH);
 
     //then delay for sufficient time to allow DOUT to be ready (0.1us)
     //and min amount of time between the high to low clock pulse. Note
@@ -94,8 +105,13 @@ bool HX711::_readBit() const {
         Utility::delay(std::max(_T2, _T3));
     }
 
-    Utility::writeGpio(this->_gpioHandle, this->_clockPin, GpioLevel::LOW);
-    const auto diff = Utility::getnanos() - startNanos;
+    this->_gpio->write(this->_gpioHandle, this->_clockPin, GpioLevel::LOW);
+    const auto endNanos = Utility::getnanos();
+    const auto diff = endNanos - startNanos;
+
+    if(this->_bitTiming != nullptr) {
+        this->_bitTiming->recordPulse(startNanos, endNanos);
+    }
 
     //at this point, according to the documentation, if the clock pin
     //was held high for longer than 60us, the chip will have entered
@@ -106,7 +122,7 @@ bool HX711::_readBit() const {
     }
 
     //at this stage, DOUT is ready so read the bit value
-    const auto bit = Utility::readGpio(this->_gpioHandle, this->_dataPin);
+    const auto bit = this->_gpio->read(this->_gpioHandle, this->_dataPin);
 
     //Assuming everything was OK, the datasheet requires a further
     //delay before the next pulse
@@ -120,7 +136,11 @@ bool HX711::_readBit() const {
 
 void HX711::_readBits(val_t* const v) {
 
+    Trace::begin("wait commLock");
     std::lock_guard<std::mutex> lock(this->_commLock);
+    Trace::end("wait commLock");
+
+    TraceScope trace("clockOut");
 
     //The datasheet notes a tiny delay between DOUT going low and the
     //initial clock pin change
@@ -128,31 +148,62 @@ void HX711::_readBits(val_t* const v) {
         Utility::delay(_T1);
     }
 
-    //msb first
-    for(auto i = decltype(_BITS_PER_CONVERSION_PERIOD){0};
-        i < _BITS_PER_CONVERSION_PERIOD;
-        ++i) {
-            *v <<= 1;
-            *v |= this->_readBit();
+    if(this->_bitTiming != nullptr) {
+        this->_bitTiming->beginRead();
+    }
+
+    try {
+
+        //msb first
+        for(auto i = decltype(_BITS_PER_CONVERSION_PERIOD){0};
+            i < _BITS_PER_CONVERSION_PERIOD;
+            ++i) {
+                *v <<= 1;
+                *v |= this->_readBit();
+        }
+
+        this->_setInputGainSelection();
+
+    }
+    catch(...) {
+        //failed reads are the ones worth keeping
+        if(this->_bitTiming != nullptr) {
+            this->_bitTiming->endRead(true);
+        }
+        throw;
     }
 
-    this->_setInputGainSelection();
+    if(this->_bitTiming != nullptr) {
+        this->_bitTiming->endRead();
+    }
 
 }
 
-HX711::HX711(const int dataPin, const int clockPin, const Rate rate) noexcept :
-    _gpioHandle(-1),
-    _dataPin(dataPin),
-    _clockPin(clockPin),
-    _rate(rate),
-    _channel(Channel::A),
-    _gain(Gain::GAIN_128),
-    _strictTiming(false),
-    _useDelays(false),
-    _bitFormat(Format::MSB) {
+HX711::HX711(
+    const int dataPin,
+    const int clockPin,
+    const Rate rate,
+    GpioDriver* const gpio) noexcept :
+        _gpio(gpio != nullptr ? gpio : LgpioDriver::getInstance()),
+        _gpioHandle(-1),
+        _dataPin(dataPin),
+        _clockPin(clockPin),
+        _rate(rate),
+        _channel(Channel::A),
+        _gain(Gain::GAIN_128),
+        _strictTiming(false),
+        _useDelays(false),
+        _bitFormat(Format::MSB),
+        _bitTiming(nullptr),
+        _metrics(dataPin, clockPin) {
+            this->_metrics.waitReadyLatency = &this->_waitReadyLatency;
+            this->_metrics.readValueLatency = &this->_readValueLatency;
+            MetricsRegistry::getInstance()->add(&this->_metrics);
 }
 
 HX711::~HX711() {
+
+    MetricsRegistry::getInstance()->remove(&this->_metrics);
     
     try {
         this->disconnect();
@@ -169,9 +220,9 @@ void HX711::connect() {
         return;
     }
 
-    this->_gpioHandle = Utility::openGpioHandle(0);
-    Utility::openGpioInput(this->_gpioHandle, this->_dataPin);
-    Utility::openGpioOutput(this->_gpioHandle, this->_clockPin);
+    this->_gpioHandle = this->_gpio->openHandle(0);
+    this->_gpio->openInput(this->_gpioHandle, this->_dataPin);
+    this->_gpio->openOutput(this->_gpioHandle, this->_clockPin);
 
     this->setConfig(this->_channel, this->_gain);
 
@@ -183,9 +234,9 @@ void HX711::disconnect() {
         return;
     }
 
-    Utility::closeGpioPin(this->_gpioHandle, this->_clockPin);
-    Utility::closeGpioPin(this->_gpioHandle, this->_dataPin);
-    Utility::closeGpioHandle(this->_gpioHandle);
+    this->_gpio->closePin(this->_gpioHandle, this->_clockPin);
+    this->_gpio->closePin(this->_gpioHandle, this->_dataPin);
+    this->_gpio->closeHandle(this->_gpioHandle);
 
     this->_gpioHandle = -1;
 
@@ -225,6 +276,10 @@ int HX711::getClockPin() const noexcept {
     return this->_clockPin;
 }
 
+Rate HX711::getRate() const noexcept {
+    return this->_rate;
+}
+
 Channel HX711::getChannel() const noexcept {
     return this->_channel;
 }
@@ -297,11 +352,12 @@ bool HX711::isReady() const {
      * over time can/should be done by other calling code
      */
     try {
-        return Utility::readGpio(
+        return this->_gpio->read(
             this->_gpioHandle,
             this->_dataPin) == GpioLevel::LOW;
     }
     catch(const GpioException& ex) {
+        this->_metrics.gpioErrors.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
 
@@ -309,17 +365,19 @@ bool HX711::isReady() const {
 
 bool HX711::waitReady(const std::chrono::nanoseconds timeout) const {
 
-    using namespace std::chrono;
+    TraceScope trace("waitReady");
 
-    const auto maxEnd = high_resolution_clock::now();
+    const auto start = Utility::getnanos();
+    const auto maxEnd = start + timeout;
 
     while(true) {
 
         if(this->isReady()) {
+            this->_waitReadyLatency.record(Utility::getnanos() - start);
             return true;
         }
 
-        if(high_resolution_clock::now() >= maxEnd) {
+        if(Utility::getnanos() >= maxEnd) {
             return false;
         }
 
@@ -329,15 +387,38 @@ bool HX711::waitReady(const std::chrono::nanoseconds timeout) const {
 
 Value HX711::readValue() {
 
+    PerfScope perf(PerfOp::READ_VALUE);
+    const auto when = Utility::getnanos();
     val_t v = 0;
 
-    this->_readBits(&v);
+    try {
+        this->_readBits(&v);
+    }
+    catch(const IntegrityException& ex) {
+        this->_metrics.integrityFailures.fetch_add(1, std::memory_order_relaxed);
+        throw;
+    }
+    catch(const GpioException& ex) {
+        this->_metrics.gpioErrors.fetch_add(1, std::memory_order_relaxed);
+        throw;
+    }
+
+    this->_readValueLatency.record(Utility::getnanos() - when);
+    this->_metrics.values.fetch_add(1, std::memory_order_relaxed);
 
     if(this->_bitFormat == Format::LSB) {
         v = Utility::reverseBits(v);
     }
 
-    return Value(_convertFromTwosComplement(v));
+    const Value val(_convertFromTwosComplement(v));
+
+    std::lock_guard<std::mutex> lock(this->_sinkLock);
+
+    for(auto sink : this->_sinks) {
+        sink->push(val, when);
+    }
+
+    return val;
     
 }
 
@@ -350,9 +431,9 @@ void HX711::powerDown() {
      * should help to keep the underlying code from optimising it away -
      * if does at all.
      */
-    Utility::writeGpio(this->_gpioHandle, this->_clockPin, GpioLevel::LOW);
+    this->_gpio->write(this->_gpioHandle, this->_clockPin, GpioLevel::LOW);
     Utility::delay(std::chrono::microseconds(1));
-    Utility::writeGpio(this->_gpioHandle, this->_clockPin, GpioLevel::HIGH);
+    this->_gpio->write(this->_gpioHandle, this->_clockPin, GpioLevel::HIGH);
 
     /**
      * "When PD_SCK pin changes from low to high
@@ -373,7 +454,7 @@ void HX711::powerUp() {
      * chip will reset and enter normal operation mode"
      * Datasheet pg. 5
      */
-    Utility::writeGpio(this->_gpioHandle, this->_clockPin, GpioLevel::LOW);
+    this->_gpio->write(this->_gpioHandle, this->_clockPin, GpioLevel::LOW);
 
     /**
      * "Settling time refers to the time from power up, reset,
@@ -386,4 +467,39 @@ void HX711::powerUp() {
 
 }
 
+void HX711::addSink(SampleSink* const sink) {
+
+    if(sink == nullptr) {
+        throw std::invalid_argument("sink cannot be null");
+    }
+
+    std::lock_guard<std::mutex> lock(this->_sinkLock);
+    this->_sinks.push_back(sink);
+
+}
+
+void HX711::removeSink(SampleSink* const sink) {
+    std::lock_guard<std::mutex> lock(this->_sinkLock);
+    this->_sinks.erase(
+        std::remove(this->_sinks.begin(), this->_sinks.end(), sink),
+        this->_sinks.end());
+}
+
+LatencyHistogram& HX711::getWaitReadyLatency() noexcept {
+    return this->_waitReadyLatency;
+}
+
+LatencyHistogram& HX711::getReadValueLatency() noexcept {
+    return this->_readValueLatency;
+}
+
+void HX711::setBitTiming(BitTiming* const bt) {
+    std::lock_guard<std::mutex> lock(this->_commLock);
+    this->_bitTiming = bt;
+}
+
+ScaleMetrics& HX711::getMetrics() noexcept {
+    return this->_metrics;
+}
+
 };
\ No newline at end of file
@@ -0,0 +1,174 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "../include/LatencyHistogram.h"
+
+namespace HX711 {
+
+std::size_t LatencyHistogram::_indexOf(const std::uint64_t ns) noexcept {
+
+    //the first two powers of two are stored exactly
+    if(ns < _SUB_BUCKETS * 2) {
+        return static_cast<std::size_t>(ns);
+    }
+
+    const unsigned char mag = static_cast<unsigned char>(63 - __builtin_clzll(ns));
+
+    if(mag > _MAX_MAGNITUDE) {
+        return _BUCKET_COUNT - 1;
+    }
+
+    const unsigned char shift = mag - _SUB_BUCKET_BITS;
+    const std::size_t sub = (ns >> shift) & (_SUB_BUCKETS - 1);
+
+    return (shift + 1) * _SUB_BUCKETS + sub;
+
+}
+
+std::uint64_t LatencyHistogram::_upperBoundOf(const std::size_t index) noexcept {
+
+    if(index < _SUB_BUCKETS * 2) {
+        return index;
+    }
+
+    const std::size_t shift = index / _SUB_BUCKETS - 1;
+    const std::uint64_t sub = index % _SUB_BUCKETS;
+
+    return ((_SUB_BUCKETS + sub + 1) << shift) - 1;
+
+}
+
+LatencyHistogram::LatencyHistogram() noexcept {
+    this->reset();
+}
+
+void LatencyHistogram::record(const std::chrono::nanoseconds d) noexcept {
+
+    //a clock going backwards is counted as 0
+    const std::uint64_t ns = d.count() > 0 ? 
+        static_cast<std::uint64_t>(d.count()) : 0;
+
+    this->_buckets[_indexOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    this->_sum.fetch_add(ns, std::memory_order_relaxed);
+
+    std::uint64_t prev = this->_max.load(std::memory_order_relaxed);
+
+    while(ns > prev && !this->_max.compare_exchange_weak(
+        prev, ns, std::memory_order_relaxed)) {
+    }
+
+}
+
+void LatencyHistogram::reset() noexcept {
+
+    for(std::size_t i = 0; i < _BUCKET_COUNT; ++i) {
+        this->_buckets[i].store(0, std::memory_order_relaxed);
+    }
+
+    this->_sum.store(0, std::memory_order_relaxed);
+    this->_max.store(0, std::memory_order_relaxed);
+
+}
+
+std::uint64_t LatencyHistogram::getCount() const noexcept {
+
+    std::uint64_t n = 0;
+
+    for(std::size_t i = 0; i < _BUCKET_COUNT; ++i) {
+        n += this->_buckets[i].load(std::memory_order_relaxed);
+    }
+
+    return n;
+
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMax() const noexcept {
+    return std::chrono::nanoseconds(
+        this->_max.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMean() const noexcept {
+
+    const auto n = this->getCount();
+
+    if(n == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    return std::chrono::nanoseconds(
+        this->_sum.load(std::memory_order_relaxed) / n);
+
+}
+
+std::chrono::nanoseconds LatencyHistogram::getSum() const noexcept {
+    return std::chrono::nanoseconds(
+        this->_sum.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds LatencyHistogram::getPercentile(const double p) const noexcept {
+
+    //copy first so the total and the walk agree
+    std::uint64_t counts[_BUCKET_COUNT];
+    std::uint64_t n = 0;
+
+    for(std::size_t i = 0; i < _BUCKET_COUNT; ++i) {
+        counts[i] = this->_buckets[i].load(std::memory_order_relaxed);
+        n += counts[i];
+    }
+
+    if(n == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    //rank of the sample wanted, from 1 to n
+    const double clamped = std::min(1.0, std::max(0.0, p));
+    const std::uint64_t rank = std::max<std::uint64_t>(1,
+        static_cast<std::uint64_t>(std::ceil(clamped * n)));
+
+    std::uint64_t seen = 0;
+    std::size_t i = 0;
+
+    for(; i < _BUCKET_COUNT - 1; ++i) {
+        seen += counts[i];
+        if(seen >= rank) {
+            break;
+        }
+    }
+
+    const auto max = this->_max.load(std::memory_order_relaxed);
+
+    //the last bucket has no upper bound
+    if(i == _BUCKET_COUNT - 1) {
+        return std::chrono::nanoseconds(max);
+    }
+
+    return std::chrono::nanoseconds(std::min(_upperBoundOf(i), max));
+
+}
+
+};
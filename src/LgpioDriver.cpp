@@ -0,0 +1,61 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "../include/LgpioDriver.h"
+#include "../include/Utility.h"
+
+namespace HX711 {
+
+int LgpioDriver::openHandle(const int chip) {
+    return Utility::openGpioHandle(chip);
+}
+
+void LgpioDriver::closeHandle(const int handle) {
+    Utility::closeGpioHandle(handle);
+}
+
+void LgpioDriver::openInput(const int handle, const int pin) {
+    Utility::openGpioInput(handle, pin);
+}
+
+void LgpioDriver::openOutput(const int handle, const int pin) {
+    Utility::openGpioOutput(handle, pin);
+}
+
+void LgpioDriver::closePin(const int handle, const int pin) {
+    Utility::closeGpioPin(handle, pin);
+}
+
+GpioLevel LgpioDriver::read(const int handle, const int pin) {
+    return Utility::readGpio(handle, pin);
+}
+
+void LgpioDriver::write(const int handle, const int pin, const GpioLevel lev) {
+    Utility::writeGpio(handle, pin, lev);
+}
+
+LgpioDriver* LgpioDriver::getInstance() noexcept {
+    static LgpioDriver instance;
+    return &instance;
+}
+
+};
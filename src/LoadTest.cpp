@@ -0,0 +1,333 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <unordered_set>
+#include <unistd.h>
+#include <vector>
+#include "../include/common.h"
+
+using namespace HX711;
+
+/**
+ * Scalability load test
+ * 
+ * Usage: hx711loadtest [max scales] [seconds per step] [--csv]
+ * 
+ * For each rate (10Hz, 80Hz) and each N from 1 to max scales, runs N
+ * AdvancedHX711s - each with its own watcher thread - against simulated
+ * chips for the given time, while N consumer threads collect values
+ * with getValues. Each row reports:
+ * 
+ * - captured: values the consumers received, as a percentage of the
+ *   conversions expected in that time (min and mean over scales). A
+ *   conversion either side of the window can put this slightly over 100
+ * - latency: from a conversion becoming ready to the watcher having
+ *   read it and made it available to the consumer (p50, p99, max)
+ * - cpu: process CPU time as a percentage of one core
+ * - rss/scale: growth in resident memory per scale
+ */
+
+/**
+ * A SimulatedChip whose values are sequence numbers, and which remembers
+ * when each was converted so latency can be measured when it is read
+ */
+class LoadChip : public SimulatedChip {
+
+protected:
+    static const std::size_t _HISTORY = 1 << 12;
+
+    std::uint32_t _seq;
+    std::vector<std::int64_t> _convertedAt;
+
+    virtual bool _nextConversion(
+        const std::chrono::nanoseconds now,
+        std::uint32_t* const v) override {
+
+            if(!SimulatedChip::_nextConversion(now, v)) {
+                return false;
+            }
+
+            //_nextAt has moved on by one period from the conversion
+            ++this->_seq;
+            this->_convertedAt[this->_seq & (_HISTORY - 1)] =
+                (this->_nextAt - this->_period).count();
+
+            *v = VirtualChip::toRaw(static_cast<val_t>(this->_seq & 0x7fffff));
+            return true;
+
+    }
+
+public:
+    explicit LoadChip(const Rate r) :
+        SimulatedChip(r),
+        _seq(0),
+        _convertedAt(_HISTORY, 0) {
+    }
+
+    /**
+     * Only called from the watcher thread which also reads the chip
+     */
+    std::int64_t convertedAt(const std::uint32_t seq) const noexcept {
+        return this->_convertedAt[seq & (_HISTORY - 1)];
+    }
+
+};
+
+/**
+ * Records read latency for every value; called on the watcher thread
+ */
+class LatencySink : public SampleSink {
+
+protected:
+    const LoadChip* const _chip;
+
+public:
+    std::vector<std::int64_t> latencies;
+
+    LatencySink(const LoadChip* const chip, const std::size_t expected) :
+        _chip(chip) {
+            this->latencies.reserve(expected * 2);
+    }
+
+    virtual void push(const Value v, const std::chrono::nanoseconds when) noexcept override {
+
+        (void)when;
+
+        if(this->latencies.size() == this->latencies.capacity()) {
+            return;
+        }
+
+        const auto seq = static_cast<std::uint32_t>(static_cast<val_t>(v));
+
+        this->latencies.push_back(
+            Utility::getnanos().count() - this->_chip->convertedAt(seq));
+
+    }
+
+};
+
+struct Scale {
+    std::unique_ptr<LoadChip> chip;
+    std::unique_ptr<LatencySink> sink;
+    std::unique_ptr<AdvancedHX711> hx;
+    std::size_t captured;
+};
+
+static std::chrono::nanoseconds cpuTime() {
+    timespec ts;
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return Utility::timespec_to_nanos(&ts);
+}
+
+//resident set size in bytes
+static std::size_t rss() {
+
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0;
+    std::size_t resident = 0;
+
+    statm >> pages >> resident;
+
+    return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+}
+
+static double percentile(const std::vector<std::int64_t>& sorted, const double p) {
+
+    if(sorted.empty()) {
+        return 0;
+    }
+
+    const auto i = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5);
+    return static_cast<double>(sorted[i]);
+
+}
+
+static void step(
+    const Rate rate,
+    const std::size_t n,
+    const std::chrono::seconds duration,
+    const bool csv) {
+
+        using namespace std::chrono;
+
+        const double hz = rate == Rate::HZ_80 ? 80 : 10;
+        const auto expected = static_cast<std::size_t>(hz * duration.count());
+        const std::size_t rssBefore = rss();
+
+        std::vector<Scale> scales(n);
+
+        for(auto& s : scales) {
+            s.chip.reset(new LoadChip(rate));
+            s.sink.reset(new LatencySink(s.chip.get(), expected));
+            s.hx.reset(new AdvancedHX711(0, 1, 1, 0, rate, s.chip.get()));
+            s.hx->addSink(s.sink.get());
+            s.captured = 0;
+        }
+
+        const std::size_t rssAfter = rss();
+        const auto cpuStart = cpuTime();
+        const auto wallStart = steady_clock::now();
+
+        std::vector<std::thread> consumers;
+
+        for(auto& s : scales) {
+            consumers.push_back(std::thread([&s, duration]() {
+                const auto vals = s.hx->getValues(duration_cast<nanoseconds>(duration));
+                std::unordered_set<val_t> unique(vals.begin(), vals.end());
+                s.captured = unique.size();
+            }));
+        }
+
+        for(auto& t : consumers) {
+            t.join();
+        }
+
+        const auto cpu = cpuTime() - cpuStart;
+        const auto wall = steady_clock::now() - wallStart;
+
+        std::vector<std::int64_t> latencies;
+        double minCaptured = 100;
+        double sumCaptured = 0;
+
+        for(auto& s : scales) {
+
+            //stop the watcher before touching what its sink recorded
+            s.hx.reset();
+
+            const double pct = 100.0 * s.captured / expected;
+            minCaptured = std::min(minCaptured, pct);
+            sumCaptured += pct;
+
+            latencies.insert(
+                latencies.end(),
+                s.sink->latencies.begin(),
+                s.sink->latencies.end());
+
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+
+        const double cpuPct = 100.0 * cpu.count() /
+            duration_cast<nanoseconds>(wall).count();
+        const double rssPerScale = rssAfter > rssBefore
+            ? static_cast<double>(rssAfter - rssBefore) / n / 1024
+            : 0;
+
+        const double p50 = percentile(latencies, 0.5) / 1000;
+        const double p99 = percentile(latencies, 0.99) / 1000;
+        const double max = latencies.empty() ? 0 : latencies.back() / 1000.0;
+
+        std::cout << std::fixed << std::setprecision(1);
+
+        if(csv) {
+            std::cout   << static_cast<int>(hz) << "," << n << ","
+                        << minCaptured << "," << sumCaptured / n << ","
+                        << p50 << "," << p99 << "," << max << ","
+                        << cpuPct << "," << rssPerScale << std::endl;
+            return;
+        }
+
+        std::cout   << std::setw(4) << static_cast<int>(hz) << "Hz"
+                    << std::setw(6) << n
+                    << std::setw(10) << minCaptured
+                    << std::setw(10) << sumCaptured / n
+                    << std::setw(11) << p50
+                    << std::setw(11) << p99
+                    << std::setw(11) << max
+                    << std::setw(9) << cpuPct
+                    << std::setw(12) << rssPerScale
+                    << std::endl;
+
+}
+
+int main(int argc, char** argv) {
+
+    using namespace std;
+
+    std::size_t maxScales = 4;
+    std::chrono::seconds duration(3);
+    bool csv = false;
+    int positional = 0;
+
+    try {
+        for(int i = 1; i < argc; ++i) {
+            if(std::strcmp(argv[i], "--csv") == 0) {
+                csv = true;
+            }
+            else if(positional == 0) {
+                maxScales = stoul(argv[i]);
+                ++positional;
+            }
+            else if(positional == 1) {
+                duration = std::chrono::seconds(stoul(argv[i]));
+                ++positional;
+            }
+            else {
+                throw invalid_argument(argv[i]);
+            }
+        }
+    }
+    catch(const exception& ex) {
+        cerr << "Usage: hx711loadtest [max scales] [seconds per step] [--csv]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    if(maxScales == 0 || duration.count() == 0) {
+        cerr << "max scales and seconds must be at least 1" << endl;
+        return EXIT_FAILURE;
+    }
+
+    if(csv) {
+        cout << "rate_hz,scales,captured_min_pct,captured_mean_pct,"
+             << "latency_p50_us,latency_p99_us,latency_max_us,cpu_pct,rss_per_scale_kb"
+             << endl;
+    }
+    else {
+        cout    << "  rate  scales  capt min  capt avg    p50 (us)   p99 (us)   max (us)    cpu %  rss/scale KB"
+                << endl;
+    }
+
+    const Rate rates[] = { Rate::HZ_10, Rate::HZ_80 };
+
+    for(const auto r : rates) {
+        for(std::size_t n = 1; n <= maxScales; ++n) {
+            step(r, n, duration, csv);
+        }
+    }
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,422 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "../include/AbstractScale.h"
+#include "../include/CompressedLog.h"
+#include "../include/LogAnalyzer.h"
+#include "../include/Mass.h"
+#include "../include/QuantileSketch.h"
+#include "../include/SampleLog.h"
+#include "../include/Value.h"
+#include "../include/WorkStealingPool.h"
+
+namespace HX711 {
+
+LogScale::LogScale(
+    const SampleRecord* const begin,
+    const SampleRecord* const end,
+    const std::int64_t origin,
+    const Mass::Unit unit,
+    const Value refUnit,
+    const Value offset) noexcept :
+        AbstractScale(unit, refUnit, offset),
+        _pos(begin),
+        _end(end),
+        _origin(origin),
+        _lastWhen(0) {
+}
+
+bool LogScale::done() const noexcept {
+    return this->_pos == this->_end;
+}
+
+const SampleRecord* LogScale::position() const noexcept {
+    return this->_pos;
+}
+
+std::int64_t LogScale::getLastWhen() const noexcept {
+    return this->_lastWhen;
+}
+
+std::vector<Value> LogScale::getValues(const std::size_t samples) {
+
+    const auto n = std::min(
+        samples,
+        static_cast<std::size_t>(this->_end - this->_pos));
+
+    std::vector<Value> vals;
+    vals.reserve(n);
+
+    if(n > 0) {
+        this->_lastWhen = this->_pos->when;
+    }
+
+    for(std::size_t i = 0; i < n; ++i) {
+        vals.push_back(Value(this->_pos->value));
+        ++this->_pos;
+    }
+
+    return vals;
+
+}
+
+std::vector<Value> LogScale::getValues(const std::chrono::nanoseconds timeout) {
+
+    std::vector<Value> vals;
+
+    if(this->done() || timeout.count() <= 0) {
+        return vals;
+    }
+
+    const auto length = timeout.count();
+    const auto w = window(this->_pos->when, this->_origin, length);
+
+    this->_lastWhen = this->_pos->when;
+
+    while(!this->done() && window(this->_pos->when, this->_origin, length) == w) {
+        vals.push_back(Value(this->_pos->value));
+        ++this->_pos;
+    }
+
+    return vals;
+
+}
+
+std::int64_t LogScale::window(
+    const std::int64_t when,
+    const std::int64_t origin,
+    const std::int64_t length) noexcept {
+
+        //rounds towards negative infinity for times before origin
+        const auto d = when - origin;
+        return d >= 0 ? d / length : -((-d + length - 1) / length);
+
+}
+
+AnalysisSummary::AnalysisSummary() :
+    samples(0),
+    readings(0),
+    min(std::numeric_limits<double>::infinity()),
+    max(-std::numeric_limits<double>::infinity()),
+    sum(0) {
+}
+
+void AnalysisSummary::add(const double weight) {
+    ++this->readings;
+    this->min = std::min(this->min, weight);
+    this->max = std::max(this->max, weight);
+    this->sum += weight;
+    this->quantiles.add(weight);
+}
+
+void AnalysisSummary::merge(const AnalysisSummary& s) {
+    this->samples += s.samples;
+    this->readings += s.readings;
+    this->min = std::min(this->min, s.min);
+    this->max = std::max(this->max, s.max);
+    this->sum += s.sum;
+    this->quantiles.merge(s.quantiles);
+}
+
+double AnalysisSummary::mean() const noexcept {
+    return this->readings == 0 ? 0 : this->sum / static_cast<double>(this->readings);
+}
+
+void LogAnalyzer::_split(
+    const SampleRecord* const recs,
+    const std::size_t count,
+    std::vector<std::size_t>* const bounds) const {
+
+        bounds->clear();
+        bounds->push_back(0);
+
+        if(this->_options.stratType == StrategyType::Samples) {
+
+            //whole readings per chunk
+            const auto per = this->_options.samples;
+            const auto step = std::max<std::size_t>(1, this->_chunkSize / per) * per;
+
+            for(auto b = step; b < count; b += step) {
+                bounds->push_back(b);
+            }
+
+        }
+        else {
+
+            //move each nominal boundary forward to the next window edge
+            const auto length = this->_options.timeout.count();
+            const auto origin = recs[0].when;
+
+            for(auto b = this->_chunkSize; b < count; b += this->_chunkSize) {
+
+                b = std::max(b, bounds->back() + 1);
+
+                while(b < count &&
+                    LogScale::window(recs[b].when, origin, length) ==
+                    LogScale::window(recs[b - 1].when, origin, length)) {
+                        ++b;
+                }
+
+                if(b < count) {
+                    bounds->push_back(b);
+                }
+
+            }
+
+        }
+
+        bounds->push_back(count);
+
+}
+
+void LogAnalyzer::_analyzeChunk(
+    const SampleRecord* const begin,
+    const SampleRecord* const end,
+    const std::int64_t origin,
+    AnalysisSummary* const s,
+    std::vector<AnalysisReading>* const out) const {
+
+        LogScale scale(
+            begin,
+            end,
+            origin,
+            this->_unit,
+            this->_refUnit,
+            this->_offset);
+
+        s->samples = static_cast<std::uint64_t>(end - begin);
+
+        while(!scale.done()) {
+
+            const double w = scale.weight(this->_options).getValue();
+            s->add(w);
+
+            if(out != nullptr) {
+                AnalysisReading r;
+                r.when = scale.getLastWhen();
+                r.weight = w;
+                out->push_back(r);
+            }
+
+        }
+
+}
+
+void LogAnalyzer::_combine(
+    const std::vector<AnalysisSummary>& summaries,
+    const std::vector<std::vector<AnalysisReading>>& readings,
+    AnalysisSummary* const total,
+    std::vector<AnalysisReading>* const out) {
+
+        //combined in chunk order, so the result does not depend on
+        //which thread ran which chunk
+        for(std::size_t i = 0; i < summaries.size(); ++i) {
+            total->merge(summaries[i]);
+            if(out != nullptr) {
+                out->insert(out->end(), readings[i].begin(), readings[i].end());
+            }
+        }
+
+}
+
+LogAnalyzer::LogAnalyzer(
+    const Options o,
+    const Mass::Unit unit,
+    const Value refUnit,
+    const Value offset,
+    const std::size_t threads,
+    const std::size_t chunkSize) :
+        _pool(threads),
+        _options(o),
+        _unit(unit),
+        _refUnit(refUnit),
+        _offset(offset),
+        _chunkSize(std::max<std::size_t>(1, chunkSize)) {
+
+            if( (o.stratType == StrategyType::Samples && o.samples == 0) ||
+                (o.stratType == StrategyType::Time && o.timeout.count() <= 0)) {
+                    throw std::invalid_argument("options must read at least one sample");
+            }
+
+            if(refUnit == 0) {
+                throw std::invalid_argument("reference unit cannot be 0");
+            }
+
+}
+
+AnalysisSummary LogAnalyzer::analyze(
+    const SampleRecord* const recs,
+    const std::size_t count,
+    std::vector<AnalysisReading>* const out) {
+
+        AnalysisSummary total;
+
+        if(count == 0) {
+            return total;
+        }
+
+        std::vector<std::size_t> bounds;
+        this->_split(recs, count, &bounds);
+
+        const auto chunks = bounds.size() - 1;
+        std::vector<AnalysisSummary> summaries(chunks);
+        std::vector<std::vector<AnalysisReading>> readings(out != nullptr ? chunks : 0);
+
+        this->_pool.run(chunks, [&](const std::size_t i) {
+            this->_analyzeChunk(
+                recs + bounds[i],
+                recs + bounds[i + 1],
+                recs[0].when,
+                &summaries[i],
+                out != nullptr ? &readings[i] : nullptr);
+        });
+
+        _combine(summaries, readings, &total, out);
+
+        return total;
+
+}
+
+AnalysisSummary LogAnalyzer::analyze(
+    const SampleLog& log,
+    std::vector<AnalysisReading>* const out) {
+        return this->analyze(log.begin(), log.size(), out);
+}
+
+AnalysisSummary LogAnalyzer::analyze(
+    const CompressedLog& log,
+    std::vector<AnalysisReading>* const out) {
+
+        AnalysisSummary total;
+        const auto& index = log.getIndex();
+        const auto count = log.size();
+
+        if(count == 0) {
+            return total;
+        }
+
+        //index of each block's first record, and of the end
+        std::vector<std::size_t> starts(index.size() + 1);
+
+        for(std::size_t i = 0; i < index.size(); ++i) {
+            starts[i + 1] = starts[i] + index[i].count;
+        }
+
+        //whole blocks per chunk, about _chunkSize records each
+        std::vector<std::size_t> firstBlocks;
+
+        for(std::size_t b = 0; b < index.size(); ++b) {
+            if(firstBlocks.empty() || starts[b] - starts[firstBlocks.back()] >= this->_chunkSize) {
+                firstBlocks.push_back(b);
+            }
+        }
+
+        firstBlocks.push_back(index.size());
+
+        const auto chunks = firstBlocks.size() - 1;
+        const auto origin = index[0].firstWhen;
+        const auto per = this->_options.samples;
+        const auto length = this->_options.timeout.count();
+
+        std::vector<AnalysisSummary> summaries(chunks);
+        std::vector<std::vector<AnalysisReading>> readings(out != nullptr ? chunks : 0);
+
+        this->_pool.run(chunks, [&](const std::size_t i) {
+
+            /**
+             * Each chunk decodes its own blocks, so only the chunks being
+             * worked on are in memory. Readings need not end on block
+             * boundaries, so a chunk skips the end of a reading begun in
+             * the chunk before, and decodes as far into the next chunk's
+             * blocks as it takes to finish its own last reading.
+             */
+            std::vector<SampleRecord> recs;
+            const auto base = starts[firstBlocks[i]];
+            auto next = firstBlocks[i];
+
+            //decodes up to and including record r, if there is one
+            const auto have = [&](const std::size_t r) -> bool {
+                while(base + recs.size() <= r && next < index.size()) {
+                    const auto n = recs.size();
+                    recs.resize(n + index[next].count);
+                    log.decodeBlock(next, recs.data() + n);
+                    ++next;
+                }
+                return r < base + recs.size();
+            };
+
+            //first record of the first reading beginning at or after
+            //block b
+            const auto boundary = [&](const std::size_t b) -> std::size_t {
+
+                if(b == 0 || b == index.size()) {
+                    return starts[b];
+                }
+
+                if(this->_options.stratType == StrategyType::Samples) {
+                    return std::min(count, (starts[b] + per - 1) / per * per);
+                }
+
+                const auto w = LogScale::window(index[b - 1].lastWhen, origin, length);
+                auto r = starts[b];
+
+                while(have(r) && LogScale::window(recs[r - base].when, origin, length) == w) {
+                    ++r;
+                }
+
+                return r;
+
+            };
+
+            const auto begin = boundary(firstBlocks[i]);
+            const auto end = boundary(firstBlocks[i + 1]);
+
+            if(end > begin) {
+                have(end - 1);
+                this->_analyzeChunk(
+                    recs.data() + (begin - base),
+                    recs.data() + (end - base),
+                    origin,
+                    &summaries[i],
+                    out != nullptr ? &readings[i] : nullptr);
+            }
+
+        });
+
+        _combine(summaries, readings, &total, out);
+
+        return total;
+
+}
+
+std::size_t LogAnalyzer::getThreads() const noexcept {
+    return this->_pool.size();
+}
+
+};
@@ -22,40 +22,19 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdio>
 #include <ostream>
 #include <string>
 #include <stdexcept>
-#include <unordered_map>
 #include "../include/Mass.h"
+#include "../include/MassFormatter.h"
 
 namespace HX711 {
 
-const std::unordered_map<const Mass::Unit, const double> Mass::_RATIOS({
-    { Unit::UG,         1.0 },
-    { Unit::MG,         1000.0 },
-    { Unit::G,          1000000.0 },
-    { Unit::KG,         1000000000.0 },
-    { Unit::TON,        1000000000000.0 },
-    { Unit::IMP_TON,    1016046908800.0 },
-    { Unit::US_TON,     907184740000.0 },
-    { Unit::ST,         6350293180.0 },
-    { Unit::LB,         453592370.0 },
-    { Unit::OZ,         28349523.125 }
-});
-
-const std::unordered_map<const Mass::Unit, const char* const> Mass::_UNIT_NAMES({
-    { Unit::UG,         "μg" },
-    { Unit::MG,         "mg" },
-    { Unit::G,          "g" },
-    { Unit::KG,         "kg" },
-    { Unit::TON,        "ton" },
-    { Unit::IMP_TON,    "ton (IMP)" },
-    { Unit::US_TON,     "ton (US)" },
-    { Unit::ST,         "st" },
-    { Unit::LB,         "lb" },
-    { Unit::OZ,         "oz" }
-});
+constexpr double Mass::_RATIOS[];
+constexpr double Mass::_RATIO_MATRIX[][Mass::_UNIT_COUNT];
+constexpr const char* const Mass::_UNIT_NAMES[];
 
 Mass::Mass(const double amount, const Unit u) noexcept
     :   _ug(convert(amount, u, Unit::UG)),
@@ -67,6 +46,13 @@ Mass::Mass(const Mass& m2) noexcept
         _u(m2._u) {
 }
 
+Mass Mass::_fromMicrograms(const double ug, const Unit u) noexcept {
+    Mass m;
+    m._ug = ug;
+    m._u = u;
+    return m;
+}
+
 Mass& Mass::operator=(const Mass& rhs) noexcept {
     this->_ug = rhs._ug;
     this->_u = rhs._u;
@@ -94,25 +80,25 @@ void Mass::setUnit(const Unit u) noexcept {
 }
 
 Mass Mass::convertTo(const Unit to) const noexcept {
-    return Mass(this->_ug, to);
+    return _fromMicrograms(this->_ug, to);
 }
 
 Mass operator+(const Mass& lhs, const Mass& rhs) noexcept {
-    return Mass(
+    return Mass::_fromMicrograms(
         lhs._ug + rhs._ug,
         lhs._u
     );
 }
 
 Mass operator-(const Mass& lhs, const Mass& rhs) noexcept {
-    return Mass(
+    return Mass::_fromMicrograms(
         lhs._ug - rhs._ug,
         lhs._u
     );
 }
 
 Mass operator*(const Mass& lhs, const Mass& rhs) noexcept {
-    return Mass(
+    return Mass::_fromMicrograms(
         lhs._ug * rhs._ug,
         lhs._u
     );
@@ -124,7 +110,7 @@ Mass operator/(const Mass& lhs, const Mass& rhs) {
         throw std::invalid_argument("cannot divide by 0");
     }
     
-    return Mass(
+    return Mass::_fromMicrograms(
         lhs._ug / rhs._ug,
         lhs._u
     );
@@ -232,7 +218,7 @@ std::string Mass::toString(const Unit u) const noexcept {
         "%01.*f %s",
         d,                  //number of decimals
         n,                  //number to output
-        _UNIT_NAMES.at(u)   //unit name
+        getUnitName(u)      //unit name
         );
 
     //std::string will automatically limit chars to first \0
@@ -242,7 +228,9 @@ std::string Mass::toString(const Unit u) const noexcept {
 }
 
 std::ostream& operator<<(std::ostream& os, const Mass& m) noexcept {
-    os << m.toString();
+    char buff[MassFormatter::MAX_LENGTH];
+    const auto len = MassFormatter::format(buff, m);
+    os.write(buff, static_cast<std::streamsize>(len));
     return os;
 }
 
@@ -250,21 +238,11 @@ double Mass::convert(
     const double amount,
     const Unit from,
     const Unit to) noexcept {
+        return amount * ratio(from, to);
+}
 
-        if(from == to) {
-            return amount;
-        }
-
-        if(to == Unit::UG) {
-            return amount * _RATIOS.at(from);
-        }
-        
-        if(from == Unit::UG) {
-            return amount / _RATIOS.at(to);
-        }
-
-        return convert(amount, to, Unit::UG);
-
+const char* Mass::getUnitName(const Unit u) noexcept {
+    return _UNIT_NAMES[static_cast<std::size_t>(u)];
 }
 
 };
\ No newline at end of file
@@ -0,0 +1,298 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "../include/Mass.h"
+#include "../include/MassFormatter.h"
+#include "../include/Utility.h"
+
+namespace HX711 {
+
+/**
+ * _DECIMAL_THRESHOLDS[d] is the smallest fractional part (exclusive)
+ * which is displayed with d decimals. Index 0 is unused.
+ */
+const double MassFormatter::_DECIMAL_THRESHOLDS[] = {
+    1.0,
+    1e-1,
+    1e-2,
+    1e-3,
+    1e-4,
+    1e-5,
+    1e-6,
+    1e-7,
+    1e-8,
+    1e-9
+};
+
+constexpr double MassFormatter::_MAX_FAST_SCALED;
+constexpr double MassFormatter::_EPSILON;
+constexpr double MassFormatter::_THRESHOLD_TOLERANCE;
+
+const std::uint64_t MassFormatter::_POW10[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL
+};
+
+const std::size_t MassFormatter::_UNIT_NAME_LENGTHS[] = {
+    std::strlen(Mass::getUnitName(Mass::Unit::UG)),
+    std::strlen(Mass::getUnitName(Mass::Unit::MG)),
+    std::strlen(Mass::getUnitName(Mass::Unit::G)),
+    std::strlen(Mass::getUnitName(Mass::Unit::KG)),
+    std::strlen(Mass::getUnitName(Mass::Unit::TON)),
+    std::strlen(Mass::getUnitName(Mass::Unit::IMP_TON)),
+    std::strlen(Mass::getUnitName(Mass::Unit::US_TON)),
+    std::strlen(Mass::getUnitName(Mass::Unit::ST)),
+    std::strlen(Mass::getUnitName(Mass::Unit::LB)),
+    std::strlen(Mass::getUnitName(Mass::Unit::OZ))
+};
+
+std::uint64_t MassFormatter::_roundHalfEven(
+    const double a,
+    const double b,
+    const double product) noexcept {
+
+        /**
+         * snprintf rounds the exact binary value of a number to the
+         * nearest decimal, with ties to even. product is a * b rounded
+         * to a double, so its fractional part can be off by up to half
+         * an ulp. That only matters when the fraction is very close to
+         * 0.5. In that case the rounding error is recovered exactly
+         * with an fma and used to break the tie.
+         */
+        const double whole = std::floor(product);
+        const double t = (product - whole) - 0.5;
+        auto rv = static_cast<std::uint64_t>(whole);
+
+        if(std::abs(t) > product * _EPSILON) {
+            return t > 0 ? rv + 1 : rv;
+        }
+
+        const double err = std::fma(a, b, -product);
+
+        if(t > -err) {
+            return rv + 1;
+        }
+
+        if(t < -err) {
+            return rv;
+        }
+
+        return rv + (rv & 1);
+
+}
+
+std::size_t MassFormatter::_formatSlow(
+    char* const buff,
+    const std::size_t len,
+    const double n,
+    const int decimals,
+    const Mass::Unit u) noexcept {
+
+        const int written = ::snprintf(
+            buff,
+            len,
+            "%01.*f %s",
+            decimals,
+            n,
+            Mass::getUnitName(u));
+
+        if(written < 0 || static_cast<std::size_t>(written) >= len) {
+            if(len > 0) {
+                buff[0] = '\0';
+            }
+            return 0;
+        }
+
+        return static_cast<std::size_t>(written);
+
+}
+
+int MassFormatter::decimals(const double n) noexcept {
+
+    double i; //integer leftover from modf; don't use
+    const double f = std::abs(std::modf(n, &i));
+
+    if(f == 0 || !std::isfinite(f)) {
+        return 0;
+    }
+
+    for(int d = 1; d <= _MAX_FAST_DECIMALS; ++d) {
+        if(f > _DECIMAL_THRESHOLDS[d]) {
+
+            //log10 may round a fraction just above a power of 10 down
+            //onto it, so defer to the same calculation as toString
+            if(f < _DECIMAL_THRESHOLDS[d] * _THRESHOLD_TOLERANCE) {
+                break;
+            }
+
+            return d;
+
+        }
+    }
+
+    //same calculation as Mass::toString
+    return std::max(0, static_cast<int>(1 - std::log10(f)));
+
+}
+
+std::size_t MassFormatter::format(
+    char* const buff,
+    const std::size_t len,
+    const double amount,
+    const Mass::Unit u) noexcept {
+
+        const int d = decimals(amount);
+        const double scaled = std::abs(amount) * static_cast<double>(
+            _POW10[std::min(d, _MAX_FAST_DECIMALS)]);
+
+        /**
+         * Anything which cannot be exactly split into whole and
+         * fractional parts as a double (including inf and nan) is left
+         * to snprintf
+         */
+        if(d > _MAX_FAST_DECIMALS || !(scaled < _MAX_FAST_SCALED)) {
+            return _formatSlow(buff, len, amount, d, u);
+        }
+
+        const auto fixed = _roundHalfEven(
+            std::abs(amount),
+            static_cast<double>(_POW10[d]),
+            scaled);
+
+        char num[MAX_LENGTH];
+        char* const end = num + MAX_LENGTH;
+        char* p = end;
+
+        auto whole = fixed;
+
+        if(d > 0) {
+
+            auto frac = whole % _POW10[d];
+            whole /= _POW10[d];
+
+            for(int i = 0; i < d; ++i) {
+                *--p = static_cast<char>('0' + frac % 10);
+                frac /= 10;
+            }
+
+            *--p = '.';
+
+        }
+
+        p = Utility::writeUint(p, whole);
+
+        if(std::signbit(amount)) {
+            *--p = '-';
+        }
+
+        const auto numLen = static_cast<std::size_t>(end - p);
+        const auto nameLen = _UNIT_NAME_LENGTHS[static_cast<std::size_t>(u)];
+        const auto total = numLen + 1 + nameLen;
+
+        if(total >= len) {
+            if(len > 0) {
+                buff[0] = '\0';
+            }
+            return 0;
+        }
+
+        std::memcpy(buff, p, numLen);
+        buff[numLen] = ' ';
+        std::memcpy(buff + numLen + 1, Mass::getUnitName(u), nameLen);
+        buff[total] = '\0';
+
+        return total;
+
+}
+
+std::size_t MassFormatter::format(
+    char* const buff,
+    const std::size_t len,
+    const Mass& m) noexcept {
+        return format(buff, len, m.getValue(), m.getUnit());
+}
+
+std::size_t MassFormatter::format(
+    char* const buff,
+    const std::size_t len,
+    const Mass& m,
+    const Mass::Unit u) noexcept {
+        return format(buff, len, m.getValue(u), u);
+}
+
+std::size_t MassFormatter::formatAll(
+    char* const buff,
+    const std::size_t len,
+    const Mass& m,
+    const char sep) noexcept {
+
+        const double ug = m.getValue(Mass::Unit::UG);
+        std::size_t pos = 0;
+
+        for(std::size_t i = 0; i < _UNIT_COUNT; ++i) {
+
+            const auto u = static_cast<Mass::Unit>(i);
+
+            if(i > 0) {
+                if(pos + 1 >= len) {
+                    buff[0] = '\0';
+                    return 0;
+                }
+                buff[pos++] = sep;
+            }
+
+            const auto n = format(
+                buff + pos,
+                len - pos,
+                ug * Mass::ratio(Mass::Unit::UG, u),
+                u);
+
+            if(n == 0) {
+                if(len > 0) {
+                    buff[0] = '\0';
+                }
+                return 0;
+            }
+
+            pos += n;
+
+        }
+
+        return pos;
+
+}
+
+};
@@ -0,0 +1,190 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/LatencyHistogram.h"
+#include "../include/Metrics.h"
+
+namespace HX711 {
+
+ScaleMetrics::ScaleMetrics(const int dataPin, const int clockPin) noexcept :
+    dataPin(dataPin),
+    clockPin(clockPin),
+    values(0),
+    missed(0),
+    dropped(0),
+    integrityFailures(0),
+    gpioErrors(0),
+    watcherCpuNanos(0),
+    weight(std::numeric_limits<double>::quiet_NaN()),
+    waitReadyLatency(nullptr),
+    readValueLatency(nullptr) {
+}
+
+MetricsRegistry* MetricsRegistry::getInstance() noexcept {
+    static MetricsRegistry instance;
+    return &instance;
+}
+
+void MetricsRegistry::add(const ScaleMetrics* const m) noexcept {
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+
+    //metrics are a diagnostic; never fail a scale for want of memory
+    try {
+        this->_scales.push_back(m);
+    }
+    catch(...) {
+    }
+
+}
+
+void MetricsRegistry::remove(const ScaleMetrics* const m) noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_scales.erase(
+        std::remove(this->_scales.begin(), this->_scales.end(), m),
+        this->_scales.end());
+}
+
+std::size_t MetricsRegistry::size() const noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    return this->_scales.size();
+}
+
+std::string MetricsRegistry::toPrometheus() const {
+
+    struct Counter {
+        const char* name;
+        const char* help;
+        const char* type;
+        double (*get)(const ScaleMetrics& m);
+    };
+
+    static const Counter counters[] = {
+        { "hx711_values_total", "Values read from the chip.", "counter",
+            [](const ScaleMetrics& m) -> double { return m.values.load(std::memory_order_relaxed); } },
+        { "hx711_missed_conversions_total", "Conversions not read before the next was ready.", "counter",
+            [](const ScaleMetrics& m) -> double { return m.missed.load(std::memory_order_relaxed); } },
+        { "hx711_dropped_values_total", "Values read but discarded before being consumed.", "counter",
+            [](const ScaleMetrics& m) -> double { return m.dropped.load(std::memory_order_relaxed); } },
+        { "hx711_integrity_failures_total", "Reads which failed strict timing.", "counter",
+            [](const ScaleMetrics& m) -> double { return m.integrityFailures.load(std::memory_order_relaxed); } },
+        { "hx711_gpio_errors_total", "GPIO errors while polling or reading.", "counter",
+            [](const ScaleMetrics& m) -> double { return m.gpioErrors.load(std::memory_order_relaxed); } },
+        { "hx711_watcher_cpu_seconds_total", "CPU time used by the watcher thread.", "counter",
+            [](const ScaleMetrics& m) -> double { return m.watcherCpuNanos.load(std::memory_order_relaxed) / 1e9; } },
+        { "hx711_weight_grams", "Latest weight.", "gauge",
+            [](const ScaleMetrics& m) -> double { return m.weight.load(std::memory_order_relaxed); } }
+    };
+
+    struct Latency {
+        const char* name;
+        const char* help;
+        const LatencyHistogram* ScaleMetrics::*hist;
+    };
+
+    static const Latency latencies[] = {
+        { "hx711_wait_ready_seconds", "Time spent waiting for the chip to be ready.",
+            &ScaleMetrics::waitReadyLatency },
+        { "hx711_read_value_seconds", "Time taken to clock out a value.",
+            &ScaleMetrics::readValueLatency }
+    };
+
+    static const double quantiles[] = { 0.5, 0.9, 0.99, 1.0 };
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+    std::ostringstream os;
+
+    os << std::setprecision(std::numeric_limits<double>::digits10);
+
+    const auto labels = [&os](const ScaleMetrics& m) {
+        os << "data_pin=\"" << m.dataPin << "\",clock_pin=\"" << m.clockPin << "\"";
+    };
+
+    for(const auto& c : counters) {
+
+        os  << "# HELP " << c.name << " " << c.help << "\n"
+            << "# TYPE " << c.name << " " << c.type << "\n";
+
+        for(const auto m : this->_scales) {
+
+            const double v = c.get(*m);
+
+            //an absent sample is clearer to a scraper than NaN
+            if(std::isnan(v)) {
+                continue;
+            }
+
+            os << c.name << "{";
+            labels(*m);
+            os << "} " << v << "\n";
+
+        }
+
+    }
+
+    for(const auto& l : latencies) {
+
+        os  << "# HELP " << l.name << " " << l.help << "\n"
+            << "# TYPE " << l.name << " summary\n";
+
+        for(const auto m : this->_scales) {
+
+            const LatencyHistogram* const h = m->*l.hist;
+
+            if(h == nullptr) {
+                continue;
+            }
+
+            for(const double q : quantiles) {
+                os << l.name << "{";
+                labels(*m);
+                os << ",quantile=\"" << q << "\"} " << h->getPercentile(q).count() / 1e9 << "\n";
+            }
+
+            os << l.name << "_sum{";
+            labels(*m);
+            os << "} " << h->getSum().count() / 1e9 << "\n";
+
+            os << l.name << "_count{";
+            labels(*m);
+            os << "} " << h->getCount() << "\n";
+
+        }
+
+    }
+
+    return os.str();
+
+}
+
+};
@@ -0,0 +1,293 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include "../include/Metrics.h"
+#include "../include/MetricsExporter.h"
+#include "../include/SystemClock.h"
+#include "../include/Utility.h"
+
+namespace HX711 {
+
+constexpr std::chrono::nanoseconds MetricsExporter::_DEFAULT_INTERVAL;
+constexpr std::chrono::milliseconds MetricsExporter::_REQUEST_WAIT;
+constexpr std::chrono::milliseconds MetricsExporter::_SEND_TIMEOUT;
+constexpr std::chrono::milliseconds MetricsExporter::_STOP_CHECK;
+
+static bool writeAll(const int fd, const std::string& s) noexcept {
+
+    std::size_t off = 0;
+
+    while(off < s.size()) {
+
+        const ssize_t n = ::write(fd, s.data() + off, s.size() - off);
+
+        if(n <= 0) {
+            if(n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        off += static_cast<std::size_t>(n);
+
+    }
+
+    return true;
+
+}
+
+void MetricsExporter::_listen() {
+
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if(this->_path.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("socket path too long");
+    }
+
+    std::strncpy(addr.sun_path, this->_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    this->_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if(this->_fd < 0) {
+        throw std::runtime_error("unable to create metrics socket");
+    }
+
+    //a stale socket from a previous run would make bind fail
+    ::unlink(this->_path.c_str());
+
+    if( ::bind(this->_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(this->_fd, 8) != 0) {
+            ::close(this->_fd);
+            this->_fd = -1;
+            throw std::runtime_error("unable to listen on metrics socket");
+    }
+
+}
+
+bool MetricsExporter::_writeFile() noexcept {
+
+    const std::string tmp = this->_path + ".tmp";
+
+    const int fd = ::open(
+        tmp.c_str(),
+        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+        0644);
+
+    if(fd < 0) {
+        return false;
+    }
+
+    bool ok;
+
+    try {
+        ok = writeAll(fd, this->_registry->toPrometheus());
+    }
+    catch(...) {
+        ok = false;
+    }
+
+    ok = ::close(fd) == 0 && ok;
+
+    //rename is atomic, so readers see the old or the new file
+    if(!ok || ::rename(tmp.c_str(), this->_path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+
+    return true;
+
+}
+
+bool MetricsExporter::_serve(const int client) noexcept {
+
+    //give an HTTP client a moment to send its request; anything which
+    //does not is assumed to just want the text (eg. socat, nc -U)
+    pollfd p;
+    p.fd = client;
+    p.events = POLLIN;
+    p.revents = 0;
+
+    bool http = false;
+
+    if(::poll(&p, 1, static_cast<int>(_REQUEST_WAIT.count())) > 0) {
+
+        char buff[512];
+        const ssize_t n = ::recv(client, buff, sizeof(buff), 0);
+
+        http = n >= 4 && std::strncmp(buff, "GET ", 4) == 0;
+
+    }
+
+    try {
+
+        const std::string body = this->_registry->toPrometheus();
+
+        const std::string head = !http ? std::string() :
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n";
+
+        iovec iov[2];
+        iov[0].iov_base = const_cast<char*>(head.data());
+        iov[0].iov_len = head.size();
+        iov[1].iov_base = const_cast<char*>(body.data());
+        iov[1].iov_len = body.size();
+
+        //one client is served at a time, so one which stops reading
+        //must not hold up the rest
+        return Utility::sendAll(client, iov, 2, _SEND_TIMEOUT);
+
+    }
+    catch(...) {
+        return false;
+    }
+
+}
+
+void MetricsExporter::_fileLoop() noexcept {
+
+    while(this->_running.load(std::memory_order_acquire)) {
+
+        if(this->_writeFile()) {
+            this->_exports.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            this->_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        //I/O pacing, so always real time even with a VirtualClock;
+        //sliced so the destructor is not held up by a long interval
+        const auto clock = SystemClock::getInstance();
+        const auto until = clock->now() + this->_interval;
+
+        while(this->_running.load(std::memory_order_acquire)) {
+            const auto now = clock->now();
+            if(now >= until) {
+                break;
+            }
+            clock->sleep(std::min<std::chrono::nanoseconds>(until - now, _STOP_CHECK));
+        }
+
+    }
+
+}
+
+void MetricsExporter::_socketLoop() noexcept {
+
+    while(this->_running.load(std::memory_order_acquire)) {
+
+        pollfd p;
+        p.fd = this->_fd;
+        p.events = POLLIN;
+        p.revents = 0;
+
+        if(::poll(&p, 1, static_cast<int>(_STOP_CHECK.count())) <= 0) {
+            continue;
+        }
+
+        const int client = ::accept4(this->_fd, nullptr, nullptr, SOCK_CLOEXEC);
+
+        if(client < 0) {
+            continue;
+        }
+
+        if(this->_serve(client)) {
+            this->_exports.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            this->_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ::close(client);
+
+    }
+
+}
+
+MetricsExporter::MetricsExporter(
+    const std::string& path,
+    const MetricsExportMode mode,
+    const std::chrono::nanoseconds interval,
+    const MetricsRegistry* const registry) :
+        _path(path),
+        _mode(mode),
+        _interval(interval),
+        _registry(registry),
+        _fd(-1),
+        _running(true),
+        _exports(0),
+        _errors(0) {
+
+            if(this->_registry == nullptr) {
+                throw std::invalid_argument("registry cannot be null");
+            }
+
+            if(this->_mode == MetricsExportMode::SOCKET) {
+                this->_listen();
+                this->_thread = std::thread(&MetricsExporter::_socketLoop, this);
+            }
+            else {
+                this->_thread = std::thread(&MetricsExporter::_fileLoop, this);
+            }
+
+}
+
+MetricsExporter::~MetricsExporter() {
+
+    this->_running.store(false, std::memory_order_release);
+    this->_thread.join();
+
+    if(this->_fd >= 0) {
+        ::close(this->_fd);
+        ::unlink(this->_path.c_str());
+    }
+
+}
+
+std::uint64_t MetricsExporter::getExports() const noexcept {
+    return this->_exports.load(std::memory_order_relaxed);
+}
+
+std::uint64_t MetricsExporter::getErrors() const noexcept {
+    return this->_errors.load(std::memory_order_relaxed);
+}
+
+};
@@ -0,0 +1,638 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../include/common.h"
+
+using namespace HX711;
+
+/**
+ * Microbenchmarks for the library's hot paths
+ * 
+ * Usage: hx711microbench [--format text|json|csv] [--filter name]
+ *                        [--output file] [--perf]
+ * 
+ * Each benchmark is run _REPEATS times after a warm up, and the median,
+ * min, and max ns per operation are reported. Benchmarks which talk to
+ * a chip use an in-process VirtualChip, so no hardware is needed and the
+ * numbers reflect the library's own overhead.
+ * 
+ * --perf adds hardware and software counters per op (see PerfCounters)
+ * for whichever counters the system allows.
+ */
+
+//prevents the compiler from discarding benchmarked work
+static volatile std::size_t sink;
+
+static const std::size_t _REPEATS = 5;
+
+struct Result {
+    std::string name;
+    std::size_t iterations;
+    double median;
+    double min;
+    double max;
+
+    //for accuracy benchmarks, the intended ns/op; otherwise 0
+    double target;
+
+    //counters per op over all repeats, indexed by PerfCounter;
+    //negative if not measured
+    double perf[PerfSample::COUNTERS];
+};
+
+enum class OutputFormat : unsigned char {
+    TEXT,
+    JSON,
+    CSV
+};
+
+static std::vector<Result> results;
+static OutputFormat format = OutputFormat::TEXT;
+static const char* filter = nullptr;
+static PerfCounters* perf = nullptr;
+
+/**
+ * A chip which always has a conversion ready, so reads never wait
+ */
+class BenchChip : public VirtualChip {
+protected:
+    std::uint32_t _next = 0;
+
+    virtual bool _nextConversion(
+        const std::chrono::nanoseconds now,
+        std::uint32_t* const v) override {
+            (void)now;
+            *v = ++this->_next;
+            return true;
+    }
+};
+
+/**
+ * Exposes HX711's bit-level read for benchmarking
+ */
+class BenchHX711 : public HX711::HX711 {
+public:
+    using HX711::HX711;
+    bool readBit() { return this->_readBit(); }
+};
+
+template <typename F>
+static void run(
+    const std::string& name,
+    const std::size_t iterations,
+    F fn,
+    const double target = 0) {
+
+        using namespace std::chrono;
+
+        if(filter != nullptr && name.find(filter) == std::string::npos) {
+            return;
+        }
+
+        //warm up caches and branch predictors
+        for(std::size_t i = 0; i < iterations / 10; ++i) {
+            fn(i);
+        }
+
+        std::vector<double> perOp;
+        perOp.reserve(_REPEATS);
+
+        PerfSample perfStart;
+        PerfSample perfEnd;
+
+        if(perf != nullptr) {
+            perf->read(&perfStart);
+        }
+
+        for(std::size_t r = 0; r < _REPEATS; ++r) {
+
+            const auto start = steady_clock::now();
+
+            for(std::size_t i = 0; i < iterations; ++i) {
+                fn(i);
+            }
+
+            const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start);
+            perOp.push_back(static_cast<double>(elapsed.count()) / iterations);
+
+        }
+
+        if(perf != nullptr) {
+            perf->read(&perfEnd);
+        }
+
+        std::sort(perOp.begin(), perOp.end());
+
+        Result res;
+        res.name = name;
+        res.iterations = iterations;
+        res.median = perOp[perOp.size() / 2];
+        res.min = perOp.front();
+        res.max = perOp.back();
+        res.target = target;
+
+        for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+            res.perf[c] = perf != nullptr && perf->isAvailable(static_cast<PerfCounter>(c)) ?
+                static_cast<double>(perfEnd.values[c] - perfStart.values[c]) / (iterations * _REPEATS) :
+                -1;
+        }
+
+        results.push_back(res);
+
+        //text is printed as it goes, as some benchmarks take a while
+        if(format == OutputFormat::TEXT) {
+            std::cout   << std::left << std::setw(44) << res.name
+                        << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+                        << res.median << " ns/op"
+                        << "  (min " << res.min << ", max " << res.max << ")";
+
+            for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+                if(res.perf[c] >= 0) {
+                    std::cout   << "  " << PerfCounters::getName(static_cast<PerfCounter>(c))
+                                << " " << std::setprecision(2) << res.perf[c];
+                }
+            }
+
+            std::cout << std::endl;
+        }
+
+}
+
+static std::string jsonEscape(const std::string& s) {
+
+    std::string out;
+    out.reserve(s.size());
+
+    for(const char c : s) {
+        if(c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+
+    return out;
+
+}
+
+static void writeJson(std::ostream& os, const std::time_t when) {
+
+    os  << "{\n"
+        << "  \"version\": \"" << Utility::getVersion() << "\",\n"
+        << "  \"timestamp\": " << when << ",\n"
+        << "  \"repeats\": " << _REPEATS << ",\n"
+        << "  \"results\": [\n";
+
+    os << std::fixed << std::setprecision(1);
+
+    for(std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os  << "    {\"name\": \"" << jsonEscape(r.name) << "\""
+            << ", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << r.median
+            << ", \"min_ns\": " << r.min
+            << ", \"max_ns\": " << r.max
+            << ", \"target_ns\": " << r.target;
+
+        for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+            if(r.perf[c] >= 0) {
+                os  << ", \"" << PerfCounters::getName(static_cast<PerfCounter>(c))
+                    << "_per_op\": " << std::setprecision(3) << r.perf[c] << std::setprecision(1);
+            }
+        }
+
+        os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    os << "  ]\n}\n";
+
+}
+
+static void writeCsv(std::ostream& os, const std::time_t when) {
+
+    os << "version,timestamp,name,iterations,ns_per_op,min_ns,max_ns,target_ns";
+
+    //empty where not measured
+    for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+        os << "," << PerfCounters::getName(static_cast<PerfCounter>(c)) << "_per_op";
+    }
+
+    os << "\n";
+    os << std::fixed << std::setprecision(1);
+
+    for(const Result& r : results) {
+        os  << Utility::getVersion() << ","
+            << when << ","
+            << "\"" << r.name << "\","
+            << r.iterations << ","
+            << r.median << ","
+            << r.min << ","
+            << r.max << ","
+            << r.target;
+
+        for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+            os << ",";
+            if(r.perf[c] >= 0) {
+                os << std::setprecision(3) << r.perf[c] << std::setprecision(1);
+            }
+        }
+
+        os << "\n";
+    }
+
+}
+
+static void benchChip() {
+
+    BenchChip chip;
+    BenchHX711 hx(0, 1, Rate::OTHER, &chip);
+    hx.connect();
+
+    run("HX711::_readBit", 1000000, [&hx](std::size_t) {
+        sink = hx.readBit();
+    });
+
+    run("HX711::readValue", 50000, [&hx](std::size_t) {
+        sink = static_cast<std::size_t>(hx.readValue());
+    });
+
+    run("HX711::isReady", 1000000, [&hx](std::size_t) {
+        sink = hx.isReady();
+    });
+
+    BenchChip scaleChip;
+    SimpleHX711 scale(0, 1, -370, -367471, Rate::OTHER, &scaleChip);
+
+    run("AbstractScale::read (3 samples)", 20000, [&scale](std::size_t) {
+        sink = static_cast<std::size_t>(scale.read(Options(3)));
+    });
+
+    run("AbstractScale::weight (3 samples)", 20000, [&scale](std::size_t) {
+        sink = static_cast<std::size_t>(scale.weight(3).getValue());
+    });
+
+    run("AbstractScale::read (15 samples, avg)", 5000, [&scale](std::size_t) {
+        sink = static_cast<std::size_t>(scale.read(Options(15, ReadType::Average)));
+    });
+
+}
+
+static void benchDelay() {
+
+    using namespace std::chrono;
+
+    const struct {
+        nanoseconds ns;
+        std::size_t iterations;
+        const char* name;
+    } delays[] = {
+        { nanoseconds(100), 100000, "Utility::delay 100ns" },
+        { microseconds(1), 50000, "Utility::delay 1us" },
+        { microseconds(10), 10000, "Utility::delay 10us" },
+        { microseconds(100), 1000, "Utility::delay 100us" }
+    };
+
+    for(const auto& d : delays) {
+        const auto ns = d.ns;
+        run(d.name, d.iterations, [ns](std::size_t) {
+            Utility::delay(ns);
+        }, static_cast<double>(ns.count()));
+    }
+
+    run("Utility::getnanos", 1000000, [](std::size_t) {
+        sink = static_cast<std::size_t>(Utility::getnanos().count());
+    });
+
+}
+
+static void benchStats() {
+
+    const std::size_t counts[] = { 3, 15, 80, 1000 };
+
+    for(const auto n : counts) {
+
+        //deterministic pseudo-random samples
+        std::vector<Value> vals;
+        std::uint32_t x = 12345;
+
+        for(std::size_t i = 0; i < n; ++i) {
+            x = x * 1103515245u + 12345u;
+            vals.push_back(Value(static_cast<val_t>(x >> 8) - 0x800000));
+        }
+
+        const std::size_t iterations = 2000000 / n + 1000;
+        const std::string suffix = " (n=" + std::to_string(n) + ")";
+
+        run("Utility::average" + suffix, iterations, [&vals](std::size_t) {
+            sink = static_cast<std::size_t>(Utility::average(&vals));
+        });
+
+        //median reorders its input, so each iteration works on a copy
+        run("Utility::median (incl. copy)" + suffix, iterations, [&vals](std::size_t) {
+            std::vector<Value> copy(vals);
+            sink = static_cast<std::size_t>(Utility::median(&copy));
+        });
+
+        run("std::vector copy (median baseline)" + suffix, iterations, [&vals](std::size_t) {
+            std::vector<Value> copy(vals);
+            sink = copy.size();
+        });
+
+    }
+
+}
+
+static void benchValueStack() {
+
+    ValueStack vs;
+
+    run("ValueStack::push", 200000, [&vs](std::size_t i) {
+        vs.push(Value(static_cast<val_t>(i)));
+    });
+
+    run("ValueStack::push + pop", 200000, [&vs](std::size_t i) {
+        vs.push(Value(static_cast<val_t>(i)));
+        sink = static_cast<std::size_t>(vs.pop());
+    });
+
+}
+
+static void benchLatencyHistogram() {
+
+    LatencyHistogram h;
+
+    run("LatencyHistogram::record", 5000000, [&h](std::size_t i) {
+        h.record(std::chrono::nanoseconds(i & 0xfffff));
+    });
+
+    run("LatencyHistogram::getPercentile", 20000, [&h](std::size_t) {
+        sink = static_cast<std::size_t>(h.getPercentile(0.99).count());
+    });
+
+}
+
+static void benchRollupAggregator() {
+
+    RollupAggregator agg;
+    RollupStats stats;
+
+    //80Hz samples; two resolutions are updated per push
+    run("RollupAggregator::push", 2000000, [&agg](std::size_t i) {
+        agg.push(
+            Value(static_cast<val_t>(i & 0xffff)),
+            std::chrono::nanoseconds(static_cast<std::int64_t>(i) * 12500000));
+    });
+
+    run("RollupAggregator::get", 2000000, [&agg, &stats](std::size_t i) {
+        agg.get(i & 1, 0, &stats);
+        sink = static_cast<std::size_t>(stats.count);
+    });
+
+}
+
+static void benchQuantileSketch() {
+
+    QuantileSketch q;
+    const double qs[] = { 0.01, 0.5, 0.99 };
+    double out[3];
+
+    run("QuantileSketch::add", 2000000, [&q](std::size_t i) {
+        q.add(static_cast<double>((i * 2654435761u) & 0xffff));
+    });
+
+    run("QuantileSketch::quantiles (p1/p50/p99)", 20000, [&q, &qs, &out](std::size_t) {
+        q.quantiles(qs, 3, out);
+        sink = static_cast<std::size_t>(out[1]);
+    });
+
+}
+
+static void benchMass() {
+
+    const std::size_t iterations = 200000;
+    const Mass m(1234.5678, Mass::Unit::G);
+
+    run("Mass::convert", 5000000, [](std::size_t i) {
+        sink = static_cast<std::size_t>(Mass::convert(
+            static_cast<double>(i),
+            static_cast<Mass::Unit>(i % 10),
+            Mass::Unit::G));
+    });
+
+    run("Mass::toString", iterations, [&m](std::size_t) {
+        sink = m.toString().size();
+    });
+
+    run("MassFormatter::format", iterations, [&m](std::size_t) {
+        char buff[MassFormatter::MAX_LENGTH];
+        sink = MassFormatter::format(buff, m);
+    });
+
+    run("Mass::toString (all units)", iterations, [&m](std::size_t) {
+        std::size_t n = 0;
+        for(std::size_t u = 0; u < 10; ++u) {
+            n += m.toString(static_cast<Mass::Unit>(u)).size();
+        }
+        sink = n;
+    });
+
+    run("MassFormatter::formatAll", iterations, [&m](std::size_t) {
+        char buff[MassFormatter::MAX_ALL_LENGTH];
+        sink = MassFormatter::formatAll(buff, sizeof(buff), m);
+    });
+
+    //exporting to /dev/null measures formatting and buffering only
+    const int fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    if(fd >= 0) {
+
+        SampleExporter csv(fd, ExportFormat::CSV, -370, -367471, 1700000000000000000);
+        SampleExporter jsonl(fd, ExportFormat::JSONL, -370, -367471, 1700000000000000000);
+        SampleRecord r;
+        r.flags = 0;
+
+        run("SampleExporter::append (csv)", 2000000, [&csv, &r](std::size_t i) {
+            r.when = static_cast<std::int64_t>(i) * 12500000;
+            r.value = static_cast<val_t>(i & 0xffff);
+            csv.append(r);
+        });
+
+        run("SampleExporter::append (jsonl)", 2000000, [&jsonl, &r](std::size_t i) {
+            r.when = static_cast<std::int64_t>(i) * 12500000;
+            r.value = static_cast<val_t>(i & 0xffff);
+            jsonl.append(r);
+        });
+
+        csv.flush();
+        jsonl.flush();
+        ::close(fd);
+
+    }
+
+}
+
+static void benchCompressedLog() {
+
+    //one block of 80Hz samples with clock jitter and a noisy signal
+    const std::size_t count = 1024;
+    std::vector<SampleRecord> recs(count);
+    std::mt19937 rng(1);
+    std::normal_distribution<double> jitter(0, 20000);
+    std::normal_distribution<double> noise(0, 40);
+    std::int64_t when = 0;
+    double value = 100000;
+
+    for(auto& r : recs) {
+        when += 12500000 + static_cast<std::int64_t>(jitter(rng));
+        value += noise(rng);
+        r.when = when;
+        r.value = static_cast<val_t>(value);
+        r.flags = 0;
+    }
+
+    std::vector<std::uint8_t> block;
+    CompressedBlock::encode(recs.data(), count, 1000, &block);
+
+    CompressedBlockHeader h;
+    std::memcpy(&h, block.data(), sizeof(h));
+
+    //ops are whole blocks; divide by count for ns per sample
+    run("CompressedBlock::encode (1024)", 20000, [&recs, &block](std::size_t) {
+        CompressedBlock::encode(recs.data(), recs.size(), 1000, &block);
+        sink = block.size();
+    });
+
+    CompressedBlock::encode(recs.data(), count, 1000, &block);
+
+    run("CompressedBlock::decode (1024)", 20000, [&recs, &block, &h](std::size_t) {
+        CompressedBlock::decode(h, block.data() + sizeof(h), 1000, recs.data());
+        sink = static_cast<std::size_t>(recs.back().value);
+    });
+
+}
+
+int main(int argc, char** argv) {
+
+    const char* output = nullptr;
+    bool usePerf = false;
+
+    for(int i = 1; i < argc; ++i) {
+
+        const bool hasValue = i + 1 < argc;
+
+        if(std::strcmp(argv[i], "--format") == 0 && hasValue) {
+            const char* const f = argv[++i];
+            if(std::strcmp(f, "json") == 0) {
+                format = OutputFormat::JSON;
+            }
+            else if(std::strcmp(f, "csv") == 0) {
+                format = OutputFormat::CSV;
+            }
+            else if(std::strcmp(f, "text") == 0) {
+                format = OutputFormat::TEXT;
+            }
+            else {
+                std::cerr << "unknown format: " << f << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--output") == 0 && hasValue) {
+            output = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--perf") == 0) {
+            usePerf = true;
+        }
+        else {
+            std::cerr   << "Usage: " << argv[0]
+                        << " [--format text|json|csv] [--filter name] [--output file] [--perf]"
+                        << std::endl;
+            return EXIT_FAILURE;
+        }
+
+    }
+
+    //counters are per thread, and every benchmark runs on this one
+    PerfCounters counters;
+
+    if(usePerf) {
+        if(!counters.anyAvailable()) {
+            std::cerr << "no performance counters available; ignoring --perf" << std::endl;
+        }
+        else {
+            perf = &counters;
+        }
+    }
+
+    benchChip();
+    benchDelay();
+    benchStats();
+    benchValueStack();
+    benchLatencyHistogram();
+    benchRollupAggregator();
+    benchQuantileSketch();
+    benchMass();
+    benchCompressedLog();
+
+    if(format == OutputFormat::TEXT) {
+        return EXIT_SUCCESS;
+    }
+
+    std::ofstream file;
+
+    if(output != nullptr) {
+        file.open(output);
+        if(!file) {
+            std::cerr << "cannot open " << output << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ostream& os = output != nullptr ? file : std::cout;
+    const std::time_t now = std::time(nullptr);
+
+    if(format == OutputFormat::JSON) {
+        writeJson(os, now);
+    }
+    else {
+        writeCsv(os, now);
+    }
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,309 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include "../include/PackedValueBuffer.h"
+#include "../include/Value.h"
+
+/**
+ * The vector decoders are compiled for their instruction sets whatever
+ * the build flags, and used only if the CPU running the code has them.
+ * AArch64 always has NEON; 32-bit ARM (eg. older Raspberry Pis) and x86
+ * may not.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define HX711_PACKED_SSSE3 1
+#include <tmmintrin.h>
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_FP))
+#define HX711_PACKED_NEON 1
+#include <arm_neon.h>
+#if defined(__arm__)
+#include <sys/auxv.h>
+#endif
+#endif
+
+namespace HX711 {
+
+constexpr std::chrono::nanoseconds PackedValueBuffer::_DEFAULT_RESOLUTION;
+
+#if defined(HX711_PACKED_SSSE3)
+
+/**
+ * Each 16 byte load holds 4 whole packed values. The shuffle moves each
+ * value's 3 bytes into the top of a 32 bit lane and the arithmetic shift
+ * then sign-extends it. The loop stops early enough that a load never
+ * reads past the end of src. Returns the number of values unpacked.
+ */
+__attribute__((target("ssse3")))
+static std::size_t unpackSsse3(
+    const std::uint8_t* const src,
+    const std::size_t count,
+    val_t* const dst) noexcept {
+
+        const __m128i shuf = _mm_setr_epi8(
+            -1, 0, 1, 2,
+            -1, 3, 4, 5,
+            -1, 6, 7, 8,
+            -1, 9, 10, 11);
+
+        std::size_t i = 0;
+
+        for(; i * 3 + 16 <= count * 3; i += 4) {
+            const __m128i packed = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src + i * 3));
+            const __m128i vals = _mm_srai_epi32(_mm_shuffle_epi8(packed, shuf), 8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), vals);
+        }
+
+        return i;
+
+}
+
+static bool haveVector() noexcept {
+    static const bool have = __builtin_cpu_supports("ssse3");
+    return have;
+}
+
+#elif defined(HX711_PACKED_NEON)
+
+/**
+ * vld3 de-interleaves 16 packed values into their low, middle, and high
+ * bytes. The high byte is sign-extended and the three are recombined
+ * into 32 bit lanes. Returns the number of values unpacked.
+ */
+#if defined(__arm__)
+__attribute__((target("fpu=neon")))
+#endif
+static std::size_t unpackNeon(
+    const std::uint8_t* const src,
+    const std::size_t count,
+    val_t* const dst) noexcept {
+
+        std::size_t i = 0;
+
+        for(; i + 16 <= count; i += 16) {
+
+            const uint8x16x3_t b = vld3q_u8(src + i * 3);
+
+            const uint16x8_t loLo = vorrq_u16(
+                vmovl_u8(vget_low_u8(b.val[0])),
+                vshlq_n_u16(vmovl_u8(vget_low_u8(b.val[1])), 8));
+            const uint16x8_t loHi = vorrq_u16(
+                vmovl_u8(vget_high_u8(b.val[0])),
+                vshlq_n_u16(vmovl_u8(vget_high_u8(b.val[1])), 8));
+
+            const int16x8_t hiLo = vmovl_s8(vreinterpret_s8_u8(vget_low_u8(b.val[2])));
+            const int16x8_t hiHi = vmovl_s8(vreinterpret_s8_u8(vget_high_u8(b.val[2])));
+
+            vst1q_s32(dst + i, vorrq_s32(
+                vshlq_n_s32(vmovl_s16(vget_low_s16(hiLo)), 16),
+                vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(loLo)))));
+            vst1q_s32(dst + i + 4, vorrq_s32(
+                vshlq_n_s32(vmovl_s16(vget_high_s16(hiLo)), 16),
+                vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(loLo)))));
+            vst1q_s32(dst + i + 8, vorrq_s32(
+                vshlq_n_s32(vmovl_s16(vget_low_s16(hiHi)), 16),
+                vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(loHi)))));
+            vst1q_s32(dst + i + 12, vorrq_s32(
+                vshlq_n_s32(vmovl_s16(vget_high_s16(hiHi)), 16),
+                vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(loHi)))));
+
+        }
+
+        return i;
+
+}
+
+static bool haveVector() noexcept {
+#if defined(__arm__)
+    //HWCAP_NEON from asm/hwcap.h
+    static const bool have = (::getauxval(AT_HWCAP) & (1 << 12)) != 0;
+    return have;
+#else
+    return true;
+#endif
+}
+
+#endif
+
+void PackedValueBuffer::_unpackValues(
+    const std::uint8_t* const src,
+    const std::size_t count,
+    val_t* const dst) noexcept {
+
+        std::size_t i = 0;
+
+#if defined(HX711_PACKED_SSSE3)
+        if(haveVector()) {
+            i = unpackSsse3(src, count, dst);
+        }
+#elif defined(HX711_PACKED_NEON)
+        if(haveVector()) {
+            i = unpackNeon(src, count, dst);
+        }
+#endif
+
+        for(; i < count; ++i) {
+            const std::uint8_t* const p = src + i * _BYTES_PER_VALUE;
+            const std::uint32_t u =
+                static_cast<std::uint32_t>(p[0]) |
+                static_cast<std::uint32_t>(p[1]) << 8 |
+                static_cast<std::uint32_t>(p[2]) << 16;
+            //move bit 23 into the sign bit and shift back to sign-extend
+            dst[i] = static_cast<val_t>(u << 8) >> 8;
+        }
+
+}
+
+void PackedValueBuffer::_newBlock(const std::int64_t tick) {
+
+    if(this->_maxBlocks > 0 && this->_blocks.size() >= this->_maxBlocks) {
+        this->_size -= this->_blocks.front().count;
+        this->_blocks.pop_front();
+    }
+
+    this->_blocks.emplace_back();
+
+    Block& b = this->_blocks.back();
+    b.start = tick;
+    b.count = 0;
+    b.longCount = 0;
+
+}
+
+PackedValueBuffer::PackedValueBuffer(
+    const std::chrono::nanoseconds resolution,
+    const std::size_t maxSamples) :
+        _resolution(resolution),
+        _maxBlocks(maxSamples == 0 ? 0 : (maxSamples + BLOCK_SIZE - 1) / BLOCK_SIZE),
+        _size(0),
+        _lastTick(0) {
+
+            if(resolution.count() <= 0) {
+                throw std::invalid_argument("resolution must be positive");
+            }
+
+}
+
+void PackedValueBuffer::push(const Value v, const std::chrono::nanoseconds when) {
+
+    if(!v.isValid()) {
+        throw std::invalid_argument("value is outside of 24 bit range");
+    }
+
+    //nearest tick
+    const std::int64_t tick =
+        (when.count() + this->_resolution.count() / 2) / this->_resolution.count();
+
+    const std::int64_t delta = tick - this->_lastTick;
+    const bool isLong = delta >= _LONG_DELTA;
+
+    if( this->_blocks.empty() ||
+        this->_blocks.back().count == BLOCK_SIZE ||
+        delta < 0 ||
+        delta > UINT32_MAX ||
+        (isLong && this->_blocks.back().longCount == _MAX_LONG_DELTAS)) {
+            this->_newBlock(tick);
+    }
+
+    Block& b = this->_blocks.back();
+    const val_t raw = v;
+    std::uint8_t* const p = b.values + b.count * _BYTES_PER_VALUE;
+
+    p[0] = static_cast<std::uint8_t>(raw);
+    p[1] = static_cast<std::uint8_t>(raw >> 8);
+    p[2] = static_cast<std::uint8_t>(raw >> 16);
+
+    if(b.count == 0) {
+        b.deltas[0] = 0;
+    }
+    else if(isLong) {
+        b.deltas[b.count] = _LONG_DELTA;
+        b.longDeltas[b.longCount++] = static_cast<std::uint32_t>(delta);
+    }
+    else {
+        b.deltas[b.count] = static_cast<std::uint8_t>(delta);
+    }
+
+    ++b.count;
+    ++this->_size;
+    this->_lastTick = tick;
+
+}
+
+std::size_t PackedValueBuffer::size() const noexcept {
+    return this->_size;
+}
+
+bool PackedValueBuffer::empty() const noexcept {
+    return this->_size == 0;
+}
+
+void PackedValueBuffer::clear() noexcept {
+    this->_blocks.clear();
+    this->_size = 0;
+    this->_lastTick = 0;
+}
+
+std::chrono::nanoseconds PackedValueBuffer::getResolution() const noexcept {
+    return this->_resolution;
+}
+
+std::size_t PackedValueBuffer::memoryUsage() const noexcept {
+    return sizeof(*this) + this->_blocks.size() * sizeof(Block);
+}
+
+std::size_t PackedValueBuffer::blockCount() const noexcept {
+    return this->_blocks.size();
+}
+
+std::size_t PackedValueBuffer::unpack(
+    const std::size_t index,
+    val_t* const vals,
+    std::chrono::nanoseconds* const times) const {
+
+        const Block& b = this->_blocks.at(index);
+
+        if(vals != nullptr) {
+            _unpackValues(b.values, b.count, vals);
+        }
+
+        if(times != nullptr) {
+            std::int64_t tick = b.start;
+            std::size_t longIndex = 0;
+            for(std::uint32_t i = 0; i < b.count; ++i) {
+                tick += b.deltas[i] == _LONG_DELTA
+                    ? b.longDeltas[longIndex++]
+                    : b.deltas[i];
+                times[i] = tick * this->_resolution;
+            }
+        }
+
+        return b.count;
+
+}
+
+};
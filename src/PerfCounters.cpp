@@ -0,0 +1,280 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "../include/PerfCounters.h"
+
+namespace HX711 {
+
+int PerfCounters::_open(const PerfCounter c, const int group) noexcept {
+
+    perf_event_attr pe;
+    std::memset(&pe, 0, sizeof(pe));
+    pe.size = sizeof(pe);
+    pe.read_format = PERF_FORMAT_GROUP;
+
+    switch(c) {
+        case PerfCounter::CYCLES:
+            pe.type = PERF_TYPE_HARDWARE;
+            pe.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfCounter::INSTRUCTIONS:
+            pe.type = PERF_TYPE_HARDWARE;
+            pe.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfCounter::CONTEXT_SWITCHES:
+            pe.type = PERF_TYPE_SOFTWARE;
+            pe.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+            break;
+        case PerfCounter::PAGE_FAULTS:
+        default:
+            pe.type = PERF_TYPE_SOFTWARE;
+            pe.config = PERF_COUNT_SW_PAGE_FAULTS;
+            break;
+    }
+
+    //this thread only, on any CPU
+    int fd = static_cast<int>(::syscall(
+        __NR_perf_event_open, &pe, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+
+    //perf_event_paranoid >= 2 only allows user space to be counted
+    if(fd < 0) {
+        pe.exclude_kernel = 1;
+        pe.exclude_hv = 1;
+        fd = static_cast<int>(::syscall(
+            __NR_perf_event_open, &pe, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+    }
+
+    return fd;
+
+}
+
+PerfCounters::PerfCounters() noexcept :
+    _leader(-1),
+    _count(0) {
+
+        for(std::size_t i = 0; i < PerfSample::COUNTERS; ++i) {
+
+            const PerfCounter c = static_cast<PerfCounter>(i);
+            const int fd = _open(c, this->_leader);
+
+            this->_available[i] = fd >= 0;
+
+            if(fd < 0) {
+                continue;
+            }
+
+            //the first counter to open leads the group; the others are
+            //read through it, but each must still be closed
+            if(this->_leader < 0) {
+                this->_leader = fd;
+            }
+
+            this->_fds[this->_count] = fd;
+            this->_order[this->_count++] = c;
+
+        }
+
+}
+
+PerfCounters::~PerfCounters() {
+    //siblings stay open (and counting) until closed themselves
+    for(std::size_t i = this->_count; i > 0; --i) {
+        ::close(this->_fds[i - 1]);
+    }
+}
+
+bool PerfCounters::isAvailable(const PerfCounter c) const noexcept {
+    return this->_available[static_cast<std::size_t>(c)];
+}
+
+bool PerfCounters::anyAvailable() const noexcept {
+    return this->_leader >= 0;
+}
+
+bool PerfCounters::read(PerfSample* const s) const noexcept {
+
+    std::memset(s, 0, sizeof(*s));
+
+    if(this->_leader < 0) {
+        return false;
+    }
+
+    //PERF_FORMAT_GROUP: the number of counters, then each in the order
+    //they joined the group
+    std::uint64_t buff[1 + PerfSample::COUNTERS];
+    const ssize_t n = ::read(this->_leader, buff, sizeof(buff));
+
+    if(n < static_cast<ssize_t>(sizeof(std::uint64_t) * (1 + this->_count))) {
+        return false;
+    }
+
+    for(std::size_t i = 0; i < this->_count && i < buff[0]; ++i) {
+        s->values[static_cast<std::size_t>(this->_order[i])] = buff[1 + i];
+    }
+
+    return true;
+
+}
+
+const char* PerfCounters::getName(const PerfCounter c) noexcept {
+    switch(c) {
+        case PerfCounter::CYCLES: return "cycles";
+        case PerfCounter::INSTRUCTIONS: return "instructions";
+        case PerfCounter::CONTEXT_SWITCHES: return "context_switches";
+        case PerfCounter::PAGE_FAULTS: return "page_faults";
+        default: return "unknown";
+    }
+}
+
+std::atomic<bool> PerfProfiler::_enabled(false);
+std::atomic<std::uint64_t> PerfProfiler::_calls[PerfProfiler::OPS];
+std::atomic<std::uint64_t> PerfProfiler::_totals[PerfProfiler::OPS][PerfSample::COUNTERS];
+std::atomic<unsigned> PerfProfiler::_unavailable(0);
+
+void PerfProfiler::enable() noexcept {
+    _enabled.store(true, std::memory_order_release);
+}
+
+void PerfProfiler::disable() noexcept {
+    _enabled.store(false, std::memory_order_release);
+}
+
+bool PerfProfiler::isEnabled() noexcept {
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+void PerfProfiler::reset() noexcept {
+
+    for(std::size_t op = 0; op < OPS; ++op) {
+        _calls[op].store(0, std::memory_order_relaxed);
+        for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+            _totals[op][c].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    //availability is a property of the threads, not the totals, so
+    //it is kept
+
+}
+
+const PerfCounters& PerfProfiler::getThreadCounters() noexcept {
+
+    static thread_local PerfCounters counters;
+    static thread_local bool noted = false;
+
+    if(!noted) {
+
+        unsigned missing = 0;
+
+        for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+            if(!counters.isAvailable(static_cast<PerfCounter>(c))) {
+                missing |= 1u << c;
+            }
+        }
+
+        _unavailable.fetch_or(missing, std::memory_order_relaxed);
+        noted = true;
+
+    }
+
+    return counters;
+
+}
+
+void PerfProfiler::add(
+    const PerfOp op,
+    const PerfSample& start,
+    const PerfSample& end) noexcept {
+
+        const auto i = static_cast<std::size_t>(op);
+
+        _calls[i].fetch_add(1, std::memory_order_relaxed);
+
+        for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+            _totals[i][c].fetch_add(
+                end.values[c] - start.values[c],
+                std::memory_order_relaxed);
+        }
+
+}
+
+PerfProfiler::Stats PerfProfiler::getStats(const PerfOp op) noexcept {
+
+    const auto i = static_cast<std::size_t>(op);
+    const unsigned missing = _unavailable.load(std::memory_order_relaxed);
+
+    Stats s;
+    s.calls = _calls[i].load(std::memory_order_relaxed);
+
+    for(std::size_t c = 0; c < PerfSample::COUNTERS; ++c) {
+        s.values[c] = _totals[i][c].load(std::memory_order_relaxed);
+        s.available[c] = (missing & (1u << c)) == 0;
+    }
+
+    return s;
+
+}
+
+const char* PerfProfiler::getName(const PerfOp op) noexcept {
+    switch(op) {
+        case PerfOp::READ_VALUE: return "HX711::readValue";
+        case PerfOp::SCALE_READ: return "AbstractScale::read";
+        case PerfOp::MEDIAN: return "median";
+        case PerfOp::AVERAGE: return "average";
+        default: return "unknown";
+    }
+}
+
+PerfScope::PerfScope(const PerfOp op) noexcept :
+    _op(op),
+    _active(false) {
+
+        if(!PerfProfiler::isEnabled()) {
+            return;
+        }
+
+        //with no counters, still count calls
+        PerfProfiler::getThreadCounters().read(&this->_start);
+        this->_active = true;
+
+}
+
+PerfScope::~PerfScope() {
+
+    if(!this->_active) {
+        return;
+    }
+
+    PerfSample end;
+    PerfProfiler::getThreadCounters().read(&end);
+    PerfProfiler::add(this->_op, this->_start, end);
+
+}
+
+};
@@ -0,0 +1,131 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include "../include/QuantileSink.h"
+#include "../include/QuantileSketch.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+void QuantileSink::_drain() const noexcept {
+
+    const auto tail = this->_tail.load(std::memory_order_relaxed);
+    const auto head = this->_head.load(std::memory_order_acquire);
+
+    for(auto i = tail; i != head; ++i) {
+        try {
+            this->_sketch.add(this->_staging[i % _STAGING_SIZE]);
+        }
+        catch(...) {
+            //only adding a level allocates
+            this->_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    this->_tail.store(head, std::memory_order_release);
+
+}
+
+std::uint64_t QuantileSink::_pack(const Value refUnit, const Value offset) noexcept {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(static_cast<val_t>(refUnit))) << 32) |
+        static_cast<std::uint32_t>(static_cast<val_t>(offset));
+}
+
+QuantileSink::QuantileSink(
+    const Value refUnit,
+    const Value offset,
+    const QuantileSketch& sketch) :
+        _sketch(sketch),
+        _calibration(0),
+        _staging(_STAGING_SIZE),
+        _head(0),
+        _tail(0),
+        _dropped(0) {
+            this->setCalibration(refUnit, offset);
+}
+
+void QuantileSink::push(const Value v, const std::chrono::nanoseconds when) noexcept {
+
+    (void)when;
+
+    const auto head = this->_head.load(std::memory_order_relaxed);
+
+    if(head - this->_tail.load(std::memory_order_acquire) >= _STAGING_SIZE) {
+        this->_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const auto cal = this->_calibration.load(std::memory_order_relaxed);
+    const auto refUnit = static_cast<std::int32_t>(cal >> 32);
+    const auto offset = static_cast<std::int32_t>(cal & 0xffffffff);
+
+    this->_staging[head % _STAGING_SIZE] =
+        (static_cast<double>(static_cast<val_t>(v)) - offset) / refUnit;
+
+    this->_head.store(head + 1, std::memory_order_release);
+
+    if(this->_mtx.try_lock()) {
+        this->_drain();
+        this->_mtx.unlock();
+    }
+
+}
+
+void QuantileSink::setCalibration(const Value refUnit, const Value offset) {
+
+    if(refUnit == 0) {
+        throw std::invalid_argument("reference unit cannot be 0");
+    }
+
+    this->_calibration.store(_pack(refUnit, offset), std::memory_order_relaxed);
+
+}
+
+void QuantileSink::getSketch(QuantileSketch* const out) const {
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_drain();
+    *out = this->_sketch;
+}
+
+double QuantileSink::quantile(const double q) const {
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_drain();
+    return this->_sketch.quantile(q);
+}
+
+void QuantileSink::reset() {
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_drain();
+    this->_sketch.clear();
+}
+
+std::uint64_t QuantileSink::getDropped() const noexcept {
+    return this->_dropped.load(std::memory_order_relaxed);
+}
+
+};
@@ -0,0 +1,366 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "../include/QuantileSketch.h"
+
+namespace HX711 {
+
+std::size_t QuantileSketch::_numLevels() const noexcept {
+    return this->_levels.size() - 1;
+}
+
+std::size_t QuantileSketch::_levelSize(const std::size_t h) const noexcept {
+    return this->_levels[h + 1] - this->_levels[h];
+}
+
+std::size_t QuantileSketch::_capacity(const std::size_t h) const noexcept {
+    const auto depth = static_cast<double>(this->_numLevels() - 1 - h);
+    const auto c = static_cast<std::size_t>(
+        std::ceil(static_cast<double>(this->_k) * std::pow(2.0 / 3.0, depth)));
+    return std::max(_MIN_WIDTH, c);
+}
+
+std::size_t QuantileSketch::_totalCapacity() const noexcept {
+    std::size_t total = 0;
+    for(std::size_t h = 0; h < this->_numLevels(); ++h) {
+        total += this->_capacity(h);
+    }
+    return total;
+}
+
+std::size_t QuantileSketch::_occupied() const noexcept {
+    return this->_items.size() - this->_levels[0];
+}
+
+void QuantileSketch::_resize(const std::size_t size) {
+
+    //values stay at the end of the buffer, so the levels move by the
+    //change in size
+    const auto used = this->_occupied();
+    std::vector<double> items(size);
+
+    std::copy(
+        this->_items.end() - static_cast<std::ptrdiff_t>(used),
+        this->_items.end(),
+        items.end() - static_cast<std::ptrdiff_t>(used));
+
+    for(auto& l : this->_levels) {
+        l = l + size - this->_items.size();
+    }
+
+    this->_items.swap(items);
+
+}
+
+void QuantileSketch::_addLevel() {
+
+    this->_levels.push_back(this->_items.size());
+
+    const auto capacity = this->_totalCapacity();
+
+    if(this->_items.size() < capacity) {
+        this->_resize(capacity);
+    }
+
+}
+
+void QuantileSketch::_compact() {
+
+    //the lowest level at or over its capacity
+    std::size_t h = 0;
+
+    while(this->_levelSize(h) < this->_capacity(h)) {
+        ++h;
+    }
+
+    if(h == this->_numLevels() - 1) {
+        this->_addLevel();
+    }
+
+    const auto a = this->_levels[h];
+    const auto b = this->_levels[h + 1];
+    const auto size = b - a;
+    const auto promoted = size / 2;
+    const auto odd = size % 2;
+
+    std::sort(this->_items.begin() + a, this->_items.begin() + b);
+
+    /**
+     * With an odd number of values the largest stays behind. Of each
+     * pair of the rest, the first or second (chosen at random) moves
+     * into the top of this level's space, which joins it to the start
+     * of the level above. Going from the top down, a value is never
+     * overwritten before it is read.
+     */
+    const double kept = this->_items[b - 1];
+    const std::size_t r = this->_randomBit() ? 1 : 0;
+
+    for(std::size_t i = 0; i < promoted; ++i) {
+        this->_items[b - 1 - i] = this->_items[a + r + 2 * (promoted - 1 - i)];
+    }
+
+    if(odd != 0) {
+        this->_items[b - promoted - 1] = kept;
+    }
+
+    //close the gap by moving the lower levels up
+    const auto freed = size - promoted - odd;
+
+    std::copy_backward(
+        this->_items.begin() + this->_levels[0],
+        this->_items.begin() + a,
+        this->_items.begin() + a + freed);
+
+    for(std::size_t i = 0; i <= h; ++i) {
+        this->_levels[i] += freed;
+    }
+
+    this->_levels[h + 1] = b - promoted;
+
+}
+
+bool QuantileSketch::_randomBit() noexcept {
+    //xorshift64
+    this->_random ^= this->_random << 13;
+    this->_random ^= this->_random >> 7;
+    this->_random ^= this->_random << 17;
+    return (this->_random & 1) != 0;
+}
+
+QuantileSketch::QuantileSketch(const std::size_t k, const std::uint64_t seed) :
+    _k(k),
+    _count(0),
+    _min(std::numeric_limits<double>::infinity()),
+    _max(-std::numeric_limits<double>::infinity()),
+    _random(seed == 0 ? _DEFAULT_SEED : seed) {
+
+        if(k < _MIN_WIDTH) {
+            throw std::invalid_argument("k must be at least 8");
+        }
+
+        this->_items.resize(k);
+        this->_levels.push_back(k);
+        this->_levels.push_back(k);
+
+}
+
+void QuantileSketch::add(const double v) {
+
+    if(this->_levels[0] == 0) {
+        this->_compact();
+    }
+
+    this->_items[--this->_levels[0]] = v;
+
+    ++this->_count;
+    this->_min = std::min(this->_min, v);
+    this->_max = std::max(this->_max, v);
+
+}
+
+void QuantileSketch::merge(const QuantileSketch& s) {
+
+    if(s._k != this->_k) {
+        throw std::invalid_argument("sketches must have the same k");
+    }
+
+    if(s._count == 0) {
+        return;
+    }
+
+    while(this->_numLevels() < s._numLevels()) {
+        this->_addLevel();
+    }
+
+    //lay the combined levels out at the end of a new buffer, then
+    //compact until they fit
+    const auto used = this->_occupied() + s._occupied();
+    const auto size = std::max(used, this->_totalCapacity());
+    std::vector<double> items(size);
+    std::vector<std::size_t> levels(this->_levels.size());
+    auto pos = size - used;
+
+    for(std::size_t h = 0; h < this->_numLevels(); ++h) {
+
+        levels[h] = pos;
+
+        const auto mine = this->_items.begin() + this->_levels[h];
+        pos = static_cast<std::size_t>(
+            std::copy(mine, mine + this->_levelSize(h), items.begin() + pos) - items.begin());
+
+        if(h < s._numLevels()) {
+            const auto theirs = s._items.begin() + s._levels[h];
+            pos = static_cast<std::size_t>(
+                std::copy(theirs, theirs + s._levelSize(h), items.begin() + pos) - items.begin());
+        }
+
+    }
+
+    levels.back() = size;
+
+    this->_items.swap(items);
+    this->_levels.swap(levels);
+    this->_count += s._count;
+    this->_min = std::min(this->_min, s._min);
+    this->_max = std::max(this->_max, s._max);
+
+    while(this->_occupied() > this->_totalCapacity()) {
+        this->_compact();
+    }
+
+    if(this->_items.size() > this->_totalCapacity()) {
+        this->_resize(this->_totalCapacity());
+    }
+
+}
+
+void QuantileSketch::clear() noexcept {
+
+    this->_count = 0;
+    this->_min = std::numeric_limits<double>::infinity();
+    this->_max = -std::numeric_limits<double>::infinity();
+
+    //back to a single level; both only shrink, so nothing is allocated
+    this->_items.resize(this->_k);
+    this->_levels.assign(2, this->_k);
+
+}
+
+double QuantileSketch::quantile(const double q) const {
+    double v;
+    this->quantiles(&q, 1, &v);
+    return v;
+}
+
+void QuantileSketch::quantiles(
+    const double* const qs,
+    const std::size_t count,
+    double* const out) const {
+
+        if(this->_count == 0) {
+            std::fill(out, out + count, 0.0);
+            return;
+        }
+
+        //every stored value with its weight, in order
+        std::vector<std::pair<double, std::uint64_t>> sorted;
+        sorted.reserve(this->_occupied());
+
+        for(std::size_t h = 0; h < this->_numLevels(); ++h) {
+            for(auto i = this->_levels[h]; i < this->_levels[h + 1]; ++i) {
+                sorted.push_back(std::make_pair(
+                    this->_items[i],
+                    static_cast<std::uint64_t>(1) << h));
+            }
+        }
+
+        std::sort(sorted.begin(), sorted.end());
+
+        std::uint64_t total = 0;
+        for(auto& p : sorted) {
+            total += p.second;
+            p.second = total;
+        }
+
+        for(std::size_t i = 0; i < count; ++i) {
+
+            const auto q = qs[i];
+
+            if(q <= 0) {
+                out[i] = this->_min;
+                continue;
+            }
+
+            if(q >= 1) {
+                out[i] = this->_max;
+                continue;
+            }
+
+            //the first value whose cumulative weight reaches q
+            const auto target = static_cast<std::uint64_t>(
+                std::ceil(q * static_cast<double>(total)));
+
+            const auto it = std::lower_bound(
+                sorted.begin(),
+                sorted.end(),
+                target,
+                [](const std::pair<double, std::uint64_t>& p, const std::uint64_t t) {
+                    return p.second < t;
+                });
+
+            out[i] = it == sorted.end() ? this->_max : it->first;
+
+        }
+
+}
+
+double QuantileSketch::rank(const double v) const noexcept {
+
+    if(this->_count == 0) {
+        return 0;
+    }
+
+    std::uint64_t below = 0;
+    std::uint64_t total = 0;
+
+    for(std::size_t h = 0; h < this->_numLevels(); ++h) {
+        for(auto i = this->_levels[h]; i < this->_levels[h + 1]; ++i) {
+            total += static_cast<std::uint64_t>(1) << h;
+            if(this->_items[i] <= v) {
+                below += static_cast<std::uint64_t>(1) << h;
+            }
+        }
+    }
+
+    return static_cast<double>(below) / static_cast<double>(total);
+
+}
+
+std::uint64_t QuantileSketch::getCount() const noexcept {
+    return this->_count;
+}
+
+double QuantileSketch::getMin() const noexcept {
+    return this->_min;
+}
+
+double QuantileSketch::getMax() const noexcept {
+    return this->_max;
+}
+
+std::size_t QuantileSketch::getK() const noexcept {
+    return this->_k;
+}
+
+std::size_t QuantileSketch::getRetained() const noexcept {
+    return this->_occupied();
+}
+
+};
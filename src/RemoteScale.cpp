@@ -0,0 +1,354 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+#include "../include/AbstractScale.h"
+#include "../include/DaemonProtocol.h"
+#include "../include/Mass.h"
+#include "../include/RemoteScale.h"
+#include "../include/SampleLog.h"
+#include "../include/Utility.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+//the protocol numbers scales with 16 bits
+static std::uint16_t toScaleIndex(const std::size_t scale) {
+
+    if(scale > UINT16_MAX) {
+        throw std::out_of_range("hx711d has no such scale");
+    }
+
+    return static_cast<std::uint16_t>(scale);
+
+}
+
+static void sendRequest(
+    const int fd,
+    const DaemonMessageType type,
+    const std::uint16_t scale,
+    const DaemonRequest& req) {
+
+        DaemonHeader h;
+        std::memset(&h, 0, sizeof(h));
+        h.magic = DaemonHeader::MAGIC;
+        h.type = static_cast<std::uint8_t>(type);
+        h.scale = scale;
+
+        iovec iov[2] = {
+            { &h, sizeof(h) },
+            { const_cast<DaemonRequest*>(&req), sizeof(req) }
+        };
+
+        if(!Utility::sendAll(fd, iov, 2)) {
+            throw std::runtime_error("unable to send request to hx711d");
+        }
+
+}
+
+static void receiveHeader(const int fd, DaemonHeader* const h) {
+
+    if(!Utility::recvAll(fd, h, sizeof(*h))) {
+        throw std::runtime_error("connection to hx711d closed");
+    }
+
+    if(h->magic != DaemonHeader::MAGIC) {
+        throw std::runtime_error("unexpected response from hx711d");
+    }
+
+}
+
+static int connectTo(const std::string& path) {
+
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if(path.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("socket path too long");
+    }
+
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if(fd < 0) {
+        throw std::runtime_error("unable to create socket");
+    }
+
+    if(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("unable to connect to hx711d");
+    }
+
+    return fd;
+
+}
+
+void RemoteScale::_request(
+    const DaemonMessageType type,
+    const DaemonRequest& req,
+    DaemonHeader* const res) {
+
+        sendRequest(this->_fd, type, this->_scale, req);
+        receiveHeader(this->_fd, res);
+
+        switch(static_cast<DaemonStatus>(res->status)) {
+            case DaemonStatus::OK:
+            case DaemonStatus::NO_SAMPLES:
+                return;
+            case DaemonStatus::NO_SUCH_SCALE:
+                throw std::out_of_range("hx711d has no such scale");
+            default:
+                throw std::runtime_error("hx711d rejected the request");
+        }
+
+}
+
+void RemoteScale::_readPayload(void* const buf, const std::size_t len) {
+    if(!Utility::recvAll(this->_fd, buf, len)) {
+        throw std::runtime_error("connection to hx711d closed");
+    }
+}
+
+void RemoteScale::_apply(const DaemonScaleInfo& info) noexcept {
+    this->_info = info;
+    this->_refUnit = info.refUnit;
+    this->_offset = info.offset;
+    this->_massUnit = static_cast<Mass::Unit>(info.unit);
+}
+
+DaemonRequest RemoteScale::_toRequest(const Options& o) noexcept {
+    DaemonRequest req;
+    std::memset(&req, 0, sizeof(req));
+    req.strategy = static_cast<std::uint8_t>(o.stratType);
+    req.readType = static_cast<std::uint8_t>(o.readType);
+    req.samples = o.samples;
+    req.timeout = o.timeout.count();
+    return req;
+}
+
+std::vector<Value> RemoteScale::_toValues(const std::vector<SampleRecord>& recs) {
+
+    std::vector<Value> vals;
+    vals.reserve(recs.size());
+
+    for(const auto& rec : recs) {
+        vals.push_back(Value(rec.value));
+    }
+
+    return vals;
+
+}
+
+RemoteScale::RemoteScale(const std::string& path, const std::size_t scale) :
+    AbstractScale(Mass::Unit::G, 1, 0),
+    _path(path),
+    _scale(toScaleIndex(scale)),
+    _fd(-1) {
+
+        std::memset(&this->_info, 0, sizeof(this->_info));
+        this->_fd = connectTo(path);
+
+        try {
+            this->refresh();
+        }
+        catch(...) {
+            ::close(this->_fd);
+            throw;
+        }
+
+}
+
+RemoteScale::~RemoteScale() {
+    ::close(this->_fd);
+}
+
+std::vector<Value> RemoteScale::getValues(const std::size_t samples) {
+
+    if(samples == 0) {
+        throw std::range_error("samples must be at least 1");
+    }
+
+    return _toValues(this->getRecords(Options(samples)));
+
+}
+
+std::vector<Value> RemoteScale::getValues(const std::chrono::nanoseconds timeout) {
+    return _toValues(this->getRecords(Options(timeout)));
+}
+
+std::vector<SampleRecord> RemoteScale::getRecords(const Options o) {
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+
+    DaemonHeader res;
+    this->_request(DaemonMessageType::GET_VALUES, _toRequest(o), &res);
+
+    std::vector<SampleRecord> recs(res.count);
+    this->_readPayload(recs.data(), recs.size() * sizeof(SampleRecord));
+
+    return recs;
+
+}
+
+void RemoteScale::tare(const Options o) {
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+
+    DaemonHeader res;
+    this->_request(DaemonMessageType::TARE, _toRequest(o), &res);
+
+    if(res.status == static_cast<std::uint8_t>(DaemonStatus::NO_SAMPLES)) {
+        throw std::runtime_error("no samples obtained");
+    }
+
+    DaemonScaleInfo info;
+    this->_readPayload(&info, sizeof(info));
+    this->_apply(info);
+
+}
+
+void RemoteScale::refresh() {
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+
+    DaemonHeader res;
+    this->_request(DaemonMessageType::LIST, _toRequest(Options()), &res);
+
+    std::vector<DaemonScaleInfo> infos(res.count);
+    this->_readPayload(infos.data(), infos.size() * sizeof(DaemonScaleInfo));
+
+    if(this->_scale >= infos.size()) {
+        throw std::out_of_range("hx711d has no such scale");
+    }
+
+    this->_apply(infos[this->_scale]);
+
+}
+
+DaemonScaleInfo RemoteScale::getInfo() const noexcept {
+    return this->_info;
+}
+
+std::vector<DaemonScaleInfo> RemoteScale::list(const std::string& path) {
+
+    const int fd = connectTo(path);
+    std::vector<DaemonScaleInfo> infos;
+
+    try {
+
+        DaemonRequest req;
+        std::memset(&req, 0, sizeof(req));
+        sendRequest(fd, DaemonMessageType::LIST, 0, req);
+
+        DaemonHeader res;
+        receiveHeader(fd, &res);
+
+        infos.resize(res.count);
+
+        if(!Utility::recvAll(fd, infos.data(), infos.size() * sizeof(DaemonScaleInfo))) {
+            throw std::runtime_error("connection to hx711d closed");
+        }
+
+    }
+    catch(...) {
+        ::close(fd);
+        throw;
+    }
+
+    ::close(fd);
+    return infos;
+
+}
+
+RemoteSubscription::RemoteSubscription(const std::string& path, const std::size_t scale) :
+    _fd(-1),
+    _lost(0) {
+
+        const auto index = toScaleIndex(scale);
+
+        this->_fd = connectTo(path);
+
+        try {
+            DaemonRequest req;
+            std::memset(&req, 0, sizeof(req));
+            sendRequest(this->_fd, DaemonMessageType::SUBSCRIBE, index, req);
+        }
+        catch(...) {
+            ::close(this->_fd);
+            throw;
+        }
+
+}
+
+RemoteSubscription::~RemoteSubscription() {
+    ::close(this->_fd);
+}
+
+std::size_t RemoteSubscription::next(std::vector<SampleRecord>* const out) {
+
+    DaemonHeader h;
+    receiveHeader(this->_fd, &h);
+
+    if(h.status == static_cast<std::uint8_t>(DaemonStatus::NO_SUCH_SCALE)) {
+        throw std::out_of_range("hx711d has no such scale");
+    }
+
+    if(h.type != static_cast<std::uint8_t>(DaemonMessageType::SAMPLES)) {
+        throw std::runtime_error("unexpected message from hx711d");
+    }
+
+    this->_lost += h.lost;
+
+    const std::size_t before = out->size();
+    out->resize(before + h.count);
+
+    if(!Utility::recvAll(this->_fd, out->data() + before, h.count * sizeof(SampleRecord))) {
+        out->resize(before);
+        throw std::runtime_error("connection to hx711d closed");
+    }
+
+    return h.count;
+
+}
+
+std::uint64_t RemoteSubscription::getLost() const noexcept {
+    return this->_lost;
+}
+
+int RemoteSubscription::getFd() const noexcept {
+    return this->_fd;
+}
+
+};
@@ -0,0 +1,151 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "../include/ReplayChip.h"
+#include "../include/SampleLog.h"
+#include "../include/VirtualChip.h"
+
+namespace HX711 {
+
+bool ReplayChip::_nextConversion(
+    const std::chrono::nanoseconds now,
+    std::uint32_t* const v) {
+
+        if(this->_index >= this->_log.size()) {
+
+            if(!this->_loop || this->_log.empty()) {
+                return false;
+            }
+
+            this->_index = 0;
+            this->_started = false;
+
+        }
+
+        if(!this->_started) {
+            this->_started = true;
+            this->_startNow = now;
+            this->_startWhen = this->_log[this->_index].when;
+        }
+
+        if(this->_mode == ReplayMode::REAL_TIME) {
+
+            const auto elapsed = now - this->_startNow;
+            std::size_t next = this->_index;
+
+            //find the latest record which has become due
+            while(next < this->_log.size() &&
+                std::chrono::nanoseconds(this->_log[next].when - this->_startWhen) <= elapsed) {
+                    ++next;
+            }
+
+            if(next == this->_index) {
+                return false;
+            }
+
+            this->_skipped += next - this->_index - 1;
+            this->_index = next - 1;
+
+        }
+
+        *v = VirtualChip::toRaw(this->_log[this->_index].value);
+        ++this->_index;
+
+        return true;
+
+}
+
+bool ReplayChip::_nextConversionAt(std::chrono::nanoseconds* const at) const {
+
+    if(this->_mode != ReplayMode::REAL_TIME ||
+        !this->_started ||
+        this->_index >= this->_log.size()) {
+            return false;
+    }
+
+    *at = this->_startNow + std::chrono::nanoseconds(
+        this->_log[this->_index].when - this->_startWhen);
+
+    return true;
+
+}
+
+void ReplayChip::_reset(
+    const std::chrono::nanoseconds now,
+    const bool discarded) {
+
+        (void)now;
+
+        if(discarded &&
+            this->_mode == ReplayMode::AS_FAST_AS_POSSIBLE &&
+            this->_index > 0) {
+                --this->_index;
+        }
+
+}
+
+ReplayChip::ReplayChip(
+    const std::string& path,
+    const ReplayMode mode,
+    const bool loop) :
+        _log(path),
+        _mode(mode),
+        _loop(loop),
+        _index(0),
+        _skipped(0),
+        _started(false),
+        _startNow(0),
+        _startWhen(0) {
+}
+
+const SampleLog& ReplayChip::getLog() const noexcept {
+    return this->_log;
+}
+
+std::size_t ReplayChip::getPosition() const noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    return this->_index;
+}
+
+std::size_t ReplayChip::getSkipped() const noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    return this->_skipped;
+}
+
+bool ReplayChip::finished() const noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    return !this->_loop && this->_index >= this->_log.size();
+}
+
+void ReplayChip::rewind() noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_index = 0;
+    this->_skipped = 0;
+    this->_started = false;
+}
+
+};
@@ -0,0 +1,277 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "../include/RollupAggregator.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+RollupStats::RollupStats() noexcept :
+    start(0),
+    count(0),
+    min(std::numeric_limits<double>::infinity()),
+    max(-std::numeric_limits<double>::infinity()),
+    mean(0),
+    m2(0) {
+}
+
+void RollupStats::add(const double v) noexcept {
+    ++this->count;
+    const double delta = v - this->mean;
+    this->mean += delta / static_cast<double>(this->count);
+    this->m2 += delta * (v - this->mean);
+    this->min = std::min(this->min, v);
+    this->max = std::max(this->max, v);
+}
+
+void RollupStats::merge(const RollupStats& s) noexcept {
+
+    if(s.count == 0) {
+        return;
+    }
+
+    if(this->count == 0) {
+        const auto start = this->start;
+        *this = s;
+        this->start = start;
+        return;
+    }
+
+    //Chan et al.'s parallel combination of two Welford accumulators
+    const double n1 = static_cast<double>(this->count);
+    const double n2 = static_cast<double>(s.count);
+    const double n = n1 + n2;
+    const double delta = s.mean - this->mean;
+
+    this->mean += delta * n2 / n;
+    this->m2 += s.m2 + delta * delta * n1 * n2 / n;
+    this->count += s.count;
+    this->min = std::min(this->min, s.min);
+    this->max = std::max(this->max, s.max);
+
+}
+
+double RollupStats::variance() const noexcept {
+    return this->count < 2 ? 0 : this->m2 / static_cast<double>(this->count - 1);
+}
+
+double RollupStats::stddev() const noexcept {
+    return std::sqrt(this->variance());
+}
+
+RollupStats RollupStats::calibrated(const Value refUnit, const Value offset) const noexcept {
+
+    RollupStats s(*this);
+
+    if(this->count == 0) {
+        return s;
+    }
+
+    const double r = refUnit;
+    const double o = offset;
+
+    s.mean = (this->mean - o) / r;
+    s.m2 = this->m2 / (r * r);
+
+    //a negative reference unit swaps the extremes
+    const double a = (this->min - o) / r;
+    const double b = (this->max - o) / r;
+    s.min = std::min(a, b);
+    s.max = std::max(a, b);
+
+    return s;
+
+}
+
+void RollupAggregator::_store(_Bucket* const b, const RollupStats& s) noexcept {
+    b->start.store(s.start, std::memory_order_relaxed);
+    b->count.store(s.count, std::memory_order_relaxed);
+    b->min.store(s.min, std::memory_order_relaxed);
+    b->max.store(s.max, std::memory_order_relaxed);
+    b->mean.store(s.mean, std::memory_order_relaxed);
+    b->m2.store(s.m2, std::memory_order_relaxed);
+}
+
+void RollupAggregator::_load(const _Bucket* const b, RollupStats* const s) noexcept {
+    s->start = b->start.load(std::memory_order_relaxed);
+    s->count = b->count.load(std::memory_order_relaxed);
+    s->min = b->min.load(std::memory_order_relaxed);
+    s->max = b->max.load(std::memory_order_relaxed);
+    s->mean = b->mean.load(std::memory_order_relaxed);
+    s->m2 = b->m2.load(std::memory_order_relaxed);
+}
+
+RollupAggregator::RollupAggregator(
+    const std::vector<std::chrono::nanoseconds>& intervals,
+    const std::size_t history) :
+        _history(history) {
+
+            if(intervals.empty() || history == 0) {
+                throw std::invalid_argument("at least one interval and bucket are required");
+            }
+
+            for(const auto interval : intervals) {
+
+                if(interval.count() <= 0) {
+                    throw std::invalid_argument("intervals must be greater than 0");
+                }
+
+                std::unique_ptr<_Resolution> r(new _Resolution());
+                r->sequence.store(0, std::memory_order_relaxed);
+                r->head.store(0, std::memory_order_relaxed);
+                r->buckets.reset(new _Bucket[history]);
+                r->interval = interval.count();
+
+                this->_resolutions.push_back(std::move(r));
+
+            }
+
+}
+
+void RollupAggregator::push(const Value v, const std::chrono::nanoseconds when) noexcept {
+
+    const double value = static_cast<val_t>(v);
+
+    for(const auto& rp : this->_resolutions) {
+
+        _Resolution& r = *rp;
+
+        auto head = r.head.load(std::memory_order_relaxed);
+        const auto offset = when.count() - r.working.start;
+
+        //most samples fall in the current bucket, which avoids dividing
+        if(head == 0 || offset < 0 || offset >= r.interval) {
+
+            //floor, so times before 0 still land in the right bucket
+            auto start = when.count() - when.count() % r.interval;
+            if(start > when.count()) {
+                start -= r.interval;
+            }
+
+            r.working = RollupStats();
+            r.working.start = start;
+            ++head;
+
+        }
+
+        r.working.add(value);
+
+        const auto seq = r.sequence.load(std::memory_order_relaxed);
+        r.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        _store(&r.buckets[(head - 1) % this->_history], r.working);
+        r.head.store(head, std::memory_order_relaxed);
+
+        r.sequence.store(seq + 2, std::memory_order_release);
+
+    }
+
+}
+
+std::size_t RollupAggregator::getResolutions() const noexcept {
+    return this->_resolutions.size();
+}
+
+std::chrono::nanoseconds RollupAggregator::getInterval(const std::size_t resolution) const noexcept {
+    return std::chrono::nanoseconds(this->_resolutions[resolution]->interval);
+}
+
+std::size_t RollupAggregator::getHistory() const noexcept {
+    return this->_history;
+}
+
+bool RollupAggregator::get(
+    const std::size_t resolution,
+    const std::size_t ago,
+    RollupStats* const out) const noexcept {
+
+        const _Resolution& r = *this->_resolutions[resolution];
+        std::uint64_t seq;
+        std::uint64_t head;
+
+        do {
+
+            seq = r.sequence.load(std::memory_order_acquire);
+            head = r.head.load(std::memory_order_relaxed);
+
+            if(ago >= std::min<std::uint64_t>(head, this->_history)) {
+                //no such bucket yet, unless push is part way through
+                //starting one
+                if((seq & 1) == 0 && r.sequence.load(std::memory_order_acquire) == seq) {
+                    return false;
+                }
+                continue;
+            }
+
+            _load(&r.buckets[(head - 1 - ago) % this->_history], out);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+        } while((seq & 1) != 0 ||
+            r.sequence.load(std::memory_order_relaxed) != seq);
+
+        return true;
+
+}
+
+void RollupAggregator::getAll(
+    const std::size_t resolution,
+    std::vector<RollupStats>* const out) const {
+
+        const _Resolution& r = *this->_resolutions[resolution];
+        std::uint64_t seq;
+
+        out->reserve(out->size() + this->_history);
+        const auto base = out->size();
+
+        do {
+
+            out->resize(base);
+
+            seq = r.sequence.load(std::memory_order_acquire);
+            const auto head = r.head.load(std::memory_order_relaxed);
+            const auto n = std::min<std::uint64_t>(head, this->_history);
+
+            for(auto i = head - n; i < head; ++i) {
+                RollupStats s;
+                _load(&r.buckets[i % this->_history], &s);
+                out->push_back(s);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+        } while((seq & 1) != 0 ||
+            r.sequence.load(std::memory_order_relaxed) != seq);
+
+}
+
+};
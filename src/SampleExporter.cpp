@@ -0,0 +1,326 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../include/CompressedLog.h"
+#include "../include/SampleExporter.h"
+#include "../include/SampleLog.h"
+#include "../include/Utility.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+//beyond this, scaled weights no longer fit in an int64
+static const double MAX_SCALED = 9e18;
+
+static inline char* writeLiteral(char* p, const char* const s, const std::size_t len) noexcept {
+    std::memcpy(p, s, len);
+    return p + len;
+}
+
+char* SampleExporter::_writeInt(char* p, const std::int64_t v) noexcept {
+
+    std::uint64_t u = static_cast<std::uint64_t>(v);
+
+    if(v < 0) {
+        *p++ = '-';
+        u = ~u + 1;
+    }
+
+    //written backwards into a scratch space, then moved into place
+    char tmp[20];
+    char* const end = tmp + sizeof(tmp);
+    const char* const start = Utility::writeUint(end, u);
+    const auto len = static_cast<std::size_t>(end - start);
+
+    std::memcpy(p, start, len);
+    return p + len;
+
+}
+
+void SampleExporter::_init() {
+
+    if(this->_refUnit == 0) {
+        throw std::invalid_argument("reference unit cannot be 0");
+    }
+
+    if(this->_decimals < 0 || this->_decimals > _MAX_DECIMALS) {
+        throw std::invalid_argument("decimals must be from 0 to 9");
+    }
+
+    if(this->_buff.size() < _MAX_LINE) {
+        this->_buff.resize(_MAX_LINE);
+    }
+
+    if(this->_format == ExportFormat::CSV) {
+        static const char header[] = "unix_ns,value,weight\n";
+        this->_used = sizeof(header) - 1;
+        std::memcpy(this->_buff.data(), header, this->_used);
+    }
+
+}
+
+char* SampleExporter::_formatWeight(char* p, const double w) const noexcept {
+
+    const double scaled = std::round(w * this->_scale);
+
+    if(!(std::abs(scaled) < MAX_SCALED)) {
+        //too large for fixed point; rare enough for snprintf
+        const int n = ::snprintf(p, _MAX_NUMBER, "%.17g", w);
+        return n > 0 ? p + std::min(n, static_cast<int>(_MAX_NUMBER) - 1) : p;
+    }
+
+    auto v = static_cast<std::int64_t>(scaled);
+
+    if(v < 0) {
+        *p++ = '-';
+        v = -v;
+    }
+
+    if(this->_decimals == 0) {
+        return _writeInt(p, v);
+    }
+
+    const auto pow = static_cast<std::int64_t>(POW10[this->_decimals]);
+    p = _writeInt(p, v / pow);
+    *p++ = '.';
+
+    //the fraction, zero-padded to the number of decimals
+    auto frac = static_cast<std::uint64_t>(v % pow);
+    char* const end = p + this->_decimals;
+
+    for(char* q = end; q != p;) {
+        *--q = static_cast<char>('0' + frac % 10);
+        frac /= 10;
+    }
+
+    return end;
+
+}
+
+char* SampleExporter::_formatRecord(char* p, const SampleRecord& r) const noexcept {
+
+    const double w = (static_cast<double>(r.value) - this->_offset) / this->_refUnit;
+
+    if(this->_format == ExportFormat::CSV) {
+        p = _writeInt(p, r.when + this->_timeOffset);
+        *p++ = ',';
+        p = _writeInt(p, r.value);
+        *p++ = ',';
+        p = this->_formatWeight(p, w);
+        *p++ = '\n';
+        return p;
+    }
+
+    p = writeLiteral(p, "{\"unix_ns\":", 11);
+    p = _writeInt(p, r.when + this->_timeOffset);
+    p = writeLiteral(p, ",\"value\":", 9);
+    p = _writeInt(p, r.value);
+    p = writeLiteral(p, ",\"weight\":", 10);
+    p = this->_formatWeight(p, w);
+    p = writeLiteral(p, "}\n", 2);
+    return p;
+
+}
+
+SampleExporter::SampleExporter(
+    const int fd,
+    const ExportFormat format,
+    const Value refUnit,
+    const Value offset,
+    const std::int64_t timeOffset,
+    const int decimals,
+    const std::size_t bufferSize) :
+        _fd(fd),
+        _ownsFd(false),
+        _format(format),
+        _refUnit(refUnit),
+        _offset(offset),
+        _timeOffset(timeOffset),
+        _decimals(decimals),
+        _scale(decimals >= 0 && decimals <= _MAX_DECIMALS ? POW10[decimals] : 1),
+        _buff(bufferSize),
+        _used(0),
+        _failed(false),
+        _rows(0),
+        _bytes(0) {
+            this->_init();
+}
+
+SampleExporter::SampleExporter(
+    const std::string& path,
+    const ExportFormat format,
+    const Value refUnit,
+    const Value offset,
+    const std::int64_t timeOffset,
+    const int decimals,
+    const std::size_t bufferSize) :
+        SampleExporter(-1, format, refUnit, offset, timeOffset, decimals, bufferSize) {
+
+            this->_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+            if(this->_fd < 0) {
+                throw std::runtime_error("unable to open " + path);
+            }
+
+            this->_ownsFd = true;
+
+}
+
+SampleExporter::~SampleExporter() {
+    this->flush();
+    if(this->_ownsFd) {
+        ::close(this->_fd);
+    }
+}
+
+void SampleExporter::append(const SampleRecord& r) noexcept {
+
+    if(this->_used + _MAX_LINE > this->_buff.size()) {
+        this->flush();
+    }
+
+    char* const start = this->_buff.data() + this->_used;
+    this->_used += static_cast<std::size_t>(this->_formatRecord(start, r) - start);
+    ++this->_rows;
+
+}
+
+void SampleExporter::append(const SampleRecord* const recs, const std::size_t count) noexcept {
+
+    std::size_t i = 0;
+
+    while(i < count) {
+
+        //as many records as certainly fit before the buffer needs flushing
+        const auto room = (this->_buff.size() - this->_used) / _MAX_LINE;
+
+        if(room == 0) {
+            this->flush();
+            continue;
+        }
+
+        const auto end = std::min(count, i + room);
+        char* p = this->_buff.data() + this->_used;
+
+        for(; i < end; ++i) {
+            p = this->_formatRecord(p, recs[i]);
+        }
+
+        this->_used = static_cast<std::size_t>(p - this->_buff.data());
+
+    }
+
+    this->_rows += count;
+
+}
+
+void SampleExporter::append(const SampleLog& log) noexcept {
+    this->append(log.begin(), log.size());
+}
+
+void SampleExporter::append(const CompressedLog& log) {
+
+    std::vector<SampleRecord> block;
+
+    for(std::size_t i = 0; i < log.getIndex().size(); ++i) {
+        block.resize(log.getIndex()[i].count);
+        log.decodeBlock(i, block.data());
+        this->append(block.data(), block.size());
+    }
+
+}
+
+bool SampleExporter::flush() noexcept {
+
+    std::size_t done = 0;
+
+    while(!this->_failed && done < this->_used) {
+
+        const auto n = ::write(this->_fd, this->_buff.data() + done, this->_used - done);
+
+        if(n < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            this->_failed = true;
+            break;
+        }
+
+        done += static_cast<std::size_t>(n);
+
+    }
+
+    this->_bytes += done;
+    this->_used = 0;
+
+    return !this->_failed;
+
+}
+
+void SampleExporter::setCalibration(const Value refUnit, const Value offset) {
+
+    if(refUnit == 0) {
+        throw std::invalid_argument("reference unit cannot be 0");
+    }
+
+    this->_refUnit = refUnit;
+    this->_offset = offset;
+
+}
+
+void SampleExporter::setTimeOffset(const std::int64_t timeOffset) noexcept {
+    this->_timeOffset = timeOffset;
+}
+
+std::uint64_t SampleExporter::getRows() const noexcept {
+    return this->_rows;
+}
+
+std::uint64_t SampleExporter::getBytes() const noexcept {
+    return this->_bytes;
+}
+
+std::int64_t SampleExporter::offsetOf(const SampleLog& log) noexcept {
+    return log.header().createdRealtime - log.header().createdMonotonic;
+}
+
+std::int64_t SampleExporter::offsetOf(const CompressedLog& log) noexcept {
+    return log.header().createdRealtime - log.header().createdMonotonic;
+}
+
+};
@@ -0,0 +1,208 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../include/AbstractScale.h"
+#include "../include/HX711.h"
+#include "../include/SampleLog.h"
+
+namespace HX711 {
+
+constexpr const char* const SampleLogHeader::MAGIC;
+
+SampleLogMeta::SampleLogMeta() noexcept :
+    refUnit(1),
+    offset(0),
+    dataPin(-1),
+    clockPin(-1),
+    rate(Rate::OTHER),
+    channel(Channel::A),
+    gain(Gain::GAIN_128),
+    unit(Mass::Unit::G) {
+}
+
+SampleLogMeta::SampleLogMeta(const AbstractScale& scale, const HX711& hx) noexcept :
+    refUnit(scale.getReferenceUnit()),
+    offset(scale.getOffset()),
+    dataPin(hx.getDataPin()),
+    clockPin(hx.getClockPin()),
+    rate(hx.getRate()),
+    channel(hx.getChannel()),
+    gain(hx.getGain()),
+    unit(scale.getUnit()) {
+}
+
+void SampleLogMeta::writeTo(SampleLogHeader* const h) const noexcept {
+    h->refUnit = this->refUnit;
+    h->offset = this->offset;
+    h->dataPin = this->dataPin;
+    h->clockPin = this->clockPin;
+    h->rate = static_cast<std::uint8_t>(this->rate);
+    h->channel = static_cast<std::uint8_t>(this->channel);
+    h->gain = static_cast<std::uint8_t>(this->gain);
+    h->unit = static_cast<std::uint8_t>(this->unit);
+}
+
+void SampleLog::_unmap() noexcept {
+    if(this->_map != nullptr) {
+        ::munmap(const_cast<std::uint8_t*>(this->_map), this->_mapSize);
+        this->_map = nullptr;
+        this->_mapSize = 0;
+    }
+}
+
+SampleLog::SampleLog(const std::string& path) :
+    _fd(-1),
+    _map(nullptr),
+    _mapSize(0),
+    _count(0) {
+
+        this->_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if(this->_fd < 0) {
+            throw std::runtime_error("unable to open sample log");
+        }
+
+        try {
+            this->refresh();
+        }
+        catch(...) {
+            ::close(this->_fd);
+            throw;
+        }
+
+}
+
+SampleLog::~SampleLog() {
+    this->_unmap();
+    ::close(this->_fd);
+}
+
+void SampleLog::refresh() {
+
+    struct stat st;
+
+    if(::fstat(this->_fd, &st) != 0) {
+        throw std::runtime_error("unable to stat sample log");
+    }
+
+    const auto size = static_cast<std::size_t>(st.st_size);
+
+    if(size < sizeof(SampleLogHeader)) {
+        throw std::runtime_error("sample log is too small");
+    }
+
+    if(size == this->_mapSize) {
+        return;
+    }
+
+    //the current mapping is kept until the new one is known to be good
+    void* const m = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, this->_fd, 0);
+
+    if(m == MAP_FAILED) {
+        throw std::runtime_error("unable to map sample log");
+    }
+
+    const auto& h = *static_cast<const SampleLogHeader*>(m);
+
+    try {
+
+        validate(h);
+
+        if(h.headerSize > size) {
+            throw std::runtime_error("sample log is too small");
+        }
+
+    }
+    catch(...) {
+        ::munmap(m, size);
+        throw;
+    }
+
+    this->_unmap();
+    this->_map = static_cast<const std::uint8_t*>(m);
+    this->_mapSize = size;
+    this->_count = (size - h.headerSize) / sizeof(SampleRecord);
+
+    //records are read sequentially far more often than not
+    ::madvise(m, size, MADV_SEQUENTIAL);
+
+}
+
+const SampleLogHeader& SampleLog::header() const noexcept {
+    return *reinterpret_cast<const SampleLogHeader*>(this->_map);
+}
+
+std::size_t SampleLog::size() const noexcept {
+    return this->_count;
+}
+
+bool SampleLog::empty() const noexcept {
+    return this->_count == 0;
+}
+
+const SampleRecord* SampleLog::begin() const noexcept {
+    return reinterpret_cast<const SampleRecord*>(
+        this->_map + this->header().headerSize);
+}
+
+const SampleRecord* SampleLog::end() const noexcept {
+    return this->begin() + this->_count;
+}
+
+const SampleRecord& SampleLog::operator[](const std::size_t i) const noexcept {
+    return this->begin()[i];
+}
+
+std::chrono::nanoseconds SampleLog::toRealtime(const std::int64_t when) const noexcept {
+    const auto& h = this->header();
+    return std::chrono::nanoseconds(h.createdRealtime + (when - h.createdMonotonic));
+}
+
+void SampleLog::validate(const SampleLogHeader& h) {
+
+    if(std::memcmp(h.magic, SampleLogHeader::MAGIC, SampleLogHeader::MAGIC_SIZE) != 0) {
+        throw std::runtime_error("not a sample log");
+    }
+
+    if(h.version != SampleLogHeader::VERSION) {
+        throw std::runtime_error("unsupported sample log version");
+    }
+
+    if( h.headerSize < sizeof(SampleLogHeader) ||
+        h.headerSize % alignof(SampleRecord) != 0 ||
+        h.recordSize != sizeof(SampleRecord)) {
+            throw std::runtime_error("unsupported sample log layout");
+    }
+
+}
+
+};
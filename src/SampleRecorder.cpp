@@ -0,0 +1,284 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "../include/SampleLog.h"
+#include "../include/SampleRecorder.h"
+#include "../include/SystemClock.h"
+#include "../include/Utility.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+constexpr std::chrono::nanoseconds SampleRecorder::_DEFAULT_FLUSH_INTERVAL;
+
+void SampleRecorder::_openLog(const std::string& path, const SampleLogMeta& meta) {
+
+    this->_fd = ::open(
+        path.c_str(),
+        O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+        0644);
+
+    if(this->_fd < 0) {
+        throw std::runtime_error("unable to open sample log");
+    }
+
+    struct stat st;
+
+    if(::fstat(this->_fd, &st) != 0) {
+        ::close(this->_fd);
+        throw std::runtime_error("unable to stat sample log");
+    }
+
+    if(st.st_size > 0) {
+
+        //existing log; make sure it can be appended to
+        SampleLogHeader h;
+
+        try {
+
+            if(::pread(this->_fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h))) {
+                throw std::runtime_error("unable to read sample log header");
+            }
+
+            SampleLog::validate(h);
+
+        }
+        catch(...) {
+            ::close(this->_fd);
+            throw;
+        }
+
+        /**
+         * Times are monotonic times, which restart when the system
+         * boots. Appending to a log from an earlier boot would mix
+         * times which cannot be compared.
+         */
+        if(!Utility::isCurrentBoot(h.bootId)) {
+            ::close(this->_fd);
+            throw std::runtime_error(
+                "sample log was written before the system last booted; use a new log");
+        }
+
+        /**
+         * If the previous writer died part way through a record, trim
+         * it so the records which follow stay aligned
+         */
+        const auto partial = (st.st_size - h.headerSize) % sizeof(SampleRecord);
+
+        if(partial != 0 && ::ftruncate(this->_fd, st.st_size - partial) != 0) {
+            ::close(this->_fd);
+            throw std::runtime_error("unable to truncate sample log");
+        }
+
+        return;
+
+    }
+
+    SampleLogHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, SampleLogHeader::MAGIC, SampleLogHeader::MAGIC_SIZE);
+    h.version = SampleLogHeader::VERSION;
+    h.headerSize = sizeof(SampleLogHeader);
+    h.recordSize = sizeof(SampleRecord);
+
+    timespec ts;
+    ::clock_gettime(CLOCK_REALTIME, &ts);
+    h.createdRealtime = Utility::timespec_to_nanos(&ts).count();
+    h.createdMonotonic = Utility::getnanos().count();
+    Utility::getBootId(h.bootId);
+
+    meta.writeTo(&h);
+
+    if(::write(this->_fd, &h, sizeof(h)) != static_cast<ssize_t>(sizeof(h))) {
+        ::close(this->_fd);
+        throw std::runtime_error("unable to write sample log header");
+    }
+
+}
+
+std::size_t SampleRecorder::_drain() noexcept {
+
+    const auto tail = this->_tail.load(std::memory_order_relaxed);
+    const auto head = this->_head.load(std::memory_order_acquire);
+    const auto count = head - tail;
+
+    if(count == 0) {
+        return 0;
+    }
+
+    /**
+     * The pending records are written straight out of the ring. They
+     * are in at most two contiguous pieces if they wrap around its end.
+     */
+    const auto start = tail & this->_mask;
+    const auto first = std::min(count, this->_ring.size() - start);
+
+    iovec iov[2];
+    iov[0].iov_base = &this->_ring[start];
+    iov[0].iov_len = first * sizeof(SampleRecord);
+    iov[1].iov_base = &this->_ring[0];
+    iov[1].iov_len = (count - first) * sizeof(SampleRecord);
+
+    const auto iovcnt = count > first ? 2 : 1;
+    const auto expected = static_cast<ssize_t>(count * sizeof(SampleRecord));
+    ssize_t total = 0;
+
+    //where the log ended, so a partial write can be undone
+    const auto end = ::lseek(this->_fd, 0, SEEK_END);
+
+    while(total < expected) {
+
+        const auto n = ::writev(this->_fd, iov, iovcnt);
+
+        if(n < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        total += n;
+
+        //short write; advance the iovecs past what was written
+        auto skip = static_cast<std::size_t>(n);
+        for(auto& v : iov) {
+            const auto s = std::min(skip, v.iov_len);
+            v.iov_base = static_cast<std::uint8_t*>(v.iov_base) + s;
+            v.iov_len -= s;
+            skip -= s;
+        }
+
+    }
+
+    if(total < expected) {
+
+        /**
+         * Records which could not be written are discarded rather than
+         * retried forever. Any part of them which was written is cut
+         * off, or every record after it would be misaligned.
+         */
+        if(total > 0 && (end < 0 || ::ftruncate(this->_fd, end) != 0)) {
+            this->_writeErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        this->_writeErrors.fetch_add(1, std::memory_order_relaxed);
+
+    }
+    else {
+        this->_written.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    this->_tail.store(head, std::memory_order_release);
+
+    return count;
+
+}
+
+void SampleRecorder::_writeLoop() noexcept {
+
+    while(this->_running.load(std::memory_order_acquire)) {
+
+        //wait for a batch to accumulate rather than writing per sample;
+        //this is I/O pacing, so always real time even with a VirtualClock
+        SystemClock::getInstance()->sleep(this->_flushInterval);
+        this->_drain();
+
+    }
+
+    this->_drain();
+
+}
+
+SampleRecorder::SampleRecorder(
+    const std::string& path,
+    const SampleLogMeta& meta,
+    const std::size_t capacity,
+    const std::chrono::nanoseconds flushInterval) :
+        _fd(-1),
+        _ring(Utility::roundUpPow2(capacity)),
+        _mask(_ring.size() - 1),
+        _flushInterval(flushInterval),
+        _head(0),
+        _tail(0),
+        _running(true),
+        _written(0),
+        _dropped(0),
+        _writeErrors(0) {
+
+            this->_openLog(path, meta);
+            this->_writer = std::thread(&SampleRecorder::_writeLoop, this);
+
+}
+
+SampleRecorder::~SampleRecorder() {
+    this->_running.store(false, std::memory_order_release);
+    this->_writer.join();
+    ::close(this->_fd);
+}
+
+void SampleRecorder::push(const Value v, const std::chrono::nanoseconds when) noexcept {
+
+    const auto head = this->_head.load(std::memory_order_relaxed);
+
+    if(head - this->_tail.load(std::memory_order_acquire) >= this->_ring.size()) {
+        this->_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    SampleRecord& r = this->_ring[head & this->_mask];
+    r.when = when.count();
+    r.value = v;
+    r.flags = 0;
+
+    this->_head.store(head + 1, std::memory_order_release);
+
+}
+
+std::uint64_t SampleRecorder::getWritten() const noexcept {
+    return this->_written.load(std::memory_order_relaxed);
+}
+
+std::uint64_t SampleRecorder::getDropped() const noexcept {
+    return this->_dropped.load(std::memory_order_relaxed);
+}
+
+std::uint64_t SampleRecorder::getWriteErrors() const noexcept {
+    return this->_writeErrors.load(std::memory_order_relaxed);
+}
+
+};
@@ -0,0 +1,223 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../include/SampleLog.h"
+#include "../include/SharedRing.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+constexpr const char* const SharedRingHeader::MAGIC;
+
+bool SharedRingReader::_readSlot(
+    const std::uint64_t n,
+    SampleRecord* const out) const noexcept {
+
+        const SharedRingSlot& s = this->_slots[n & this->_mask];
+        const auto gen = s.generation.load(std::memory_order_acquire);
+
+        if(gen != n + 1) {
+            return false;
+        }
+
+        out->when = s.when.load(std::memory_order_relaxed);
+        out->value = s.value.load(std::memory_order_relaxed);
+        out->flags = s.flags.load(std::memory_order_relaxed);
+
+        //the copy must be complete before the generation is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return s.generation.load(std::memory_order_relaxed) == gen;
+
+}
+
+SharedRingReader::SharedRingReader(const std::string& name) :
+    _header(nullptr),
+    _slots(nullptr),
+    _mapSize(0),
+    _mask(0),
+    _position(0),
+    _lost(0) {
+
+        const int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+
+        if(fd < 0) {
+            throw std::runtime_error("unable to open shared ring");
+        }
+
+        struct stat st;
+
+        if(::fstat(fd, &st) != 0 ||
+            static_cast<std::size_t>(st.st_size) < sizeof(SharedRingHeader)) {
+                ::close(fd);
+                throw std::runtime_error("not a shared ring");
+        }
+
+        void* const map = ::mmap(
+            nullptr,
+            static_cast<std::size_t>(st.st_size),
+            PROT_READ,
+            MAP_SHARED,
+            fd,
+            0);
+
+        //the mapping stays valid once the descriptor is closed
+        ::close(fd);
+
+        if(map == MAP_FAILED) {
+            throw std::runtime_error("unable to map shared ring");
+        }
+
+        this->_header = static_cast<const SharedRingHeader*>(map);
+        this->_mapSize = static_cast<std::size_t>(st.st_size);
+
+        const SharedRingHeader& h = *this->_header;
+
+        if(std::memcmp(h.magic, SharedRingHeader::MAGIC, SharedRingHeader::MAGIC_SIZE) != 0 ||
+            h.version != SharedRingHeader::VERSION ||
+            h.headerSize != sizeof(SharedRingHeader) ||
+            h.slotSize != sizeof(SharedRingSlot) ||
+            h.capacity == 0 ||
+            (h.capacity & (h.capacity - 1)) != 0 ||
+            this->_mapSize < h.headerSize + static_cast<std::size_t>(h.capacity) * h.slotSize) {
+                ::munmap(map, this->_mapSize);
+                throw std::runtime_error("not a compatible shared ring");
+        }
+
+        this->_slots = reinterpret_cast<const SharedRingSlot*>(
+            static_cast<const std::uint8_t*>(map) + h.headerSize);
+        this->_mask = h.capacity - 1;
+        this->_position = h.head.load(std::memory_order_acquire);
+
+}
+
+SharedRingReader::~SharedRingReader() {
+    ::munmap(const_cast<SharedRingHeader*>(this->_header), this->_mapSize);
+}
+
+const SharedRingHeader& SharedRingReader::header() const noexcept {
+    return *this->_header;
+}
+
+std::size_t SharedRingReader::read(
+    SampleRecord* const out,
+    const std::size_t max) noexcept {
+
+        const auto head = this->_header->head.load(std::memory_order_acquire);
+        const std::uint64_t capacity = this->_mask + 1;
+
+        //anything further back has already been overwritten
+        if(head - this->_position > capacity) {
+            this->_lost += head - capacity - this->_position;
+            this->_position = head - capacity;
+        }
+
+        std::size_t count = 0;
+
+        while(this->_position < head && count < max) {
+
+            if(this->_readSlot(this->_position, &out[count])) {
+                ++count;
+            }
+            else {
+                ++this->_lost;
+            }
+
+            ++this->_position;
+
+        }
+
+        return count;
+
+}
+
+void SharedRingReader::rewind() noexcept {
+    const auto head = this->_header->head.load(std::memory_order_acquire);
+    const std::uint64_t capacity = this->_mask + 1;
+    this->_position = head > capacity ? head - capacity : 0;
+}
+
+std::size_t SharedRingReader::available() const noexcept {
+    const auto head = this->_header->head.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(head - this->_position);
+}
+
+std::uint64_t SharedRingReader::getLost() const noexcept {
+    return this->_lost;
+}
+
+bool SharedRingReader::getLatest(SharedRingSnapshot* const out) const noexcept {
+
+    const SharedRingHeader& h = *this->_header;
+    SampleRecord rec;
+    std::uint64_t head;
+
+    //retry if the newest slot is overwritten mid-copy
+    do {
+
+        head = h.head.load(std::memory_order_acquire);
+
+        if(head == 0) {
+            return false;
+        }
+
+    } while(!this->_readSlot(head - 1, &rec));
+
+    std::uint64_t seq;
+    Value refUnit;
+    Value offset;
+
+    do {
+
+        seq = h.calibrationSequence.load(std::memory_order_acquire);
+        refUnit = h.refUnit.load(std::memory_order_relaxed);
+        offset = h.offset.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+    } while((seq & 1) != 0 ||
+        h.calibrationSequence.load(std::memory_order_relaxed) != seq);
+
+    out->sequence = head - 1;
+    out->when = rec.when;
+    out->value = rec.value;
+    out->refUnit = refUnit;
+    out->offset = offset;
+
+    return true;
+
+}
+
+bool SharedRingReader::isClosed() const noexcept {
+    return this->_header->closed.load(std::memory_order_acquire) != 0;
+}
+
+};
@@ -0,0 +1,175 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/SampleLog.h"
+#include "../include/SharedRing.h"
+#include "../include/SharedRingPublisher.h"
+#include "../include/Utility.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+SharedRingPublisher::SharedRingPublisher(
+    const std::string& name,
+    const SampleLogMeta& meta,
+    const std::size_t capacity) :
+        _name(name),
+        _header(nullptr),
+        _slots(nullptr),
+        _mapSize(0),
+        _mask(0),
+        _next(0) {
+
+            if(name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos) {
+                throw std::invalid_argument("shared ring name must be /name");
+            }
+
+            if(capacity == 0) {
+                throw std::invalid_argument("capacity must be at least 1");
+            }
+
+            const auto slots = Utility::roundUpPow2(capacity);
+            this->_mapSize = sizeof(SharedRingHeader) + slots * sizeof(SharedRingSlot);
+
+            /**
+             * Readers of a previous ring keep their mapping of it, so
+             * replace it rather than reuse it
+             */
+            ::shm_unlink(name.c_str());
+
+            const int fd = ::shm_open(
+                name.c_str(),
+                O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+                0644);
+
+            if(fd < 0) {
+                throw std::runtime_error("unable to create shared ring");
+            }
+
+            if(::ftruncate(fd, static_cast<off_t>(this->_mapSize)) != 0) {
+                ::close(fd);
+                ::shm_unlink(name.c_str());
+                throw std::runtime_error("unable to size shared ring");
+            }
+
+            void* const map = ::mmap(
+                nullptr,
+                this->_mapSize,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED,
+                fd,
+                0);
+
+            ::close(fd);
+
+            if(map == MAP_FAILED) {
+                ::shm_unlink(name.c_str());
+                throw std::runtime_error("unable to map shared ring");
+            }
+
+            //the object starts zeroed, which is an empty ring
+            this->_header = new (map) SharedRingHeader();
+            this->_slots = reinterpret_cast<SharedRingSlot*>(
+                static_cast<std::uint8_t*>(map) + sizeof(SharedRingHeader));
+            this->_mask = slots - 1;
+
+            SharedRingHeader& h = *this->_header;
+            std::memcpy(h.magic, SharedRingHeader::MAGIC, SharedRingHeader::MAGIC_SIZE);
+            h.version = SharedRingHeader::VERSION;
+            h.headerSize = sizeof(SharedRingHeader);
+            h.slotSize = sizeof(SharedRingSlot);
+            h.capacity = static_cast<std::uint32_t>(slots);
+
+            timespec ts;
+            ::clock_gettime(CLOCK_REALTIME, &ts);
+            h.createdRealtime = Utility::timespec_to_nanos(&ts).count();
+            h.createdMonotonic = Utility::getnanos().count();
+
+            h.dataPin = meta.dataPin;
+            h.clockPin = meta.clockPin;
+            h.rate = static_cast<std::uint8_t>(meta.rate);
+            h.channel = static_cast<std::uint8_t>(meta.channel);
+            h.gain = static_cast<std::uint8_t>(meta.gain);
+            h.unit = static_cast<std::uint8_t>(meta.unit);
+
+            this->setCalibration(meta.refUnit, meta.offset);
+
+}
+
+SharedRingPublisher::~SharedRingPublisher() {
+    this->_header->closed.store(1, std::memory_order_release);
+    ::munmap(this->_header, this->_mapSize);
+    ::shm_unlink(this->_name.c_str());
+}
+
+void SharedRingPublisher::push(const Value v, const std::chrono::nanoseconds when) noexcept {
+
+    const auto n = this->_next;
+    SharedRingSlot& s = this->_slots[n & this->_mask];
+
+    //readers must see the slot as invalid before any of it changes
+    s.generation.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    s.when.store(when.count(), std::memory_order_relaxed);
+    s.value.store(v, std::memory_order_relaxed);
+    s.flags.store(0, std::memory_order_relaxed);
+
+    s.generation.store(n + 1, std::memory_order_release);
+    this->_header->head.store(n + 1, std::memory_order_release);
+
+    this->_next = n + 1;
+
+}
+
+void SharedRingPublisher::setCalibration(const Value refUnit, const Value offset) noexcept {
+
+    SharedRingHeader& h = *this->_header;
+    const auto seq = h.calibrationSequence.load(std::memory_order_relaxed);
+
+    h.calibrationSequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    h.refUnit.store(refUnit, std::memory_order_relaxed);
+    h.offset.store(offset, std::memory_order_relaxed);
+
+    h.calibrationSequence.store(seq + 2, std::memory_order_release);
+
+}
+
+const std::string& SharedRingPublisher::getName() const noexcept {
+    return this->_name;
+}
+
+};
@@ -24,9 +24,12 @@
 #include <cstdint>
 #include <stdexcept>
 #include <vector>
+#include "../include/GpioDriver.h"
 #include "../include/HX711.h"
 #include "../include/Mass.h"
 #include "../include/SimpleHX711.h"
+#include "../include/Trace.h"
+#include "../include/Utility.h"
 #include "../include/Value.h"
 
 namespace HX711 {
@@ -36,22 +39,22 @@ SimpleHX711::SimpleHX711(
     const int clockPin,
     const Value refUnit,
     const Value offset,
-    const Rate rate) :
+    const Rate rate,
+    GpioDriver* const gpio) :
         AbstractScale(Mass::Unit::G, refUnit, offset),
-        HX711(dataPin, clockPin, rate) {
+        HX711(dataPin, clockPin, rate, gpio) {
+            this->_weightMetrics = &this->_metrics;
             this->connect();
 }
 
 std::vector<Value> SimpleHX711::getValues(const std::chrono::nanoseconds timeout) {
 
-    using namespace std::chrono;
-
     std::vector<Value> vals;
-    const auto endTime = steady_clock::now() + timeout;
+    const auto endTime = Utility::getnanos() + timeout;
 
     while(true) {
 
-        if(steady_clock::now() >= endTime) {
+        if(Utility::getnanos() >= endTime) {
             return vals;
         }
 
@@ -73,7 +76,11 @@ std::vector<Value> SimpleHX711::getValues(const std::size_t samples) {
     vals.reserve(samples);
     
     for(std::size_t i = 0; i < samples; ++i) {
+        const auto start = Utility::getnanos();
+        Trace::begin("waitReady");
         while(!this->isReady());
+        Trace::end("waitReady");
+        this->_waitReadyLatency.record(Utility::getnanos() - start);
         vals.push_back(this->readValue());
     }
     
@@ -0,0 +1,236 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "../include/HX711.h"
+#include "../include/Mass.h"
+#include "../include/SimulatedChip.h"
+#include "../include/Utility.h"
+#include "../include/Value.h"
+#include "../include/VirtualChip.h"
+
+namespace HX711 {
+
+std::chrono::nanoseconds SimulatedChip::_periodOf(const Rate r) {
+
+    switch(r) {
+        case Rate::HZ_10:
+            return std::chrono::milliseconds(100);
+        case Rate::HZ_80:
+            return std::chrono::microseconds(12500);
+        default:
+            throw std::invalid_argument("rate must be 10Hz or 80Hz");
+    }
+
+}
+
+double SimulatedChip::_sample(const std::chrono::nanoseconds at) {
+
+    using namespace std::chrono;
+
+    const auto t = at - this->_epoch;
+
+    while(this->_nextStep < this->_steps.size() &&
+        this->_steps[this->_nextStep].first <= t) {
+            this->_load = this->_steps[this->_nextStep].second;
+            ++this->_nextStep;
+    }
+
+    const double seconds = duration_cast<duration<double>>(t).count();
+
+    double v = this->_offset +
+        this->_load * this->_refUnit +
+        this->_drift * seconds;
+
+    /**
+     * Counts are modelled at a gain of 128; the same input at a lower
+     * gain gives proportionally smaller values.
+     * Datasheet pg. 1
+     */
+    switch(this->_convGain) {
+        case Gain::GAIN_64:
+            v /= 2;
+            break;
+        case Gain::GAIN_32:
+            v /= 4;
+            break;
+        default:
+            break;
+    }
+
+    if(this->_noise > 0) {
+        v += this->_normal(this->_rng) * this->_noise;
+    }
+
+    return v;
+
+}
+
+bool SimulatedChip::_nextConversion(
+    const std::chrono::nanoseconds now,
+    std::uint32_t* const v) {
+
+        //an input or gain change restarts settling
+        if(this->_channel != this->_convChannel ||
+            this->_gain != this->_convGain) {
+                this->_convChannel = this->_channel;
+                this->_convGain = this->_gain;
+                this->_nextAt = std::max(this->_nextAt, now + this->_settlingTime);
+        }
+
+        if(now < this->_nextAt) {
+            return false;
+        }
+
+        //conversions since the last poll which nobody saw
+        const auto missed = (now - this->_nextAt) / this->_period;
+        const auto at = this->_nextAt + missed * this->_period;
+
+        this->_overruns += static_cast<std::uint64_t>(missed);
+        this->_nextAt = at + this->_period;
+        ++this->_conversions;
+
+        const double d = std::round(this->_sample(at));
+
+        /**
+         * Datasheet pg. 4
+         * Output saturates at 800000h (min) and 7FFFFFh (max)
+         */
+        const val_t raw = static_cast<val_t>(std::max(
+            static_cast<double>(-0x800000),
+            std::min(static_cast<double>(0x7fffff), d)));
+
+        *v = VirtualChip::toRaw(raw);
+
+        return true;
+
+}
+
+bool SimulatedChip::_nextConversionAt(std::chrono::nanoseconds* const at) const {
+    *at = this->_nextAt;
+    return true;
+}
+
+void SimulatedChip::_reset(
+    const std::chrono::nanoseconds now,
+    const bool discarded) {
+
+        (void)discarded;
+
+        this->_convChannel = this->_channel;
+        this->_convGain = this->_gain;
+        this->_nextAt = now + this->_settlingTime;
+
+}
+
+SimulatedChip::SimulatedChip(const Rate rate, const std::uint32_t seed) :
+    _period(_periodOf(rate)),
+    _settlingTime(_period * 4),
+    _epoch(Utility::getnanos()),
+    _rng(seed),
+    _normal(0.0, 1.0),
+    _offset(0),
+    _refUnit(1),
+    _noise(0),
+    _drift(0),
+    _load(0),
+    _nextStep(0),
+    _nextAt(_epoch + _settlingTime),
+    _convChannel(Channel::A),
+    _convGain(Gain::GAIN_128),
+    _conversions(0),
+    _overruns(0) {
+        this->_replaceUnread = true;
+}
+
+void SimulatedChip::setOffset(const double offset) noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_offset = offset;
+}
+
+void SimulatedChip::setReferenceUnit(const double refUnit) {
+
+    if(refUnit == 0) {
+        throw std::invalid_argument("reference unit cannot be 0");
+    }
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_refUnit = refUnit;
+
+}
+
+void SimulatedChip::setNoise(const double stddev) {
+
+    if(stddev < 0) {
+        throw std::invalid_argument("noise cannot be negative");
+    }
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_noise = stddev;
+
+}
+
+void SimulatedChip::setDrift(const double countsPerSecond) noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_drift = countsPerSecond;
+}
+
+void SimulatedChip::setLoad(const Mass& m) noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_load = m.getValue(Mass::Unit::G);
+}
+
+void SimulatedChip::addLoadStep(const std::chrono::nanoseconds at, const Mass& m) {
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+
+    if(!this->_steps.empty() && at < this->_steps.back().first) {
+        throw std::invalid_argument("load steps must be added in time order");
+    }
+
+    this->_steps.push_back(_step_t(at, m.getValue(Mass::Unit::G)));
+
+}
+
+Mass SimulatedChip::getLoad() const noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    return Mass(this->_load, Mass::Unit::G);
+}
+
+std::uint64_t SimulatedChip::getConversions() const noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    return this->_conversions;
+}
+
+std::uint64_t SimulatedChip::getOverruns() const noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    return this->_overruns;
+}
+
+};
@@ -0,0 +1,98 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <thread>
+#include <time.h>
+#include "../include/SystemClock.h"
+#include "../include/Utility.h"
+
+namespace HX711 {
+
+void SystemClock::sleep(const std::chrono::nanoseconds ns) noexcept {
+    std::this_thread::sleep_for(ns);
+}
+
+void SystemClock::delay(const std::chrono::nanoseconds ns) noexcept {
+
+    using namespace std::chrono;
+
+    /**
+     * This requires some explanation.
+     * 
+     * Delays on a pi are inconsistent due to the OS not being a real-time OS.
+     * A previous version of this code used wiringPi which used its
+     * delayMicroseconds function to delay in the microsecond range. The way this
+     * was implemented was with a busy-wait loop for times under 100 nanoseconds.
+     * 
+     * https://github.com/WiringPi/WiringPi/blob/f15240092312a54259a9f629f9cc241551f9faae/wiringPi/wiringPi.c#L2165-L2166
+     * https://github.com/WiringPi/WiringPi/blob/f15240092312a54259a9f629f9cc241551f9faae/wiringPi/wiringPi.c#L2153-L2154
+     * 
+     * This (the busy-wait) would, presumably, help to prevent context switching
+     * therefore keep the timing required by the HX711 module relatively
+     * consistent.
+     * 
+     * When this code changed to using the lgpio library, its lguSleep function
+     * appeared to be an equivalent replacement. But it did not work.
+     * 
+     * http://abyz.me.uk/lg/lgpio.html#lguSleep
+     * https://github.com/joan2937/lg/blob/8f385c9b8487e608aeb4541266cc81d1d03514d3/lgUtil.c#L56-L67
+     * 
+     * The problem appears to be that lguSleep is not busy-waiting. And, when
+     * a sleep occurs, it is taking far too long to return. Contrast this
+     * behaviour with wiringPi, which constantly calls gettimeofday until return.
+     * 
+     * In short, use this function for delays under 100us.
+     */
+
+    /**
+     * TODO: figure out the overhead in calling this function
+     */
+
+    struct timespec tNow;
+    struct timespec tLong;
+    struct timespec tEnd;
+
+    tLong.tv_sec = ns.count() / nanoseconds::period::den;
+    tLong.tv_nsec = ns.count() % nanoseconds::period::den;
+
+    ::clock_gettime(CLOCK_MONOTONIC_RAW, &tNow);
+    Utility::timespecadd(&tNow, &tLong, &tEnd);
+
+    while(Utility::timespeccmp(&tNow, &tEnd) < 0) {
+        ::clock_gettime(CLOCK_MONOTONIC_RAW, &tNow);
+    }
+
+}
+
+std::chrono::nanoseconds SystemClock::now() noexcept {
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return Utility::timespec_to_nanos(&ts);
+}
+
+SystemClock* SystemClock::getInstance() noexcept {
+    static SystemClock instance;
+    return &instance;
+}
+
+};
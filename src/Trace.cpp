@@ -0,0 +1,313 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+#include "../include/Trace.h"
+#include "../include/Utility.h"
+
+namespace HX711 {
+
+std::atomic<bool> Trace::_enabled(false);
+std::atomic<std::size_t> Trace::_capacity(Trace::_DEFAULT_CAPACITY);
+
+static void writeJsonString(std::ostream& os, const char* s) {
+
+    os << '"';
+
+    for(; *s != '\0'; ++s) {
+        const char c = *s;
+        if(c == '"' || c == '\\') {
+            os << '\\' << c;
+        }
+        else if(static_cast<unsigned char>(c) < 0x20) {
+            char buff[8];
+            std::snprintf(buff, sizeof(buff), "\\u%04x", c);
+            os << buff;
+        }
+        else {
+            os << c;
+        }
+    }
+
+    os << '"';
+
+}
+
+std::mutex& Trace::_lock() noexcept {
+    static std::mutex lock;
+    return lock;
+}
+
+std::vector<std::unique_ptr<Trace::ThreadBuffer>>& Trace::_buffers() noexcept {
+    //buffers are kept after their thread exits so they can be dumped,
+    //until another thread takes them over
+    static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    return buffers;
+}
+
+Trace::LocalSlot::LocalSlot() noexcept : buff(nullptr) {
+}
+
+Trace::LocalSlot::~LocalSlot() {
+    if(this->buff != nullptr) {
+        std::lock_guard<std::mutex> lock(_lock());
+        this->buff->retired = true;
+        this->buff = nullptr;
+    }
+}
+
+Trace::ThreadBuffer*& Trace::_localSlot() noexcept {
+    static thread_local LocalSlot slot;
+    return slot.buff;
+}
+
+std::string& Trace::_localName() noexcept {
+    static thread_local std::string name;
+    return name;
+}
+
+Trace::ThreadBuffer* Trace::_local() noexcept {
+
+    ThreadBuffer*& buff = _localSlot();
+
+    if(buff != nullptr) {
+        return buff;
+    }
+
+    //first event from this thread
+    try {
+
+        const auto capacity = _capacity.load(std::memory_order_relaxed);
+        std::string name = _localName();
+        std::lock_guard<std::mutex> lock(_lock());
+
+        //take over the ring of a thread which has exited, if any
+        for(auto& b : _buffers()) {
+            if(b->retired && b->events.size() == capacity) {
+                buff = b.get();
+                break;
+            }
+        }
+
+        if(buff == nullptr) {
+            std::unique_ptr<ThreadBuffer> b(new ThreadBuffer());
+            b->events.resize(capacity);
+            _buffers().push_back(std::move(b));
+            buff = _buffers().back().get();
+        }
+
+        //no thread owns the ring, so head can be reset
+        for(auto& e : buff->events) {
+            e.name = nullptr;
+        }
+
+        buff->tid = ::syscall(SYS_gettid);
+        buff->name = std::move(name);
+        buff->head.store(0, std::memory_order_relaxed);
+        buff->retired = false;
+
+    }
+    catch(...) {
+        //out of memory; this thread goes untraced
+        return nullptr;
+    }
+
+    return buff;
+
+}
+
+void Trace::_record(const char* const name, const char phase) noexcept {
+
+    ThreadBuffer* const b = _local();
+
+    if(b == nullptr || b->events.empty()) {
+        return;
+    }
+
+    const auto head = b->head.load(std::memory_order_relaxed);
+    Event& e = b->events[head % b->events.size()];
+
+    e.when = Utility::getnanos().count();
+    e.name = name;
+    e.phase = phase;
+
+    b->head.store(head + 1, std::memory_order_release);
+
+}
+
+void Trace::enable(const std::size_t eventsPerThread) noexcept {
+    _capacity.store(eventsPerThread, std::memory_order_relaxed);
+    _enabled.store(true, std::memory_order_release);
+}
+
+void Trace::disable() noexcept {
+    _enabled.store(false, std::memory_order_release);
+}
+
+bool Trace::isEnabled() noexcept {
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+void Trace::begin(const char* const name) noexcept {
+    if(isEnabled()) {
+        _record(name, 'B');
+    }
+}
+
+void Trace::end(const char* const name) noexcept {
+    if(isEnabled()) {
+        _record(name, 'E');
+    }
+}
+
+void Trace::instant(const char* const name) noexcept {
+    if(isEnabled()) {
+        _record(name, 'i');
+    }
+}
+
+void Trace::setThreadName(const std::string& name) {
+
+    //kept until the thread first records, so naming a thread does not
+    //allocate a ring for it
+    _localName() = name;
+
+    ThreadBuffer* const b = _localSlot();
+
+    if(b != nullptr) {
+        std::lock_guard<std::mutex> lock(_lock());
+        b->name = name;
+    }
+
+}
+
+void Trace::clear() noexcept {
+
+    std::lock_guard<std::mutex> lock(_lock());
+
+    //only the owning thread writes head, so rather than resetting it,
+    //clearing hides every event before this point
+    for(auto& b : _buffers()) {
+        for(auto& e : b->events) {
+            e.name = nullptr;
+        }
+    }
+
+}
+
+void Trace::write(std::ostream& os) {
+
+    std::lock_guard<std::mutex> lock(_lock());
+
+    const long pid = ::getpid();
+    bool first = true;
+
+    const auto sep = [&os, &first]() {
+        os << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    for(const auto& b : _buffers()) {
+
+        if(!b->name.empty()) {
+            sep();
+            os  << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                << ",\"tid\":" << b->tid << ",\"args\":{\"name\":";
+            writeJsonString(os, b->name.c_str());
+            os << "}}";
+        }
+
+        const std::size_t cap = b->events.size();
+        const auto head = b->head.load(std::memory_order_acquire);
+        const auto count = head < cap ? head : cap;
+
+        for(auto i = head - count; i < head; ++i) {
+
+            const Event e = b->events[i % cap];
+
+            if(e.name == nullptr) {
+                continue;
+            }
+
+            char ts[32];
+            std::snprintf(ts, sizeof(ts), "%.3f", e.when / 1000.0);
+
+            sep();
+            os << "{\"name\":";
+            writeJsonString(os, e.name);
+            os  << ",\"ph\":\"" << e.phase << "\",\"ts\":" << ts
+                << ",\"pid\":" << pid << ",\"tid\":" << b->tid;
+
+            //instant events are scoped to their thread
+            if(e.phase == 'i') {
+                os << ",\"s\":\"t\"";
+            }
+
+            os << "}";
+
+        }
+
+    }
+
+    os << "\n]}\n";
+
+}
+
+void Trace::dump(const std::string& path) {
+
+    std::ofstream f(path);
+
+    if(!f) {
+        throw std::runtime_error("unable to open trace file");
+    }
+
+    write(f);
+
+    if(!f) {
+        throw std::runtime_error("unable to write trace file");
+    }
+
+}
+
+TraceScope::TraceScope(const char* const name) noexcept : _name(name) {
+    Trace::begin(this->_name);
+}
+
+TraceScope::~TraceScope() {
+    Trace::end(this->_name);
+}
+
+};
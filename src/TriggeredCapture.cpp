@@ -0,0 +1,292 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../include/SampleLog.h"
+#include "../include/TriggeredCapture.h"
+#include "../include/Utility.h"
+#include "../include/Value.h"
+
+namespace HX711 {
+
+constexpr std::chrono::milliseconds TriggeredCapture::_STOP_CHECK;
+
+TriggerCondition TriggerCondition::above(const Value level) noexcept {
+    return TriggerCondition{ TriggerType::ABOVE, level };
+}
+
+TriggerCondition TriggerCondition::below(const Value level) noexcept {
+    return TriggerCondition{ TriggerType::BELOW, level };
+}
+
+TriggerCondition TriggerCondition::step(const Value level) noexcept {
+    return TriggerCondition{ TriggerType::STEP, level };
+}
+
+TriggerCondition TriggerCondition::saturated() noexcept {
+    return TriggerCondition{ TriggerType::SATURATED, 0 };
+}
+
+std::ptrdiff_t TriggeredCapture::_evaluate(const Value v) const noexcept {
+
+    //edges need a sample before this one
+    const bool first = this->_pushed == 0;
+    const val_t prev = this->_previous;
+    const val_t cur = v;
+
+    for(std::size_t i = 0; i < this->_conditions.size(); ++i) {
+
+        const TriggerCondition& c = this->_conditions[i];
+        const val_t level = c.level;
+        bool fired = false;
+
+        switch(c.type) {
+            case TriggerType::ABOVE:
+                fired = !first && prev < level && cur >= level;
+                break;
+            case TriggerType::BELOW:
+                fired = !first && prev > level && cur <= level;
+                break;
+            case TriggerType::STEP:
+                fired = !first && std::llabs(
+                    static_cast<long long>(cur) - prev) >= level;
+                break;
+            case TriggerType::SATURATED:
+                fired = v.isSaturated() && (first || !this->_previous.isSaturated());
+                break;
+        }
+
+        if(fired) {
+            return static_cast<std::ptrdiff_t>(i);
+        }
+
+    }
+
+    return -1;
+
+}
+
+void TriggeredCapture::_begin(
+    const std::size_t condition,
+    const SampleRecord& r) noexcept {
+
+        _Slot* slot = nullptr;
+
+        for(std::size_t i = 0; i < this->_slotCount; ++i) {
+            if(this->_slots[i].state.load(std::memory_order_acquire) == _SLOT_FREE) {
+                slot = &this->_slots[i];
+                break;
+            }
+        }
+
+        if(slot == nullptr) {
+            this->_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Capture& c = slot->capture;
+
+        //capacity was reserved up front, so none of this allocates
+        c.samples.clear();
+        c.sequence = this->_nextSequence++;
+        c.condition = condition;
+
+        const auto pre = static_cast<std::size_t>(
+            std::min<std::uint64_t>(this->_pushed, this->_preSamples));
+
+        for(std::uint64_t n = this->_pushed - pre; n < this->_pushed; ++n) {
+            c.samples.push_back(this->_history[n & this->_historyMask]);
+        }
+
+        c.triggerIndex = c.samples.size();
+        c.samples.push_back(r);
+
+        slot->state.store(_SLOT_FILLING, std::memory_order_relaxed);
+        this->_filling = slot;
+        this->_remaining = this->_postSamples;
+
+}
+
+void TriggeredCapture::_complete() noexcept {
+
+    this->_filling->state.store(_SLOT_READY, std::memory_order_release);
+    this->_filling = nullptr;
+
+    /**
+     * Notified without taking _readyLock so the sampler never blocks. A
+     * missed wake-up only delays delivery until the consumer thread next
+     * checks.
+     */
+    this->_ready.notify_one();
+
+}
+
+TriggeredCapture::_Slot* TriggeredCapture::_nextReady() noexcept {
+
+    _Slot* next = nullptr;
+
+    for(std::size_t i = 0; i < this->_slotCount; ++i) {
+
+        _Slot& s = this->_slots[i];
+
+        if(s.state.load(std::memory_order_acquire) == _SLOT_READY &&
+            (next == nullptr || s.capture.sequence < next->capture.sequence)) {
+                next = &s;
+        }
+
+    }
+
+    return next;
+
+}
+
+void TriggeredCapture::_deliverLoop() noexcept {
+
+    while(true) {
+
+        _Slot* const s = this->_nextReady();
+
+        if(s != nullptr) {
+
+            try {
+                this->_consumer(s->capture);
+            }
+            catch(...) {
+                //the consumer's problem; carry on with the next capture
+            }
+
+            this->_captures.fetch_add(1, std::memory_order_relaxed);
+            s->state.store(_SLOT_FREE, std::memory_order_release);
+            continue;
+
+        }
+
+        if(!this->_running.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(this->_readyLock);
+        this->_ready.wait_for(lock, _STOP_CHECK);
+
+    }
+
+}
+
+TriggeredCapture::TriggeredCapture(
+    const std::vector<TriggerCondition>& conditions,
+    const std::size_t preSamples,
+    const std::size_t postSamples,
+    const Consumer consumer,
+    const std::size_t slots) :
+        _conditions(conditions),
+        _preSamples(preSamples),
+        _postSamples(postSamples),
+        _consumer(consumer),
+        _history(Utility::roundUpPow2(std::max<std::size_t>(preSamples, 1))),
+        _historyMask(_history.size() - 1),
+        _pushed(0),
+        _previous(0),
+        _slots(new _Slot[slots]),
+        _slotCount(slots),
+        _filling(nullptr),
+        _remaining(0),
+        _nextSequence(0),
+        _captures(0),
+        _dropped(0),
+        _running(true) {
+
+            if(conditions.empty()) {
+                throw std::invalid_argument("at least one condition is needed");
+            }
+
+            if(slots == 0) {
+                throw std::invalid_argument("slots must be at least 1");
+            }
+
+            if(!consumer) {
+                throw std::invalid_argument("consumer cannot be empty");
+            }
+
+            for(std::size_t i = 0; i < slots; ++i) {
+                this->_slots[i].state.store(_SLOT_FREE, std::memory_order_relaxed);
+                this->_slots[i].capture.samples.reserve(preSamples + 1 + postSamples);
+            }
+
+            this->_thread = std::thread(&TriggeredCapture::_deliverLoop, this);
+
+}
+
+TriggeredCapture::~TriggeredCapture() {
+    this->_running.store(false, std::memory_order_release);
+    this->_ready.notify_all();
+    this->_thread.join();
+}
+
+void TriggeredCapture::push(const Value v, const std::chrono::nanoseconds when) noexcept {
+
+    SampleRecord r;
+    r.when = when.count();
+    r.value = v;
+    r.flags = 0;
+
+    if(this->_filling != nullptr) {
+        this->_filling->capture.samples.push_back(r);
+        --this->_remaining;
+    }
+    else {
+
+        const auto fired = this->_evaluate(v);
+
+        if(fired >= 0) {
+            this->_begin(static_cast<std::size_t>(fired), r);
+        }
+
+    }
+
+    if(this->_filling != nullptr && this->_remaining == 0) {
+        this->_complete();
+    }
+
+    this->_history[this->_pushed & this->_historyMask] = r;
+    this->_previous = v;
+    ++this->_pushed;
+
+}
+
+std::uint64_t TriggeredCapture::getCaptures() const noexcept {
+    return this->_captures.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TriggeredCapture::getDropped() const noexcept {
+    return this->_dropped.load(std::memory_order_relaxed);
+}
+
+};
@@ -20,20 +20,31 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <atomic>
+#include <cerrno>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <fcntl.h>
 #include <lgpio.h>
 #include <pthread.h>
+#include <poll.h>
 #include <sched.h>
+#include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <thread>
 #include <time.h>
+#include <unistd.h>
+#include "../include/Clock.h"
 #include "../include/GpioException.h"
+#include "../include/SystemClock.h"
 #include "../include/Utility.h"
 
 namespace HX711 {
 
 constexpr const char* const Utility::_VERSION;
+std::atomic<Clock*> Utility::_clock(nullptr);
 
 void Utility::_throwGpioExIfErr(const int code) {
     if(code < 0) {
@@ -79,66 +90,26 @@ void Utility::writeGpio(const int handle, const int pin, const GpioLevel lev) {
     _throwGpioExIfErr(::lgGpioWrite(handle, pin, static_cast<int>(lev)));
 }
 
-void Utility::sleep(const std::chrono::nanoseconds ns) noexcept {
-    std::this_thread::sleep_for(ns);
+void Utility::setClock(Clock* const clock) noexcept {
+    _clock.store(clock, std::memory_order_release);
 }
 
-void Utility::delay(const std::chrono::nanoseconds ns) noexcept {
-
-    using namespace std::chrono;
-
-    /**
-     * This requires some explanation.
-     * 
-     * Delays on a pi are inconsistent due to the OS not being a real-time OS.
-     * A previous version of this code used wiringPi which used its
-     * delayMicroseconds function to delay in the microsecond range. The way this
-     * was implemented was with a busy-wait loop for times under 100 nanoseconds.
-     * 
-     * https://github.com/WiringPi/WiringPi/blob/f15240092312a54259a9f629f9cc241551f9faae/wiringPi/wiringPi.c#L2165-L2166
-     * https://github.com/WiringPi/WiringPi/blob/f15240092312a54259a9f629f9cc241551f9faae/wiringPi/wiringPi.c#L2153-L2154
-     * 
-     * This (the busy-wait) would, presumably, help to prevent context switching
-     * therefore keep the timing required by the HX711 module relatively
-     * consistent.
-     * 
-     * When this code changed to using the lgpio library, its lguSleep function
-     * appeared to be an equivalent replacement. But it did not work.
-     * 
-     * http://abyz.me.uk/lg/lgpio.html#lguSleep
-     * https://github.com/joan2937/lg/blob/8f385c9b8487e608aeb4541266cc81d1d03514d3/lgUtil.c#L56-L67
-     * 
-     * The problem appears to be that lguSleep is not busy-waiting. And, when
-     * a sleep occurs, it is taking far too long to return. Contrast this
-     * behaviour with wiringPi, which constantly calls gettimeofday until return.
-     * 
-     * In short, use this function for delays under 100us.
-     */
-
-    /**
-     * TODO: figure out the overhead in calling this function
-     */
-
-    struct timespec tNow;
-    struct timespec tLong;
-    struct timespec tEnd;
-
-    tLong.tv_sec = ns.count() / nanoseconds::period::den;
-    tLong.tv_nsec = ns.count() % nanoseconds::period::den;
-
-    ::clock_gettime(CLOCK_MONOTONIC_RAW, &tNow);
-    timespecadd(&tNow, &tLong, &tEnd);
+Clock* Utility::getClock() noexcept {
+    //null until set, so nothing depends on static initialisation order
+    Clock* const c = _clock.load(std::memory_order_acquire);
+    return c != nullptr ? c : SystemClock::getInstance();
+}
 
-    while(timespeccmp(&tNow, &tEnd) < 0) {
-        ::clock_gettime(CLOCK_MONOTONIC_RAW, &tNow);
-    }
+void Utility::sleep(const std::chrono::nanoseconds ns) noexcept {
+    getClock()->sleep(ns);
+}
 
+void Utility::delay(const std::chrono::nanoseconds ns) noexcept {
+    getClock()->delay(ns);
 }
 
 std::chrono::nanoseconds Utility::getnanos() noexcept {
-    timespec ts;
-    ::clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
-    return timespec_to_nanos(&ts);
+    return getClock()->now();
 }
 
 std::chrono::nanoseconds Utility::timespec_to_nanos(const timespec* const ts) noexcept {
@@ -241,4 +212,192 @@ void Utility::setThreadPriority(const int pri, const int policy, const pthread_t
 
 }
 
+bool Utility::recvAll(const int fd, void* const buf, const std::size_t len) noexcept {
+
+    std::uint8_t* p = static_cast<std::uint8_t*>(buf);
+    std::size_t left = len;
+
+    while(left > 0) {
+
+        const ssize_t n = ::recv(fd, p, left, 0);
+
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if(n <= 0) {
+            return false;
+        }
+
+        p += n;
+        left -= static_cast<std::size_t>(n);
+
+    }
+
+    return true;
+
+}
+
+bool Utility::sendAll(
+    const int fd,
+    iovec* iov,
+    std::size_t count,
+    const std::chrono::nanoseconds timeout) noexcept {
+
+    const bool bounded = timeout != std::chrono::nanoseconds::max();
+    const auto deadline = bounded
+        ? std::chrono::steady_clock::now() + timeout
+        : std::chrono::steady_clock::time_point::max();
+
+    while(count > 0) {
+
+        msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+
+        ssize_t n = ::sendmsg(
+            fd,
+            &msg,
+            MSG_NOSIGNAL | (bounded ? MSG_DONTWAIT : 0));
+
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if(n < 0 && bounded && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+
+            //wait for room, but only until the deadline for the whole send
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+
+            if(left.count() <= 0) {
+                return false;
+            }
+
+            pollfd p;
+            p.fd = fd;
+            p.events = POLLOUT;
+            p.revents = 0;
+
+            if(::poll(&p, 1, static_cast<int>(left.count())) < 0 && errno != EINTR) {
+                return false;
+            }
+
+            continue;
+
+        }
+
+        if(n < 0) {
+            return false;
+        }
+
+        //skip whatever was sent, which may end part way through an iovec
+        while(count > 0 && static_cast<std::size_t>(n) >= iov->iov_len) {
+            n -= static_cast<ssize_t>(iov->iov_len);
+            ++iov;
+            --count;
+        }
+
+        if(count > 0) {
+            iov->iov_base = static_cast<std::uint8_t*>(iov->iov_base) + n;
+            iov->iov_len -= static_cast<std::size_t>(n);
+        }
+
+    }
+
+    return true;
+
+}
+
+const char Utility::_DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+char* Utility::writeUint(char* const end, std::uint64_t v) noexcept {
+
+    //digits are written backwards from end, two at a time
+    char* p = end;
+
+    while(v >= 100) {
+        const auto i = static_cast<std::size_t>(v % 100) * 2;
+        v /= 100;
+        *--p = _DIGIT_PAIRS[i + 1];
+        *--p = _DIGIT_PAIRS[i];
+    }
+
+    if(v >= 10) {
+        const auto i = static_cast<std::size_t>(v) * 2;
+        *--p = _DIGIT_PAIRS[i + 1];
+        *--p = _DIGIT_PAIRS[i];
+    }
+    else {
+        *--p = static_cast<char>('0' + v);
+    }
+
+    return p;
+
+}
+
+void Utility::getBootId(std::uint8_t* const id) noexcept {
+
+    std::memset(id, 0, BOOT_ID_SIZE);
+
+    const int fd = ::open("/proc/sys/kernel/random/boot_id", O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0) {
+        return;
+    }
+
+    char text[64];
+    const auto n = ::read(fd, text, sizeof(text));
+    ::close(fd);
+
+    //a UUID; 32 hex digits in groups separated by hyphens
+    std::uint8_t parsed[BOOT_ID_SIZE] = {};
+    std::size_t digits = 0;
+
+    for(ssize_t i = 0; i < n && digits < BOOT_ID_SIZE * 2; ++i) {
+
+        const char c = text[i];
+        unsigned int d;
+
+        if(c >= '0' && c <= '9') {
+            d = static_cast<unsigned int>(c - '0');
+        }
+        else if(c >= 'a' && c <= 'f') {
+            d = static_cast<unsigned int>(c - 'a' + 10);
+        }
+        else if(c >= 'A' && c <= 'F') {
+            d = static_cast<unsigned int>(c - 'A' + 10);
+        }
+        else {
+            continue;
+        }
+
+        parsed[digits / 2] |= static_cast<std::uint8_t>(digits % 2 == 0 ? d << 4 : d);
+        ++digits;
+
+    }
+
+    if(digits == BOOT_ID_SIZE * 2) {
+        std::memcpy(id, parsed, BOOT_ID_SIZE);
+    }
+
+}
+
+bool Utility::isCurrentBoot(const std::uint8_t* const id) noexcept {
+    std::uint8_t current[BOOT_ID_SIZE];
+    getBootId(current);
+    return std::memcmp(id, current, BOOT_ID_SIZE) == 0;
+}
+
 };
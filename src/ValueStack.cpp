@@ -22,6 +22,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include "../include/Utility.h"
 #include "../include/ValueStack.h"
 #include "../include/Value.h"
 
@@ -29,20 +30,23 @@ namespace HX711 {
 
 constexpr std::chrono::nanoseconds ValueStack::_DEFAULT_MAX_AGE;
 
-void ValueStack::_update() {
+std::size_t ValueStack::_update() {
 
-    using namespace std::chrono;
+    const std::size_t before = this->_container.size();
 
     while(this->_container.size() > this->_maxSize) {
         this->_container.pop_back();
     }
 
-    const auto now = steady_clock::now();
+    const auto now = Utility::getnanos();
 
+    //discard entries older than the max age
     this->_container.remove_if([this, &now](const StackEntry& e) {
-        return (e.when + this->_maxAge) > now;
+        return now - e.when > this->_maxAge;
     });
 
+    return before - this->_container.size();
+
 }
 
 ValueStack::ValueStack(
@@ -52,20 +56,23 @@ ValueStack::ValueStack(
         _maxAge(maxAge) {
 }
 
-void ValueStack::push(const Value val) noexcept {
+std::size_t ValueStack::push(const Value val) noexcept {
 
-    this->_update();
+    std::size_t discarded = this->_update();
 
     if(this->full()) {
         this->_container.pop_back();
+        ++discarded;
     }
 
     StackEntry e;
     e.val = val;
-    e.when = std::chrono::steady_clock::now();
+    e.when = Utility::getnanos();
 
     this->_container.push_front(e);
 
+    return discarded;
+
 }
 
 Value ValueStack::pop() noexcept {
@@ -74,6 +81,11 @@ Value ValueStack::pop() noexcept {
     return v;
 }
 
+Value ValueStack::pop(std::chrono::nanoseconds* const when) noexcept {
+    *when = this->_container.front().when;
+    return this->pop();
+}
+
 std::size_t ValueStack::size() const noexcept {
     return this->_container.size();
 }
@@ -0,0 +1,325 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include "../include/GpioException.h"
+#include "../include/HX711.h"
+#include "../include/Utility.h"
+#include "../include/Value.h"
+#include "../include/VirtualChip.h"
+
+namespace HX711 {
+
+constexpr std::chrono::microseconds VirtualChip::_POWER_DOWN_TIMEOUT;
+
+void VirtualChip::_checkHandle(const int handle) const {
+    if(!this->_open || handle != _HANDLE) {
+        throw GpioException("invalid virtual chip handle");
+    }
+}
+
+void VirtualChip::_poll(const std::chrono::nanoseconds now) {
+
+    if(!this->_poweredDown &&
+        this->_clock == GpioLevel::HIGH &&
+        now - this->_clockHighSince >= _POWER_DOWN_TIMEOUT) {
+            this->_poweredDown = true;
+            this->_dout = GpioLevel::HIGH;
+    }
+
+    if(this->_poweredDown) {
+        return;
+    }
+
+    //a conversion being shifted out is never replaced; an unread one
+    //only if the derived class asks for it
+    if(this->_ready && (this->_pulses != 0 || !this->_replaceUnread)) {
+        return;
+    }
+
+    /**
+     * After a reset (eg. the clock was held high too long in the middle
+     * of a read) the HX711 may still send the rest of its pulses. Wait
+     * until it is polling for data so they are not taken as reading
+     * the next conversion.
+     */
+    if(this->_resetPending && this->_idleReads < 2) {
+        return;
+    }
+
+    std::uint32_t v = 0;
+
+    if(this->_nextConversion(now, &v)) {
+        this->_resetPending = false;
+        this->_data = v & 0xffffff;
+        this->_ready = true;
+        this->_pulses = 0;
+        this->_dout = GpioLevel::LOW;
+    }
+
+}
+
+void VirtualChip::_risingEdge(const std::chrono::nanoseconds now) {
+
+    (void)now;
+
+    //no _poll here; new conversions are only picked up when DOUT is
+    //read, so a stray pulse (eg. in powerDown) cannot consume one
+    if(this->_poweredDown) {
+        return;
+    }
+
+    //pulses while no conversion is ready have no effect
+    if(!this->_ready && this->_pulses == 0) {
+        return;
+    }
+
+    //datasheet pg. 4: at most 27 pulses
+    if(this->_pulses >= _BITS + 3) {
+        return;
+    }
+
+    ++this->_pulses;
+
+    if(this->_pulses <= _BITS) {
+        const auto shift = _BITS - this->_pulses;
+        this->_dout = ((this->_data >> shift) & 1) != 0
+            ? GpioLevel::HIGH
+            : GpioLevel::LOW;
+        return;
+    }
+
+    //25th pulse onwards selects the input and gain of the next
+    //conversion and pulls DOUT high until it is ready
+    this->_ready = false;
+    this->_dout = GpioLevel::HIGH;
+
+    switch(this->_pulses - _BITS) {
+        case 1:
+            this->_channel = Channel::A;
+            this->_gain = Gain::GAIN_128;
+            break;
+        case 2:
+            this->_channel = Channel::B;
+            this->_gain = Gain::GAIN_32;
+            break;
+        default:
+            this->_channel = Channel::A;
+            this->_gain = Gain::GAIN_64;
+            break;
+    }
+
+}
+
+void VirtualChip::_fallingEdge(const std::chrono::nanoseconds now) {
+
+    this->_poll(now);
+
+    if(this->_poweredDown) {
+        this->_doReset(now);
+    }
+
+}
+
+void VirtualChip::_doReset(const std::chrono::nanoseconds now) {
+
+    /**
+     * "When PD_SCK returns to low, chip will reset and enter normal
+     * operation mode. After a reset or power-down event, input
+     * selection is default to Channel A with a gain of 128."
+     * Datasheet pg. 5
+     */
+    const bool discarded = this->_ready;
+
+    this->_poweredDown = false;
+    this->_resetPending = true;
+    this->_ready = false;
+    this->_pulses = 0;
+    this->_data = 0;
+    this->_dout = GpioLevel::HIGH;
+    this->_channel = Channel::A;
+    this->_gain = Gain::GAIN_128;
+
+    this->_reset(now, discarded);
+
+}
+
+bool VirtualChip::_nextConversionAt(std::chrono::nanoseconds* const at) const {
+    (void)at;
+    return false;
+}
+
+void VirtualChip::_reset(
+    const std::chrono::nanoseconds now,
+    const bool discarded) {
+        (void)now;
+        (void)discarded;
+}
+
+VirtualChip::VirtualChip() noexcept :
+    _replaceUnread(false),
+    _idleReads(0),
+    _open(false),
+    _dataPin(-1),
+    _clockPin(-1),
+    _clock(GpioLevel::LOW),
+    _dout(GpioLevel::HIGH),
+    _clockHighSince(0),
+    _poweredDown(false),
+    _resetPending(false),
+    _ready(false),
+    _pulses(0),
+    _data(0),
+    _channel(Channel::A),
+    _gain(Gain::GAIN_128) {
+}
+
+int VirtualChip::openHandle(const int chip) {
+
+    (void)chip;
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+
+    if(this->_open) {
+        throw GpioException("virtual chip already open");
+    }
+
+    this->_open = true;
+    return _HANDLE;
+
+}
+
+void VirtualChip::closeHandle(const int handle) {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_checkHandle(handle);
+    this->_open = false;
+    this->_dataPin = -1;
+    this->_clockPin = -1;
+}
+
+void VirtualChip::openInput(const int handle, const int pin) {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_checkHandle(handle);
+    this->_dataPin = pin;
+}
+
+void VirtualChip::openOutput(const int handle, const int pin) {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_checkHandle(handle);
+    this->_clockPin = pin;
+}
+
+void VirtualChip::closePin(const int handle, const int pin) {
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_checkHandle(handle);
+
+    if(pin == this->_dataPin) {
+        this->_dataPin = -1;
+    }
+    else if(pin == this->_clockPin) {
+        this->_clockPin = -1;
+    }
+    else {
+        throw GpioException("pin not open");
+    }
+
+}
+
+GpioLevel VirtualChip::read(const int handle, const int pin) {
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_checkHandle(handle);
+
+    if(pin < 0 || pin != this->_dataPin) {
+        throw GpioException("pin not open for input");
+    }
+
+    /**
+     * Repeated reads with no clock pulses in between mean the HX711 is
+     * waiting for data rather than part way through a read or gain
+     * selection (where there is a read between each pulse).
+     */
+    if(this->_idleReads < 2) {
+        ++this->_idleReads;
+    }
+
+    this->_poll(Utility::getnanos());
+
+    //nothing will change until the next conversion, so let a virtual
+    //clock skip ahead to it
+    std::chrono::nanoseconds at;
+
+    if(!this->_ready &&
+        !this->_poweredDown &&
+        this->_idleReads >= 2 &&
+        this->_nextConversionAt(&at)) {
+            Utility::getClock()->idleUntil(at);
+    }
+
+    return this->_dout;
+
+}
+
+void VirtualChip::write(const int handle, const int pin, const GpioLevel lev) {
+
+    std::lock_guard<std::mutex> lock(this->_lock);
+    this->_checkHandle(handle);
+
+    if(pin < 0 || pin != this->_clockPin) {
+        throw GpioException("pin not open for output");
+    }
+
+    if(lev == this->_clock) {
+        return;
+    }
+
+    this->_idleReads = 0;
+
+    const auto now = Utility::getnanos();
+
+    if(lev == GpioLevel::HIGH) {
+        this->_clock = GpioLevel::HIGH;
+        this->_clockHighSince = now;
+        this->_risingEdge(now);
+    }
+    else {
+        //power down is judged on how long the clock was high, so
+        //_fallingEdge must see the clock as it was
+        this->_fallingEdge(now);
+        this->_clock = GpioLevel::LOW;
+    }
+
+}
+
+bool VirtualChip::isPoweredDown() const noexcept {
+    std::lock_guard<std::mutex> lock(this->_lock);
+    return this->_poweredDown;
+}
+
+std::uint32_t VirtualChip::toRaw(const val_t v) noexcept {
+    return static_cast<std::uint32_t>(v) & 0xffffff;
+}
+
+};
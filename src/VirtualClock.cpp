@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include "../include/VirtualClock.h"
+
+namespace HX711 {
+
+constexpr std::chrono::nanoseconds VirtualClock::_DEFAULT_TICK;
+constexpr std::chrono::microseconds VirtualClock::_QUIET_PERIOD;
+
+void VirtualClock::_advanceTo(const std::int64_t t) noexcept {
+
+    //time never goes backwards, so two threads sleeping over the same
+    //period only move it forward once
+    std::int64_t cur = this->_now.load(std::memory_order_relaxed);
+
+    while(cur < t && !this->_now.compare_exchange_weak(
+        cur,
+        t,
+        std::memory_order_acq_rel,
+        std::memory_order_relaxed));
+
+}
+
+VirtualClock::VirtualClock(
+    const std::chrono::nanoseconds start,
+    const std::chrono::nanoseconds tick) noexcept :
+        _now(start.count()),
+        _tick(tick.count()) {
+}
+
+std::chrono::nanoseconds VirtualClock::now() noexcept {
+    const auto tick = this->_tick.load(std::memory_order_relaxed);
+    return std::chrono::nanoseconds(
+        this->_now.fetch_add(tick, std::memory_order_acq_rel) + tick);
+}
+
+void VirtualClock::sleep(const std::chrono::nanoseconds ns) noexcept {
+
+    const auto wake = this->_now.load(std::memory_order_acquire) + ns.count();
+
+    std::unique_lock<std::mutex> lock(this->_sleepLock);
+    const auto it = this->_sleepers.insert(wake);
+
+    /**
+     * Only the sleeper due first may move time forward, and only once
+     * the clock has stopped moving. Any other thread still running (eg.
+     * part way through reading a value) keeps the clock moving with
+     * calls to now, so it is not skipped over.
+     */
+    for(;;) {
+
+        const auto seen = this->_now.load(std::memory_order_acquire);
+
+        if(seen >= wake) {
+            break;
+        }
+
+        this->_sleepCond.wait_for(lock, _QUIET_PERIOD);
+
+        if(it == this->_sleepers.begin() &&
+            this->_now.load(std::memory_order_acquire) == seen) {
+                this->_advanceTo(wake);
+                break;
+        }
+
+    }
+
+    this->_sleepers.erase(it);
+    lock.unlock();
+    this->_sleepCond.notify_all();
+
+}
+
+void VirtualClock::delay(const std::chrono::nanoseconds ns) noexcept {
+    this->_advanceTo(this->_now.load(std::memory_order_acquire) + ns.count());
+}
+
+void VirtualClock::idleUntil(const std::chrono::nanoseconds t) noexcept {
+    this->_advanceTo(t.count());
+}
+
+std::chrono::nanoseconds VirtualClock::peek() const noexcept {
+    return std::chrono::nanoseconds(this->_now.load(std::memory_order_acquire));
+}
+
+void VirtualClock::advance(const std::chrono::nanoseconds ns) noexcept {
+    this->_now.fetch_add(ns.count(), std::memory_order_acq_rel);
+}
+
+std::chrono::nanoseconds VirtualClock::getTick() const noexcept {
+    return std::chrono::nanoseconds(this->_tick.load(std::memory_order_relaxed));
+}
+
+void VirtualClock::setTick(const std::chrono::nanoseconds tick) noexcept {
+    this->_tick.store(tick.count(), std::memory_order_relaxed);
+}
+
+};
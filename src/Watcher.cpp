@@ -20,15 +20,22 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <mutex>
 #include <pthread.h>
 #include <sched.h>
 #include <stdexcept>
+#include <string>
+#include <time.h>
 #include "../include/GpioException.h"
 #include "../include/IntegrityException.h"
+#include "../include/Metrics.h"
 #include "../include/TimeoutException.h"
+#include "../include/Trace.h"
 #include "../include/Utility.h"
 #include "../include/Value.h"
 #include "../include/Watcher.h"
@@ -80,6 +87,15 @@ void* Watcher::_watchPin(void* const watcherPtr) {
     std::unique_lock<std::mutex> stateLock(self->_pinWatchLock, std::defer_lock);
     std::unique_lock<std::mutex> valsLock(self->valuesLock, std::defer_lock);
     Value v;
+    std::size_t dropped;
+
+    //whether a waitReady trace event is open
+    bool waiting = false;
+
+    Trace::setThreadName(
+        "hx711 watcher " +
+        std::to_string(self->_hx->getDataPin()) + "/" +
+        std::to_string(self->_hx->getClockPin()));
 
     for(;;) {
 
@@ -88,7 +104,12 @@ void* Watcher::_watchPin(void* const watcherPtr) {
 
             //once in normal state, lock to ensure the process of
             //obtaining sensor data is not interrupted
-            stateLock.lock();
+            //taken on every poll, so only traced when contended
+            if(!stateLock.try_lock()) {
+                Trace::begin("wait stateLock");
+                stateLock.lock();
+                Trace::end("wait stateLock");
+            }
 
             /**
              * check if the sensor is ready to send data
@@ -106,12 +127,24 @@ void* Watcher::_watchPin(void* const watcherPtr) {
              * actually a problem?
              */
             if(!self->_hx->isReady()) {
+
+                //one event for the whole wait rather than one per poll
+                if(!waiting) {
+                    Trace::begin("waitReady");
+                    waiting = true;
+                }
+
                 stateLock.unlock();
                 ::sched_yield();
                 Utility::delay(self->_notReadySleep);
                 continue;
             }
 
+            if(waiting) {
+                Trace::end("waitReady");
+                waiting = false;
+            }
+
             //at this point, all OK to read the sensor's value
             try {
                 v = self->_hx->readValue();
@@ -123,7 +156,9 @@ void* Watcher::_watchPin(void* const watcherPtr) {
                  * The HX711 will assume power down mode in this case, so it needs to be
                  * powered up again. A read can allow this to occur.
                  */
+                Trace::begin("recover");
                 self->_recoverHX711(std::chrono::milliseconds(50));
+                Trace::end("recover");
 
                 stateLock.unlock();
                 continue;
@@ -150,9 +185,21 @@ void* Watcher::_watchPin(void* const watcherPtr) {
 
             }
 
+            Trace::begin("wait valuesLock");
             self->valuesLock.lock();
-            self->values.push(v);
+            Trace::end("wait valuesLock");
+            Trace::begin("enqueue");
+            dropped = self->values.push(v);
             self->valuesLock.unlock();
+            Trace::end("enqueue");
+
+            if(dropped > 0) {
+                self->_hx->getMetrics().dropped.fetch_add(
+                    dropped,
+                    std::memory_order_relaxed);
+            }
+
+            self->_countRead();
 
             //after having read the value, let the other thread(s)
             //know it is ready, and then release the locks
@@ -160,11 +207,18 @@ void* Watcher::_watchPin(void* const watcherPtr) {
 
             //finally, sleep for a reasonable amount of time
             //to go through the process again
+            Trace::begin("pollSleep");
             Utility::sleep(self->_pollSleep);
+            Trace::end("pollSleep");
             continue;
 
 
         case WatchState::PAUSE:
+
+            if(waiting) {
+                Trace::end("waitReady");
+                waiting = false;
+            }
             
             //documentation recommends sched_yield over pthread_yield
             //https://man7.org/linux/man-pages/man3/pthread_yield.3.html#CONFORMING_TO
@@ -195,6 +249,55 @@ void* Watcher::_watchPin(void* const watcherPtr) {
 
 }
 
+std::chrono::nanoseconds Watcher::_conversionPeriod(const Rate r) noexcept {
+
+    /**
+     * Datasheet pg. 3
+     */
+    switch(r) {
+        case Rate::HZ_10:
+            return std::chrono::milliseconds(100);
+        case Rate::HZ_80:
+            return std::chrono::microseconds(12500);
+        default:
+            //unknown with an external clock
+            return std::chrono::nanoseconds(0);
+    }
+
+}
+
+void Watcher::_countRead() noexcept {
+
+    ScaleMetrics& m = this->_hx->getMetrics();
+    const auto now = Utility::getnanos();
+    const auto period = _conversionPeriod(this->_hx->getRate());
+
+    //every whole period between two reads beyond the first is a
+    //conversion which came and went unread
+    if(this->_lastRead.count() > 0 && period.count() > 0) {
+
+        const auto periods = (now - this->_lastRead + period / 2) / period;
+
+        if(periods > 1) {
+            m.missed.fetch_add(
+                static_cast<std::uint64_t>(periods - 1),
+                std::memory_order_relaxed);
+        }
+
+    }
+
+    this->_lastRead = now;
+
+    timespec ts;
+
+    if(::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        m.watcherCpuNanos.store(
+            static_cast<std::uint64_t>(Utility::timespec_to_nanos(&ts).count()),
+            std::memory_order_relaxed);
+    }
+
+}
+
 void Watcher::_changeWatchState(const WatchState state) {
 
     std::lock_guard<std::mutex> lck(this->_pinWatchLock);
@@ -202,6 +305,22 @@ void Watcher::_changeWatchState(const WatchState state) {
     //check for a change in state and then whether that change is
     //to a normal or paused state to adjust thread priority
     if(state != this->_watchState) {
+
+        switch(state) {
+            case WatchState::NORMAL:
+                Trace::instant("watch");
+                break;
+            case WatchState::PAUSE:
+                Trace::instant("pause");
+                break;
+            default:
+                Trace::instant("end");
+                break;
+        }
+
+        //a gap spent paused is not a missed conversion
+        this->_lastRead = std::chrono::nanoseconds(0);
+
         if(state == WatchState::NORMAL || state == WatchState::PAUSE) {
 
             int (*priFunc)(int);
@@ -227,9 +346,7 @@ void Watcher::_changeWatchState(const WatchState state) {
 
 void Watcher::_recoverHX711(const std::chrono::nanoseconds maxWait) {
 
-    using namespace std::chrono;
-
-    const auto whenExceeded = steady_clock::now() + maxWait;
+    const auto whenExceeded = Utility::getnanos() + maxWait;
 
     //essentially...
 
@@ -245,7 +362,7 @@ void Watcher::_recoverHX711(const std::chrono::nanoseconds maxWait) {
             //if the read fails...
 
             //...and the max wait is met, return anyway
-            if(steady_clock::now() >= whenExceeded) {
+            if(Utility::getnanos() >= whenExceeded) {
                 return;
             }
 
@@ -264,7 +381,8 @@ Watcher::Watcher(HX711* const hx) noexcept :
     _watchThreadId(-1),
     _pauseSleep(_DEFAULT_PAUSE_SLEEP),
     _notReadySleep(_DEFAULT_NOT_READY_SLEEP),
-    _pollSleep(_DEFAULT_POLL_SLEEP) {
+    _pollSleep(_DEFAULT_POLL_SLEEP),
+    _lastRead(0) {
 }
 
 Watcher::~Watcher() {
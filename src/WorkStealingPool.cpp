@@ -0,0 +1,180 @@
+// MIT License
+//
+// Copyright (c) 2021 Daniel Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "../include/WorkStealingPool.h"
+
+namespace HX711 {
+
+bool WorkStealingPool::_next(const std::size_t id, std::size_t* const task) noexcept {
+
+    {
+        _Queue& own = *this->_queues[id];
+        std::lock_guard<std::mutex> lck(own.mtx);
+        if(!own.tasks.empty()) {
+            *task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    //steal from the others in turn, starting with the next thread's
+    const auto n = this->_queues.size();
+
+    for(std::size_t i = 1; i < n; ++i) {
+        _Queue& victim = *this->_queues[(id + i) % n];
+        std::lock_guard<std::mutex> lck(victim.mtx);
+        if(!victim.tasks.empty()) {
+            *task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+
+}
+
+void WorkStealingPool::_worker(const std::size_t id) noexcept {
+
+    std::size_t seen = 0;
+
+    while(true) {
+
+        const Task* task;
+
+        {
+            std::unique_lock<std::mutex> lck(this->_mtx);
+            this->_start.wait(lck, [this, seen]() {
+                return this->_stopping || this->_generation != seen;
+            });
+            if(this->_stopping) {
+                return;
+            }
+            seen = this->_generation;
+            task = this->_task;
+        }
+
+        std::size_t i;
+
+        while(this->_next(id, &i)) {
+            try {
+                (*task)(i);
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> lck(this->_mtx);
+                if(!this->_error) {
+                    this->_error = std::current_exception();
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        if(--this->_busy == 0) {
+            this->_done.notify_all();
+        }
+
+    }
+
+}
+
+WorkStealingPool::WorkStealingPool(const std::size_t threads) :
+    _task(nullptr),
+    _generation(0),
+    _busy(0),
+    _stopping(false) {
+
+        auto n = threads;
+
+        if(n == 0) {
+            n = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for(std::size_t i = 0; i < n; ++i) {
+            this->_queues.push_back(std::unique_ptr<_Queue>(new _Queue()));
+        }
+
+        for(std::size_t i = 0; i < n; ++i) {
+            this->_threads.push_back(std::thread(&WorkStealingPool::_worker, this, i));
+        }
+
+}
+
+WorkStealingPool::~WorkStealingPool() {
+
+    {
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        this->_stopping = true;
+    }
+
+    this->_start.notify_all();
+
+    for(auto& t : this->_threads) {
+        t.join();
+    }
+
+}
+
+void WorkStealingPool::run(const std::size_t count, const Task& task) {
+
+    const auto n = this->_queues.size();
+
+    //contiguous runs keep neighbouring tasks on one thread until stolen
+    for(std::size_t q = 0; q < n; ++q) {
+        std::lock_guard<std::mutex> lck(this->_queues[q]->mtx);
+        for(std::size_t i = count * q / n; i < count * (q + 1) / n; ++i) {
+            this->_queues[q]->tasks.push_back(i);
+        }
+    }
+
+    std::exception_ptr error;
+
+    {
+        std::unique_lock<std::mutex> lck(this->_mtx);
+        this->_task = &task;
+        this->_busy = n;
+        this->_error = nullptr;
+        ++this->_generation;
+        this->_start.notify_all();
+        this->_done.wait(lck, [this]() { return this->_busy == 0; });
+        this->_task = nullptr;
+        error = this->_error;
+        this->_error = nullptr;
+    }
+
+    if(error) {
+        std::rethrow_exception(error);
+    }
+
+}
+
+std::size_t WorkStealingPool::size() const noexcept {
+    return this->_threads.size();
+}
+
+};